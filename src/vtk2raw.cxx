@@ -19,7 +19,10 @@
 // Description:
 //
 // Input Files can be:
-//   ASCII or binary   legacy VTK  file with   StructuredPoints
+//   ASCII or binary   legacy VTK  file with   StructuredPoints,
+//                                             StructuredGrid,
+//                                             RectilinearGrid,
+//                                             UnstructuredGrid, or PolyData
 //   ASCII or binary   XML    VTI  file with   ImageData
 //   ASCII or binary   XML    VTP  file with   PolyData
 //   ASCII or binary   XML    VTU  file with   UnstructuredGrid
@@ -29,7 +32,8 @@
 //   Binary
 //
 // Contents to convert:
-// The content of files that will be converted are ALL vtkDataArrays in the vtkPointData.
+// The content of files that will be converted are ALL vtkDataArrays in the vtkPointData,
+// or, optionally, in the vtkCellData.
 // The arrays can consist of:
 //    All Scalar arrays
 //    All Vector arrays
@@ -72,25 +76,88 @@
 // STL
 #include <iomanip>     // for setprecision
 #include <cstdlib>   // atio
+#include <cstdio>      // snprintf
+#include <cstring>     // strcmp
+#include <strings.h>   // strcasecmp
+#include <sys/stat.h>  // stat
+#include <sys/mman.h>  // shm_open, mmap
+#include <fcntl.h>     // O_CREAT, O_RDWR
+#include <cerrno>      // EINVAL
+#include <unistd.h>    // ftruncate, sysconf
+#include <cctype>      // toupper, isspace
+#include <sstream>     // istringstream
+#include <algorithm>   // find, min, reverse
+#include <limits>      // numeric_limits
+#include <thread>      // thread, hardware_concurrency
+#include <atomic>      // atomic
+#include <mutex>       // mutex, lock_guard
+#include <glob.h>      // glob
+#include <chrono>      // steady_clock
+#include <csignal>     // sigaction
+#include <poll.h>      // poll
+#include <sys/socket.h> // socket, accept
+#include <sys/un.h>    // sockaddr_un
+#include <sys/wait.h>  // wait4
+#include <sys/resource.h> // rusage
 
 // VTK
 #include <vtkSmartPointer.h>
 #include <vtkDataSet.h>
-#include <vtkStructuredPointsReader.h>
+#include <vtkDataSetReader.h>
 #include <vtkXMLImageDataReader.h>
 #include <vtkXMLPolyDataReader.h>
 #include <vtkXMLUnstructuredGridReader.h>
+#include <vtkXMLPImageDataReader.h>
+#include <vtkXMLPPolyDataReader.h>
+#include <vtkXMLPUnstructuredGridReader.h>
+#include <vtkXMLReader.h>
+#ifdef HAVE_VTK_HDF_READER
+#include <vtkHDFReader.h>
+#endif
+#include <vtkDataArraySelection.h>
 #include <vtkStructuredPoints.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
+#include <vtkCellData.h>
+#include <vtkPointSet.h>
+#include <vtkImageData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkType.h>
+#include <vtkSetGet.h>
+#include <vtkDataArray.h>
+#include <vtkAlgorithm.h>
+#include <vtkInformation.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// HDF5 of VTK
+#include <vtk_hdf5.h>
 
 // ===========
 // Definitions
 // ===========
 
 #define CHAR_LENGTH 256
+#define SNIFF_LENGTH 4096
+#define LEGACY_DATASET_TYPES "STRUCTURED_POINTS STRUCTURED_GRID " \
+    "RECTILINEAR_GRID UNSTRUCTURED_GRID POLYDATA"
 #define DECIMAL_PRECISION 16
+#define BUFFER_SIZE 4194304ULL
+#define MULTIBLOCK_DEPTH 16
+#define HDF_SIGNATURE "\211HDF\r\n\032\n"
+#define HDF_CHUNK_CACHE_SIZE 67108864ULL
+#define GZIP_SIGNATURE "\037\213"
+#define ZSTD_SIGNATURE "\050\265\057\375"
+#define DECOMPRESSION_BLOCK_SIZE 1048576
+#define DECOMPRESSION_QUEUE_LENGTH 4
+#define DECOMPRESSION_KEEP_SIZE 65536
+#define DECOMPRESSION_CHECKPOINT_SIZE 8388608LL
+#define STANDARD_INPUT "-"
+#define STANDARD_OUTPUT "-"
+#define SHARED_MEMORY_MAGIC "VTK2RAW"
+#define SHARED_MEMORY_VERSION 1
+#define JOB_LINE_TIMEOUT 10
 
 #define HERE std::cout << __FILE__ << " at line " << __LINE__ << std::endl;
 
@@ -100,17 +167,135 @@
 
 int main(int argc, char *argv[])
 {
+    return RunCommand(argc,argv);
+}
+
+// ===========
+// Run Command
+// ===========
+
+// Description:
+// Runs one command line, which is the command line of the program, or the
+// arguments of a job of the server.
+
+int RunCommand(
+        int argc,
+        char *argv[])
+{
+    // Separate options from positional arguments
+    ConversionOptions Options;
+    std::vector<char*> Arguments;
+    ParseArguments(argc,argv,Options,Arguments);
+
+    // Server mode converts the jobs of the clients of a Unix domain socket
+    // until it is stopped
+    if(Options.ServerSocket.empty() == false)
+    {
+        if(Arguments.empty() == false)
+        {
+            PrintUsage(argv[0]);
+            exit(1);
+        }
+
+        ServeConversions(Options,argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    // Probe mode only reads the headers of one or more input files
+    if(Options.Probe == true)
+    {
+        if(Arguments.size() < 1)
+        {
+            PrintUsage(argv[0]);
+            exit(0);
+        }
+
+        int Status = EXIT_SUCCESS;
+        for(unsigned int InputIterator = 0;
+            InputIterator < Arguments.size();
+            InputIterator++)
+        {
+            try
+            {
+                if(ProbeInputFile(Arguments[InputIterator]) == false)
+                {
+                    Status = EXIT_FAILURE;
+                }
+            }
+            catch(const ConversionError &)
+            {
+                Status = EXIT_FAILURE;
+            }
+        }
+
+        return Status;
+    }
+
+    // Batch mode converts many input files in one process, to output file
+    // names that are made from a template
+    if(Options.Batch == true)
+    {
+        if(Arguments.size() < 2 ||
+           (Arguments.size() < 3 && Options.Manifest.empty() == true))
+        {
+            PrintUsage(argv[0]);
+            exit(0);
+        }
+
+        // The binary option is not optional, since inputs follow it
+        if(strcmp(Arguments[1],"0") != 0 && strcmp(Arguments[1],"1") != 0)
+        {
+            std::cerr << "Binary option should be either 0 or 1." << std::endl;
+            exit(1);
+        }
+        Options.BinaryOutputFile = (strcmp(Arguments[1],"1") == 0);
+
+        if(Options.SharedMemoryOutput == true ||
+           strcmp(Arguments[0],STANDARD_OUTPUT) == 0)
+        {
+            std::cerr << "Batch mode can not write to the standard output ";
+            std::cerr << "or to shared memory." << std::endl;
+            exit(1);
+        }
+
+        if(IsShardedOutput(Options) == true &&
+           (Options.BinaryOutputFile == false ||
+            Options.ConcatenateFiles == true ||
+            Options.ConcatenateBlocks == true))
+        {
+            std::cerr << "Options --shards and --shard-size need binary ";
+            std::cerr << "output, and can not be used with ";
+            std::cerr << "--concatenate-files or --concatenate-blocks.";
+            std::cerr << std::endl;
+            exit(1);
+        }
+
+        std::vector<char*> Patterns(Arguments.begin()+2,Arguments.end());
+        std::vector<std::string> InputFilenames;
+        GetBatchInputFilenames(Patterns,Options.Manifest,InputFilenames);
+        try
+        {
+            ConvertBatch(InputFilenames,Arguments[0],Options);
+        }
+        catch(const ConversionError &)
+        {
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
     // Check arguments
-    if(argc < 3)
+    if(Arguments.size() < 2)
     {
         PrintUsage(argv[0]);
         exit(0);
     }
 
     bool BinaryOutputFile = false;
-    if(argc == 4)
+    if(Arguments.size() == 3)
     {
-        int BinaryOutputFileInt = atoi(argv[3]);
+        int BinaryOutputFileInt = atoi(Arguments[2]);
 
         // Check input
         if(BinaryOutputFileInt != 0 && BinaryOutputFileInt != 1)
@@ -121,13 +306,79 @@ int main(int argc, char *argv[])
 
         BinaryOutputFile = static_cast<bool>(BinaryOutputFileInt);
     }
+    Options.BinaryOutputFile = BinaryOutputFile;
 
     // Input/Output Filename
-    char *InputFilename = argv[1];
-    char *OutputFilename = argv[2];
+    char *InputFilename = Arguments[0];
+    char *OutputFilename = Arguments[1];
+    Options.SequentialOutputFile = IsSequentialOutputFile(OutputFilename);
+
+    // Only the output is written to the standard output, and the messages
+    // to the standard error
+    if(strcmp(OutputFilename,STANDARD_OUTPUT) == 0)
+    {
+        if(Options.WriteTopology == true ||
+           (Options.WritePointData == true && Options.WriteCellData == true))
+        {
+            std::cerr << "Options --point-and-cell-data and --topology ";
+            std::cerr << "write several files, which can not be written to ";
+            std::cerr << "the standard output." << std::endl;
+            exit(1);
+        }
+
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    // The output file name is the name of a shared memory segment, which
+    // holds one binary matrix
+    if(Options.SharedMemoryOutput == true)
+    {
+        if(IsSharedMemoryName(OutputFilename) == false)
+        {
+            std::cerr << "Shared memory name should be / followed by a ";
+            std::cerr << "name without /, such as /vtk2raw." << std::endl;
+            exit(1);
+        }
+
+        if(Options.WriteTopology == true ||
+           (Options.WritePointData == true && Options.WriteCellData == true))
+        {
+            std::cerr << "Options --point-and-cell-data and --topology ";
+            std::cerr << "write several files, which can not be written to ";
+            std::cerr << "shared memory." << std::endl;
+            exit(1);
+        }
+
+        Options.BinaryOutputFile = true;
+        Options.SequentialOutputFile = false;
+    }
+
+    // Shards are files with the rows of the binary output, written at
+    // their offsets
+    if(IsShardedOutput(Options) == true &&
+       (Options.BinaryOutputFile == false ||
+        Options.SequentialOutputFile == true ||
+        Options.SharedMemoryOutput == true ||
+        Options.StackTimeSteps == true ||
+        Options.ConcatenateBlocks == true))
+    {
+        std::cerr << "Options --shards and --shard-size need binary output ";
+        std::cerr << "to files, and can not be used with --shared-memory, ";
+        std::cerr << "--stack-time-steps or --concatenate-blocks.";
+        std::cerr << std::endl;
+        exit(1);
+    }
 
-    // Read DataSet and write to output file
-    ReadDataSetWriteToOutput(InputFilename,OutputFilename,BinaryOutputFile);
+    // Read DataSet and write to output file. The message of an error is
+    // printed where it is thrown.
+    try
+    {
+        ReadDataSetWriteToOutput(InputFilename,OutputFilename,Options);
+    }
+    catch(const ConversionError &)
+    {
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -141,508 +392,12319 @@ void PrintUsage(char *ExecutableName)
     std::cerr << "Usage: " << ExecutableName;
     std::cerr << "  InputFileName.vtk  OutputFileName.raw  BinaryOutputFile";
     std::cerr << std::endl;
+    std::cerr << "       " << ExecutableName;
+    std::cerr << "  --probe  InputFileName.vtk  [InputFileName.vtk ...]";
+    std::cerr << std::endl;
+    std::cerr << "       " << ExecutableName;
+    std::cerr << "  --batch  OutputTemplate.raw  BinaryOutputFile  ";
+    std::cerr << "InputFileName.vtk  [...]" << std::endl;
+    std::cerr << "       " << ExecutableName;
+    std::cerr << "  --serve  SocketFileName" << std::endl;
     std::cerr << "BinaryOutputFile is optional, it can be either 0 or 1.";
     std::cerr << std::endl;
+    std::cerr << "InputFileName can be - to read the standard input, and ";
+    std::cerr << "OutputFileName can be -" << std::endl;
+    std::cerr << "to write the standard output." << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --probe    Read only the headers of input files and ";
+    std::cerr << "print a JSON summary" << std::endl;
+    std::cerr << "             of their arrays and output size, ";
+    std::cerr << "one line per file." << std::endl;
+    std::cerr << "  --arrays a,b,c" << std::endl;
+    std::cerr << "             Convert only the named arrays, ";
+    std::cerr << "in the given column order." << std::endl;
+    std::cerr << "  --cell-data" << std::endl;
+    std::cerr << "             Convert cell data arrays instead of point ";
+    std::cerr << "data arrays." << std::endl;
+    std::cerr << "  --point-and-cell-data" << std::endl;
+    std::cerr << "             Convert point data to the output file and ";
+    std::cerr << "cell data to" << std::endl;
+    std::cerr << "             OutputFileName.cell.raw." << std::endl;
+    std::cerr << "  --points   Append the x, y, z point coordinates as the ";
+    std::cerr << "last three columns." << std::endl;
+    std::cerr << "  --coordinates xyz|ijk" << std::endl;
+    std::cerr << "             For image data, append the point coordinates ";
+    std::cerr << "or indices" << std::endl;
+    std::cerr << "             computed from origin, spacing and extent." ;
+    std::cerr << std::endl;
+    std::cerr << "  --topology Also write cell offsets, connectivity and ";
+    std::cerr << "types to" << std::endl;
+    std::cerr << "             OutputFileName.offsets.raw, etc, in their ";
+    std::cerr << "binary types." << std::endl;
+    std::cerr << "  --extent i0 i1 j0 j1 k0 k1" << std::endl;
+    std::cerr << "             For image data, convert only the points in ";
+    std::cerr << "this sub-volume" << std::endl;
+    std::cerr << "             (and the cells between them). Only this ";
+    std::cerr << "part of the file is read" << std::endl;
+    std::cerr << "             where the reader supports it." << std::endl;
+    std::cerr << "  --slice x|y|z index" << std::endl;
+    std::cerr << "             For image data, convert only the plane of ";
+    std::cerr << "points with this index" << std::endl;
+    std::cerr << "             along the axis. Only the plane is read ";
+    std::cerr << "where the reader supports it." << std::endl;
+    std::cerr << "  --stride sx sy sz" << std::endl;
+    std::cerr << "             For image data, convert only every sx-th, ";
+    std::cerr << "sy-th and sz-th point" << std::endl;
+    std::cerr << "             in each direction." << std::endl;
+    std::cerr << "  --memory-limit size[K|M|G]" << std::endl;
+    std::cerr << "             Read and write the data in slabs of rows ";
+    std::cerr << "that fit in this" << std::endl;
+    std::cerr << "             memory (default unit M), instead of reading ";
+    std::cerr << "the whole dataset." << std::endl;
+    std::cerr << "             Gzip files read by the VTK readers ";
+    std::cerr << "are still decompressed" << std::endl;
+    std::cerr << "             into memory as a whole." << std::endl;
+    std::cerr << "  --threads n" << std::endl;
+    std::cerr << "             Number of threads that convert the pieces of ";
+    std::cerr << "partitioned files" << std::endl;
+    std::cerr << "             (default: number of cores)." << std::endl;
+    std::cerr << "  --concatenate-blocks" << std::endl;
+    std::cerr << "             Write the blocks of a multiblock file to one ";
+    std::cerr << "output file, with a" << std::endl;
+    std::cerr << "             table of the rows of each block in ";
+    std::cerr << "OutputFileName.blocks.txt." << std::endl;
+    std::cerr << "  --prefetch n" << std::endl;
+    std::cerr << "             Number of time steps of a time series (PVD) ";
+    std::cerr << "that are read ahead" << std::endl;
+    std::cerr << "             of the time step that is written ";
+    std::cerr << "(default: 1)." << std::endl;
+    std::cerr << "  --stack-time-steps" << std::endl;
+    std::cerr << "             Write the time steps of a time series to one ";
+    std::cerr << "binary output file" << std::endl;
+    std::cerr << "             of (time steps, rows, columns), with their ";
+    std::cerr << "offsets in" << std::endl;
+    std::cerr << "             OutputFileName.steps.txt." << std::endl;
+    std::cerr << "  --batch    Convert all input files, or glob patterns, ";
+    std::cerr << "with one thread pool." << std::endl;
+    std::cerr << "             Output file names are made from the template, ";
+    std::cerr << "in which {dir}," << std::endl;
+    std::cerr << "             {name} and {index} are the directory, the name ";
+    std::cerr << "without extension" << std::endl;
+    std::cerr << "             and the index of the input file." << std::endl;
+    std::cerr << "  --manifest file" << std::endl;
+    std::cerr << "             With --batch, also convert the input files ";
+    std::cerr << "listed in this file," << std::endl;
+    std::cerr << "             one per line." << std::endl;
+    std::cerr << "  --concatenate-files" << std::endl;
+    std::cerr << "             With --batch, write the rows of all input ";
+    std::cerr << "files to the binary" << std::endl;
+    std::cerr << "             output file OutputTemplate, with a table of ";
+    std::cerr << "the rows of each" << std::endl;
+    std::cerr << "             file in OutputTemplate.files.txt." << std::endl;
+    std::cerr << "  --shared-memory" << std::endl;
+    std::cerr << "             Write the binary output to the POSIX shared ";
+    std::cerr << "memory segment named" << std::endl;
+    std::cerr << "             OutputFileName, such as /vtk2raw, with a ";
+    std::cerr << "header of its shape and" << std::endl;
+    std::cerr << "             columns, and a ready flag." << std::endl;
+    std::cerr << "  --shards n" << std::endl;
+    std::cerr << "             Split the rows of the binary output into n ";
+    std::cerr << "files, such as" << std::endl;
+    std::cerr << "             OutputFileName.shard0.raw, written ";
+    std::cerr << "concurrently, with their rows," << std::endl;
+    std::cerr << "             sizes and CRC-32 in ";
+    std::cerr << "OutputFileName.shards.txt." << std::endl;
+    std::cerr << "  --shard-size size[K|M|G]" << std::endl;
+    std::cerr << "             As --shards, with as many rows in each file ";
+    std::cerr << "as fit in this size" << std::endl;
+    std::cerr << "             (default unit M)." << std::endl;
+    std::cerr << "  --serve socket" << std::endl;
+    std::cerr << "             Stay resident and convert jobs sent to this ";
+    std::cerr << "Unix domain socket," << std::endl;
+    std::cerr << "             one line of tab separated arguments per ";
+    std::cerr << "connection, with up to" << std::endl;
+    std::cerr << "             --threads jobs at once. Each job gets its ";
+    std::cerr << "messages and a line" << std::endl;
+    std::cerr << "             of exit status, time and memory." << std::endl;
 }
 
-// ============================
-// Read DataSet Write To Output
-// ============================
+// ===============
+// Parse Arguments
+// ===============
 
-void ReadDataSetWriteToOutput(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile)
-{
-    // Determine input file type
-    InputFileType InputFile =  DetermineInputFileType(InputFilename);
+// Description:
+// Options start with "--" and may appear anywhere on the command line. All
+// other arguments are returned in order as positional arguments.
 
-    // Read file
-    if(InputFile == VTK)
-    {
-        ReadVTKInputFileWriteToOutputFile(
-                InputFilename,
-                OutputFilename,
-                BinaryOutputFile);
-    }
-    else if(InputFile == VTI)
-    {
-        ReadVTIInputFileWriteToOutputFile(
-                InputFilename,
-                OutputFilename,
-                BinaryOutputFile);
-    }
-    else if(InputFile == VTP)
-    {
-        ReadVTPInputFileWriteToOutputFile(
-                InputFilename,
-                OutputFilename,
-                BinaryOutputFile);
-    }
-    else if(InputFile == VTU)
-    {
-        ReadVTUInputFileWriteToOutputFile(
-                InputFilename,
-                OutputFilename,
-                BinaryOutputFile);
-    }
-    else
+void ParseArguments(
+        int argc,
+        char *argv[],
+        ConversionOptions &Options,           // Output
+        std::vector<char*> &Arguments)        // Output
+{
+    for(int ArgumentIterator = 1;
+        ArgumentIterator < argc;
+        ArgumentIterator++)
     {
-        std::cerr << "Invalid input file type." << std::endl;
-        exit(1);
-    }
-}
+        std::string Argument(argv[ArgumentIterator]);
 
-// =========================
-// Determine Input File Type
-// =========================
+        // Positional arguments
+        if(Argument.compare(0,2,"--") != 0)
+        {
+            Arguments.push_back(argv[ArgumentIterator]);
+            continue;
+        }
 
-InputFileType DetermineInputFileType(char *InputFilename)
-{
-    // Get the file extension
-    char FileExtension[CHAR_LENGTH];
-    std::string InputFilenameString(InputFilename);
-    std::size_t FoundLastDot = InputFilenameString.find_last_of(".");
+        // Options
+        if(Argument == "--probe")
+        {
+            Options.Probe = true;
+        }
+        else if(Argument == "--cell-data")
+        {
+            Options.WritePointData = false;
+            Options.WriteCellData = true;
+        }
+        else if(Argument == "--point-and-cell-data")
+        {
+            Options.WritePointData = true;
+            Options.WriteCellData = true;
+        }
+        else if(Argument == "--points")
+        {
+            Options.WritePoints = true;
+        }
+        else if(Argument == "--topology")
+        {
+            Options.WriteTopology = true;
+        }
+        else if(Argument == "--coordinates")
+        {
+            std::string Coordinates = \
+                (ArgumentIterator + 1 < argc ? argv[++ArgumentIterator] : "");
+            if(Coordinates == "xyz")
+            {
+                Options.Coordinates = COORDINATES_XYZ;
+            }
+            else if(Coordinates == "ijk")
+            {
+                Options.Coordinates = COORDINATES_IJK;
+            }
+            else
+            {
+                std::cerr << "Option --coordinates should be xyz or ijk.";
+                std::cerr << std::endl;
+                exit(1);
+            }
+        }
+        else if(Argument == "--extent")
+        {
+            // Six point indices, inclusive
+            if(ArgumentIterator + 6 >= argc)
+            {
+                std::cerr << "Option --extent needs six indices: ";
+                std::cerr << "i0 i1 j0 j1 k0 k1." << std::endl;
+                exit(1);
+            }
+
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                char *End = NULL;
+                const char *Index = argv[++ArgumentIterator];
+                Options.Extent[i] = strtol(Index,&End,10);
+                if(End == Index || *End != '\0')
+                {
+                    std::cerr << "Invalid index in --extent: " << Index;
+                    std::cerr << std::endl;
+                    exit(1);
+                }
+            }
+
+            for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+            {
+                if(Options.Extent[2*Dimension] > Options.Extent[2*Dimension+1])
+                {
+                    std::cerr << "Empty extent in --extent." << std::endl;
+                    exit(1);
+                }
+            }
+
+            Options.ExtractExtent = true;
+        }
+        else if(Argument == "--slice")
+        {
+            // Axis and index of one plane
+            if(ArgumentIterator + 2 >= argc)
+            {
+                std::cerr << "Option --slice needs an axis and an index.";
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            std::string Axis = ToUpperCase(argv[++ArgumentIterator]);
+            const char *Index = argv[++ArgumentIterator];
+            char *End = NULL;
+            Options.SliceIndex = strtol(Index,&End,10);
+
+            if(Axis == "X" || Axis == "I")
+            {
+                Options.SliceAxis = 0;
+            }
+            else if(Axis == "Y" || Axis == "J")
+            {
+                Options.SliceAxis = 1;
+            }
+            else if(Axis == "Z" || Axis == "K")
+            {
+                Options.SliceAxis = 2;
+            }
+
+            if(Options.SliceAxis < 0 || End == Index || *End != '\0')
+            {
+                std::cerr << "Option --slice should be x, y or z, ";
+                std::cerr << "followed by an index." << std::endl;
+                exit(1);
+            }
+        }
+        else if(Argument == "--stride")
+        {
+            // Three positive steps
+            if(ArgumentIterator + 3 >= argc)
+            {
+                std::cerr << "Option --stride needs three steps: ";
+                std::cerr << "sx sy sz." << std::endl;
+                exit(1);
+            }
+
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                char *End = NULL;
+                const char *Step = argv[++ArgumentIterator];
+                Options.Stride[i] = strtol(Step,&End,10);
+                if(End == Step || *End != '\0' || Options.Stride[i] < 1)
+                {
+                    std::cerr << "Invalid step in --stride: " << Step;
+                    std::cerr << std::endl;
+                    exit(1);
+                }
+            }
+        }
+        else if(Argument == "--memory-limit")
+        {
+            // Size with an optional K, M or G unit, in megabytes by default
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --memory-limit needs a size." << std::endl;
+                exit(1);
+            }
+
+            const char *Size = argv[++ArgumentIterator];
+            if(ParseSize(Size,Options.MemoryLimit) == false)
+            {
+                std::cerr << "Invalid size in --memory-limit: " << Size;
+                std::cerr << std::endl;
+                exit(1);
+            }
+        }
+        else if(Argument == "--threads")
+        {
+            // Positive number of threads
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --threads needs a number." << std::endl;
+                exit(1);
+            }
+
+            char *End = NULL;
+            const char *Number = argv[++ArgumentIterator];
+            long NumberOfThreads = strtol(Number,&End,10);
+            if(End == Number || *End != '\0' || NumberOfThreads < 1)
+            {
+                std::cerr << "Invalid number in --threads: " << Number;
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            Options.NumberOfThreads = NumberOfThreads;
+        }
+        else if(Argument == "--concatenate-blocks")
+        {
+            Options.ConcatenateBlocks = true;
+        }
+        else if(Argument == "--shared-memory")
+        {
+            Options.SharedMemoryOutput = true;
+        }
+        else if(Argument == "--prefetch")
+        {
+            // Number of time steps, which may be 0
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --prefetch needs a number." << std::endl;
+                exit(1);
+            }
+
+            char *End = NULL;
+            const char *Number = argv[++ArgumentIterator];
+            long NumberOfSteps = strtol(Number,&End,10);
+            if(End == Number || *End != '\0' || NumberOfSteps < 0)
+            {
+                std::cerr << "Invalid number in --prefetch: " << Number;
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            Options.NumberOfPrefetchedSteps = NumberOfSteps;
+        }
+        else if(Argument == "--stack-time-steps")
+        {
+            Options.StackTimeSteps = true;
+        }
+        else if(Argument == "--batch")
+        {
+            Options.Batch = true;
+        }
+        else if(Argument == "--manifest")
+        {
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --manifest needs a file name.";
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            Options.Manifest = argv[++ArgumentIterator];
+        }
+        else if(Argument == "--concatenate-files")
+        {
+            Options.ConcatenateFiles = true;
+        }
+        else if(Argument == "--shards")
+        {
+            // Positive number of shard files
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --shards needs a number." << std::endl;
+                exit(1);
+            }
+
+            char *End = NULL;
+            const char *Number = argv[++ArgumentIterator];
+            long NumberOfShards = strtol(Number,&End,10);
+            if(End == Number || *End != '\0' || NumberOfShards < 1)
+            {
+                std::cerr << "Invalid number in --shards: " << Number;
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            Options.NumberOfShards = NumberOfShards;
+            Options.ShardSize = 0;
+        }
+        else if(Argument == "--shard-size")
+        {
+            // Size with an optional K, M or G unit, in megabytes by default
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --shard-size needs a size." << std::endl;
+                exit(1);
+            }
+
+            const char *Size = argv[++ArgumentIterator];
+            if(ParseSize(Size,Options.ShardSize) == false)
+            {
+                std::cerr << "Invalid size in --shard-size: " << Size;
+                std::cerr << std::endl;
+                exit(1);
+            }
+            Options.NumberOfShards = 0;
+        }
+        else if(Argument == "--serve")
+        {
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --serve needs a socket file name.";
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            Options.ServerSocket = argv[++ArgumentIterator];
+        }
+        else if(Argument == "--arrays")
+        {
+            // Comma separated list of array names
+            if(ArgumentIterator + 1 >= argc)
+            {
+                std::cerr << "Option --arrays needs a list of names.";
+                std::cerr << std::endl;
+                exit(1);
+            }
+
+            std::istringstream NamesStream(argv[++ArgumentIterator]);
+            std::string Name;
+            while(std::getline(NamesStream,Name,','))
+            {
+                if(Name.empty() == false)
+                {
+                    Options.ArrayNames.push_back(Name);
+                }
+            }
+        }
+        else if(Argument == "--help")
+        {
+            PrintUsage(argv[0]);
+            exit(0);
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << Argument << std::endl;
+            PrintUsage(argv[0]);
+            exit(1);
+        }
+    }
+
+    // A slice is a sub-volume with a single index in the slice axis
+    if(Options.SliceAxis >= 0)
+    {
+        if(Options.ExtractExtent == false)
+        {
+            for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+            {
+                Options.Extent[2*Dimension] = \
+                    std::numeric_limits<int>::min();
+                Options.Extent[2*Dimension+1] = \
+                    std::numeric_limits<int>::max();
+            }
+        }
+
+        Options.Extent[2*Options.SliceAxis] = Options.SliceIndex;
+        Options.Extent[2*Options.SliceAxis+1] = Options.SliceIndex;
+        Options.ExtractExtent = true;
+    }
+}
+
+// ==========
+// Parse Size
+// ==========
+
+// Description:
+// Parses a positive size with an optional K, M or G unit, in megabytes by
+// default.
+
+bool ParseSize(
+        const char *Size,
+        unsigned long long &Bytes)
+{
+    char *End = NULL;
+    unsigned long long Number = strtoull(Size,&End,10);
+    unsigned long long Unit = 1ULL << 20;
+    if(End != Size && (*End == 'K' || *End == 'k'))
+    {
+        Unit = 1ULL << 10;
+        End++;
+    }
+    else if(End != Size && (*End == 'M' || *End == 'm'))
+    {
+        End++;
+    }
+    else if(End != Size && (*End == 'G' || *End == 'g'))
+    {
+        Unit = 1ULL << 30;
+        End++;
+    }
+
+    if(End == Size || *End != '\0' || Number == 0 || Size[0] == '-')
+    {
+        return false;
+    }
+
+    Bytes = Number * Unit;
+    return true;
+}
+
+// =========================
+// Get Batch Input Filenames
+// =========================
+
+// Description:
+// The input files of a batch, in order: each pattern that has a wildcard
+// (*, ? or [) is expanded to the files that match it, sorted by name, and
+// other patterns are file names. Patterns are expanded here, since a shell
+// can not pass tens of thousands of file names to one process. Then the
+// files listed in the manifest, one per line, are added. Empty lines and
+// lines that start with # are skipped.
+
+void GetBatchInputFilenames(
+        const std::vector<char*> &Patterns,
+        const std::string &Manifest,
+        std::vector<std::string> &InputFilenames)    // Output
+{
+    InputFilenames.clear();
+
+    for(unsigned int PatternIterator = 0;
+        PatternIterator < Patterns.size();
+        PatternIterator++)
+    {
+        const char *Pattern = Patterns[PatternIterator];
+        if(strpbrk(Pattern,"*?[") == NULL)
+        {
+            InputFilenames.push_back(Pattern);
+            continue;
+        }
+
+        glob_t Matches;
+        if(glob(Pattern,0,NULL,&Matches) != 0)
+        {
+            std::cerr << "No input file matches: " << Pattern << std::endl;
+            exit(1);
+        }
+
+        for(std::size_t MatchIterator = 0;
+            MatchIterator < Matches.gl_pathc;
+            MatchIterator++)
+        {
+            InputFilenames.push_back(Matches.gl_pathv[MatchIterator]);
+        }
+        globfree(&Matches);
+    }
+
+    if(Manifest.empty() == true)
+    {
+        return;
+    }
+
+    std::ifstream ManifestFile(Manifest.c_str());
+    if(ManifestFile.is_open() != true)
+    {
+        std::cerr << "Can not open manifest file: " << Manifest << std::endl;
+        exit(1);
+    }
+
+    std::string Line;
+    while(std::getline(ManifestFile,Line))
+    {
+        // Trim white space, and a carriage return
+        std::size_t First = Line.find_first_not_of(" \t\r");
+        std::size_t Last = Line.find_last_not_of(" \t\r");
+        if(First == std::string::npos || Line[First] == '#')
+        {
+            continue;
+        }
+
+        InputFilenames.push_back(Line.substr(First,Last-First+1));
+    }
+}
+
+// ==========================
+// Make Batch Output Filename
+// ==========================
+
+// Description:
+// Replaces {dir}, {name} and {index} in the output template by the
+// directory of the input file (. if it has none), its name without the
+// directory, the .gz extension and its own extension, and its index in the
+// list of input files. For example, out/{name}.raw makes out/a.raw for the
+// input file data/a.vtu.
+
+std::string MakeBatchOutputFilename(
+        const std::string &OutputTemplate,
+        const std::string &InputFilename,
+        unsigned int Index)
+{
+    // Directory and name
+    std::size_t LastSlash = InputFilename.find_last_of("/");
+    std::string Directory = (LastSlash == std::string::npos ? "." :
+            InputFilename.substr(0,std::max<std::size_t>(LastSlash,1)));
+    std::string Name = (LastSlash == std::string::npos ? InputFilename :
+            InputFilename.substr(LastSlash+1));
+
+    if(Name.size() > 3 && Name.compare(Name.size()-3,3,".gz") == 0)
+    {
+        Name.erase(Name.size()-3);
+    }
+
+    std::size_t LastDot = Name.find_last_of(".");
+    if(LastDot != std::string::npos && LastDot > 0)
+    {
+        Name.erase(LastDot);
+    }
+
+    std::ostringstream IndexStream;
+    IndexStream << Index;
+
+    // Replace the fields
+    const char *Fields[3] = {"{dir}","{name}","{index}"};
+    std::string Values[3] = {Directory,Name,IndexStream.str()};
+    std::string OutputFilename;
+    for(std::size_t Position = 0; Position < OutputTemplate.size();)
+    {
+        bool Replaced = false;
+        for(unsigned int FieldIterator = 0;
+            FieldIterator < 3 && Replaced == false;
+            FieldIterator++)
+        {
+            std::size_t FieldLength = strlen(Fields[FieldIterator]);
+            if(OutputTemplate.compare(Position,FieldLength,
+                        Fields[FieldIterator]) == 0)
+            {
+                OutputFilename += Values[FieldIterator];
+                Position += FieldLength;
+                Replaced = true;
+            }
+        }
+
+        if(Replaced == false)
+        {
+            OutputFilename += OutputTemplate[Position++];
+        }
+    }
+
+    return OutputFilename;
+}
+
+// ==================
+// Get Message Stream
+// ==================
+
+// Description:
+// The messages of a conversion are printed to the message stream of its
+// thread, which is the standard output, unless the thread is a worker of a
+// pool. A pool gives its workers the stream buffer of the thread that
+// starts it, or none if the messages of its jobs would be mixed, and each
+// worker prints through an output stream of its own on that buffer, such
+// that the workers never share the state of a stream, and the standard
+// output is never switched while other threads print to it.
+
+static thread_local std::ostream *ThreadMessageStream = NULL;
+
+std::ostream &GetMessageStream()
+{
+    return ThreadMessageStream != NULL ? *ThreadMessageStream : std::cout;
+}
+
+// ==================
+// Set Message Stream
+// ==================
+
+void SetMessageStream(std::ostream *MessageStream)
+{
+    ThreadMessageStream = MessageStream;
+}
+
+// =============
+// Convert Batch
+// =============
+
+// Description:
+// Converts many input files in one process, so that VTK is loaded once,
+// with one pool of threads that lives for the whole batch. The files are
+// sorted by size, largest first, and each thread takes the next file that
+// is not yet converted. The large files then start first, and the small
+// files at the end fill the threads that become idle, which balances the
+// threads as well as stealing work from each other would, since the files
+// are independent.
+//
+// While there are more files left than threads, each file is converted by
+// one thread. The last files are given the threads of the files that are
+// done, for their pieces (see --threads).
+//
+// All input files are checked to exist, and all output file names to be
+// distinct, before any file is converted. A file that fails to convert
+// does not stop the batch: its error is printed, the other files are
+// converted, and the files that failed are listed at the end, with a
+// failure status.
+//
+// With --concatenate-files, the rows of all input files are written to one
+// binary output file, in the order of the input files. The headers of all
+// files are read first, from which their arrays are checked to be the same
+// and the first row of each file in the output is known, so an input that
+// does not fit fails before any data is read. The output file is then
+// sized, and each thread writes the rows of its file directly into the
+// region of the file, such that the files are converted concurrently and
+// never copied. The files are sorted by the size of their rows.
+
+struct BatchConversion
+{
+    std::vector<std::string> InputFilenames;    // Largest first
+    std::vector<std::string> OutputFilenames;
+    std::vector<unsigned long long> RegionOffsets;  // Concatenated: region
+    std::vector<unsigned long long> RegionSizes;    // of each file
+    ConversionOptions Options;           // Options of each file
+    unsigned int NumberOfThreads;        // Threads of the whole batch
+    unsigned int NumberOfPoolThreads;    // Threads that take files
+    std::atomic<unsigned int> NextFile;
+    std::atomic<unsigned int> NumberOfIdleThreads;  // Threads of the batch
+                                         // that convert no file
+    std::streambuf *MessageBuffer;       // Messages of each file, or NULL
+                                         // to discard them
+    unsigned int NumberOfConvertedFiles;
+    std::vector<std::string> FailedFilenames;
+    std::mutex LogMutex;                 // Guards Log, the count and the
+    std::ostream *Log;                   // failed files
+};
+
+void ConvertBatch(
+        const std::vector<std::string> &InputFilenames,
+        const char *OutputTemplate,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    unsigned int NumberOfFiles = InputFilenames.size();
+    if(NumberOfFiles == 0)
+    {
+        std::cerr << "No input file to convert." << std::endl;
+        throw ConversionError();
+    }
+
+    // Negative sizes of the files, and their output file names
+    std::vector<std::pair<long long,unsigned int> > Sizes;
+    std::vector<std::string> OutputFilenames;
+    for(unsigned int FileIterator = 0;
+        FileIterator < NumberOfFiles;
+        FileIterator++)
+    {
+        const std::string &InputFilename = InputFilenames[FileIterator];
+        struct stat Status;
+        if(stat(InputFilename.c_str(),&Status) != 0)
+        {
+            std::cerr << "Can not open input file: " << InputFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        Sizes.push_back(std::make_pair(
+                -static_cast<long long>(Status.st_size),FileIterator));
+        OutputFilenames.push_back(Options.ConcatenateFiles == true ?
+                std::string(OutputTemplate) :
+                MakeBatchOutputFilename(OutputTemplate,InputFilename,
+                    FileIterator));
+    }
+
+    std::vector<std::string> SortedOutputFilenames(OutputFilenames);
+    std::sort(SortedOutputFilenames.begin(),SortedOutputFilenames.end());
+    std::vector<std::string>::iterator Duplicate = std::adjacent_find(
+            SortedOutputFilenames.begin(),SortedOutputFilenames.end());
+    if(Options.ConcatenateFiles == false &&
+       Duplicate != SortedOutputFilenames.end())
+    {
+        std::cerr << "Output file name is made for more than one input ";
+        std::cerr << "file: " << *Duplicate << ". Use {name}, {dir} or ";
+        std::cerr << "{index} in the template." << std::endl;
+        throw ConversionError();
+    }
+
+    // Rows of each file in the concatenated output, which is sized to the
+    // rows of all files, and opened again by the threads to write
+    std::vector<unsigned long long> FirstRows;
+    std::vector<unsigned long long> NumberOfRows;
+    unsigned int NumberOfColumns = 0;
+    unsigned long long RowSize = 0;
+    if(Options.ConcatenateFiles == true)
+    {
+        GetConcatenationLayout(InputFilenames,Options,FirstRows,NumberOfRows,
+                NumberOfColumns);
+        RowSize = NumberOfColumns * sizeof(double);
+
+        for(unsigned int FileIterator = 0;
+            FileIterator < NumberOfFiles;
+            FileIterator++)
+        {
+            Sizes[FileIterator].first = \
+                -static_cast<long long>(NumberOfRows[FileIterator] * RowSize);
+        }
+
+        OutputFileStream OutputFile;
+        OpenFile(OutputTemplate,true,OutputFile);
+        OutputFile.close();
+
+        if(truncate(OutputTemplate,
+                    (FirstRows.back() + NumberOfRows.back()) * RowSize) != 0)
+        {
+            std::cerr << "Can not allocate output file: " << OutputTemplate;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    // Largest files first, in input order for the same size. Files without
+    // rows have nothing to write to a concatenated output.
+    BatchConversion Conversion;
+    std::sort(Sizes.begin(),Sizes.end());
+    for(unsigned int FileIterator = 0;
+        FileIterator < NumberOfFiles;
+        FileIterator++)
+    {
+        unsigned int FileIndex = Sizes[FileIterator].second;
+        if(Options.ConcatenateFiles == true)
+        {
+            if(NumberOfRows[FileIndex] == 0)
+            {
+                continue;
+            }
+            Conversion.RegionOffsets.push_back(FirstRows[FileIndex] * RowSize);
+            Conversion.RegionSizes.push_back(NumberOfRows[FileIndex] * RowSize);
+        }
+
+        Conversion.InputFilenames.push_back(InputFilenames[FileIndex]);
+        Conversion.OutputFilenames.push_back(OutputFilenames[FileIndex]);
+    }
+
+    Conversion.Options = Options;
+    Conversion.Options.Batch = false;
+    Conversion.NumberOfThreads = GetNumberOfThreads(Options,
+            std::numeric_limits<unsigned int>::max());
+    Conversion.NumberOfPoolThreads = std::min<unsigned int>(
+            Conversion.NumberOfThreads,Conversion.InputFilenames.size());
+    Conversion.NextFile = 0;
+    Conversion.NumberOfIdleThreads = Conversion.NumberOfThreads - \
+        Conversion.NumberOfPoolThreads;
+    Conversion.NumberOfConvertedFiles = 0;
+
+    Messages << "Files: " << NumberOfFiles << ", Threads: ";
+    Messages << Conversion.NumberOfPoolThreads << std::endl;
+
+    // Messages of files that are converted at the same time would be mixed,
+    // so only one line per file is printed
+    Conversion.MessageBuffer = (Conversion.NumberOfPoolThreads > 1 ?
+            NULL : Messages.rdbuf());
+    Conversion.Log = &Messages;
+
+    // Pool of threads
+    std::vector<std::thread> Threads;
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < Conversion.NumberOfPoolThreads;
+        ThreadIterator++)
+    {
+        Threads.push_back(std::thread(ConvertBatchOnThread,&Conversion));
+    }
+
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < Conversion.NumberOfPoolThreads;
+        ThreadIterator++)
+    {
+        Threads[ThreadIterator].join();
+    }
+
+    // The error of each file that failed was printed by its thread
+    if(Conversion.FailedFilenames.empty() == false)
+    {
+        if(Options.ConcatenateFiles == false)
+        {
+            Messages << Conversion.NumberOfConvertedFiles;
+            Messages << " files were converted." << std::endl;
+        }
+
+        std::cerr << Conversion.FailedFilenames.size() << " of ";
+        std::cerr << NumberOfFiles << " files could not be converted:";
+        std::cerr << std::endl;
+        for(unsigned int FileIterator = 0;
+            FileIterator < Conversion.FailedFilenames.size();
+            FileIterator++)
+        {
+            std::cerr << "  " << Conversion.FailedFilenames[FileIterator];
+            std::cerr << std::endl;
+        }
+        throw ConversionError();
+    }
+
+    if(Options.ConcatenateFiles == true)
+    {
+        Messages << NumberOfFiles << " files were written to: ";
+        Messages << OutputTemplate << "." << std::endl;
+        Messages << "Rows: " << FirstRows.back() + NumberOfRows.back();
+        Messages << ", Columns: " << NumberOfColumns << "." << std::endl;
+
+        WriteConcatenationTable(InputFilenames,FirstRows,NumberOfRows,
+                OutputTemplate);
+    }
+    else
+    {
+        Messages << NumberOfFiles << " files were converted." << std::endl;
+    }
+}
+
+// =======================
+// Convert Batch On Thread
+// =======================
+
+// Description:
+// One thread of the pool. Each thread takes the next file that is not yet
+// converted, until all files are converted. A file that is started is
+// given a share of the idle threads, which are the threads of the batch
+// that are not in the pool, and the threads that have no file left to
+// take. The file gives them back when it is done, such that the threads
+// of all files that are converted at once are never more than --threads.
+
+void ConvertBatchOnThread(BatchConversion *Conversion)
+{
+    std::ostream Messages(Conversion->MessageBuffer);
+    SetMessageStream(&Messages);
+
+    unsigned int NumberOfFiles = Conversion->InputFilenames.size();
+    for(unsigned int FileIndex = Conversion->NextFile++;
+        FileIndex < NumberOfFiles;
+        FileIndex = Conversion->NextFile++)
+    {
+        const std::string &InputFilename = \
+            Conversion->InputFilenames[FileIndex];
+        const std::string &OutputFilename = \
+            Conversion->OutputFilenames[FileIndex];
+
+        // Threads of the file: its own thread and its share of the idle
+        // threads, shared with the files that are left to start
+        unsigned int NumberOfFilesLeft = std::min(NumberOfFiles - FileIndex,
+                Conversion->NumberOfPoolThreads);
+        unsigned int NumberOfIdleThreads = Conversion->NumberOfIdleThreads;
+        unsigned int NumberOfTakenThreads = 0;
+        do
+        {
+            NumberOfTakenThreads = NumberOfIdleThreads / NumberOfFilesLeft;
+        }
+        while(Conversion->NumberOfIdleThreads.compare_exchange_weak(
+                    NumberOfIdleThreads,
+                    NumberOfIdleThreads - NumberOfTakenThreads) == false);
+
+        ConversionOptions FileOptions = Conversion->Options;
+        FileOptions.NumberOfThreads = 1 + NumberOfTakenThreads;
+        FileOptions.SequentialOutputFile = \
+            IsSequentialOutputFile(OutputFilename.c_str());
+
+        // A concatenated file is written to its region of the output
+        if(Conversion->RegionSizes.empty() == false)
+        {
+            FileOptions.RegionOutput = true;
+            FileOptions.RegionOffset = Conversion->RegionOffsets[FileIndex];
+            FileOptions.RegionSize = Conversion->RegionSizes[FileIndex];
+        }
+
+        // The error of a file that fails is printed where it is thrown, and
+        // the thread goes on with the next file
+        bool Converted = true;
+        try
+        {
+            ReadDataSetWriteToOutput(
+                    InputFilename.c_str(),
+                    OutputFilename.c_str(),
+                    FileOptions);
+        }
+        catch(const ConversionError &)
+        {
+            Converted = false;
+        }
+        Conversion->NumberOfIdleThreads += NumberOfTakenThreads;
+
+        std::lock_guard<std::mutex> Lock(Conversion->LogMutex);
+        if(Converted == false)
+        {
+            Conversion->FailedFilenames.push_back(InputFilename);
+            continue;
+        }
+
+        Conversion->NumberOfConvertedFiles++;
+        *Conversion->Log << "File " << Conversion->NumberOfConvertedFiles;
+        *Conversion->Log << " of " << NumberOfFiles << ": " << InputFilename;
+        *Conversion->Log << " -> " << OutputFilename << std::endl;
+    }
+
+    // No file is left for this thread
+    Conversion->NumberOfIdleThreads++;
+}
+
+// ========================
+// Get Concatenation Layout
+// ========================
+
+// Description:
+// The first row and the number of rows of each input file in the
+// concatenated output, and the columns of all files, found from the
+// headers of the input files. All files should have the same selected
+// arrays.
+
+void GetConcatenationLayout(
+        const std::vector<std::string> &InputFilenames,
+        const ConversionOptions &Options,
+        std::vector<unsigned long long> &FirstRows,       // Output
+        std::vector<unsigned long long> &NumberOfRows,    // Output
+        unsigned int &NumberOfColumns)                    // Output
+{
+    if(Options.BinaryOutputFile == false || Options.WriteTopology == true ||
+       (Options.WritePointData == true && Options.WriteCellData == true))
+    {
+        std::cerr << "Option --concatenate-files needs binary output, and ";
+        std::cerr << "can not be used with --point-and-cell-data or ";
+        std::cerr << "--topology." << std::endl;
+        throw ConversionError();
+    }
+
+    unsigned int Attribute = (Options.WritePointData == true ? 0 : 1);
+    std::vector<ArrayHeader> FirstArrays;
+    unsigned long long Row = 0;
+
+    FirstRows.clear();
+    NumberOfRows.clear();
+
+    for(unsigned int FileIterator = 0;
+        FileIterator < InputFilenames.size();
+        FileIterator++)
+    {
+        const std::string &InputFilename = InputFilenames[FileIterator];
+
+        std::vector<ArrayHeader> Arrays;
+        unsigned long long Rows = 0;
+        unsigned int Columns = 0;
+        if(GetOutputShape(InputFilename.c_str(),Attribute,Options,Arrays,
+                    Rows,Columns) == false)
+        {
+            std::cerr << "Files can not be concatenated: the rows of ";
+            std::cerr << InputFilename << " are not known from its header.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        if(FileIterator == 0)
+        {
+            FirstArrays = Arrays;
+            NumberOfColumns = Columns;
+        }
+        else if(Columns != NumberOfColumns ||
+                HaveSameArrays(Arrays,FirstArrays) == false)
+        {
+            std::cerr << "Files can not be concatenated: " << InputFilename;
+            std::cerr << " has other arrays than " << InputFilenames[0];
+            std::cerr << "." << std::endl;
+            throw ConversionError();
+        }
+
+        FirstRows.push_back(Row);
+        NumberOfRows.push_back(Rows);
+        Row += Rows;
+    }
+
+    if(Row == 0 || NumberOfColumns == 0)
+    {
+        std::cerr << "Files can not be concatenated: files have no rows or ";
+        std::cerr << "no arrays to write." << std::endl;
+        throw ConversionError();
+    }
+}
+
+// =========================
+// Write Concatenation Table
+// =========================
+
+// Description:
+// Writes the table of the concatenated files to OutputFileName.files.txt,
+// one line per input file, in the order of the input files, with the first
+// row and the number of rows of the file in the output.
+
+void WriteConcatenationTable(
+        const std::vector<std::string> &InputFilenames,
+        const std::vector<unsigned long long> &FirstRows,
+        const std::vector<unsigned long long> &NumberOfRows,
+        const char *OutputFilename)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    std::string IndexFilename = MakeTableFilename(OutputFilename,"files");
+
+    OutputFileStream IndexFile;
+    OpenFile(IndexFilename.c_str(),false,IndexFile);
+
+    IndexFile << "Index\tFirstRow\tNumberOfRows\tFile\n";
+    for(unsigned int FileIterator = 0;
+        FileIterator < InputFilenames.size();
+        FileIterator++)
+    {
+        IndexFile << FileIterator << "\t" << FirstRows[FileIterator] << "\t";
+        IndexFile << NumberOfRows[FileIterator] << "\t";
+        IndexFile << InputFilenames[FileIterator] << "\n";
+    }
+
+    if(IndexFile.good() != true)
+    {
+        std::cerr << "Can not write to output file: " << IndexFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+    IndexFile.close();
+
+    Messages << "Table of files was written to: " << IndexFilename << ".";
+    Messages << std::endl;
+}
+
+// =================
+// Serve Conversions
+// =================
+
+// Description:
+// Server mode. The program stays resident and converts the jobs of clients
+// of a Unix domain socket, so that a job does not pay for starting the
+// process and loading the VTK libraries. A client connects, sends one line
+// with the arguments of a command line separated by tabs, such as
+//
+//     InputFileName.vti <TAB> OutputFileName.raw <TAB> 1 <NEW LINE>
+//
+// and reads the messages of the conversion until the connection is closed.
+// The last line is the status of the job:
+//
+//     Exit: 0, Time: 3.2 ms, CPU: 2.9 ms, Memory: 24576 KB
+//
+// Each job is converted by a process that is forked from the server, which
+// has the libraries already loaded, so that a job that fails and exits, as
+// the conversions do on errors, does not stop the server. Up to --threads
+// jobs (default: number of cores) are converted at once, and the cores are
+// shared by the jobs: a job without its own --threads option converts with
+// the number of cores divided by the number of jobs, and at least one
+// thread. A job whose line is not received within JOB_LINE_TIMEOUT seconds
+// fails, so that a client that connects and sends nothing does not hold a
+// job. Relative file names are relative to the directory of the server.
+// SIGINT or SIGTERM stop the server once the running jobs are finished.
+
+struct ServerJob
+{
+    int Connection;                      // Socket of the client
+    unsigned long long Index;
+    std::chrono::steady_clock::time_point StartTime;
+};
+
+// Pipe on which the signal handler wakes the server, -1 if not serving
+static int ServerSignalPipe[2] = {-1,-1};
+
+void ServeConversions(
+        const ConversionOptions &Options,
+        char *ExecutableName)
+{
+    const char *SocketFilename = Options.ServerSocket.c_str();
+
+    sockaddr_un Address;
+    memset(&Address,0,sizeof(Address));
+    Address.sun_family = AF_UNIX;
+    if(Options.ServerSocket.size() >= sizeof(Address.sun_path))
+    {
+        std::cerr << "Socket file name is too long: " << SocketFilename;
+        std::cerr << std::endl;
+        exit(1);
+    }
+    strcpy(Address.sun_path,SocketFilename);
+
+    // A socket file that no server accepts on is left by a server that was
+    // killed, and is replaced
+    int Server = socket(AF_UNIX,SOCK_STREAM,0);
+    struct stat FileStatus;
+    if(Server >= 0 && stat(SocketFilename,&FileStatus) == 0 &&
+       S_ISSOCK(FileStatus.st_mode))
+    {
+        if(connect(Server,reinterpret_cast<sockaddr*>(&Address),
+                    sizeof(Address)) == 0)
+        {
+            std::cerr << "A server is already running on socket: ";
+            std::cerr << SocketFilename << std::endl;
+            exit(1);
+        }
+
+        unlink(SocketFilename);
+        close(Server);
+        Server = socket(AF_UNIX,SOCK_STREAM,0);
+    }
+
+    if(Server < 0 ||
+       bind(Server,reinterpret_cast<sockaddr*>(&Address),
+            sizeof(Address)) != 0 ||
+       listen(Server,SOMAXCONN) != 0)
+    {
+        std::cerr << "Can not serve on socket: " << SocketFilename;
+        std::cerr << std::endl;
+        exit(1);
+    }
+
+    // Finished jobs and stop requests wake the server through a pipe
+    if(pipe(ServerSignalPipe) != 0)
+    {
+        std::cerr << "Can not create pipe of the server." << std::endl;
+        exit(1);
+    }
+    fcntl(ServerSignalPipe[1],F_SETFL,O_NONBLOCK);
+
+    struct sigaction Action;
+    memset(&Action,0,sizeof(Action));
+    Action.sa_handler = NotifyServer;
+    Action.sa_flags = SA_NOCLDSTOP;
+    sigemptyset(&Action.sa_mask);
+    sigaction(SIGCHLD,&Action,NULL);
+    sigaction(SIGINT,&Action,NULL);
+    sigaction(SIGTERM,&Action,NULL);
+    signal(SIGPIPE,SIG_IGN);
+
+    unsigned int MaximumNumberOfJobs = GetNumberOfThreads(Options,
+            std::numeric_limits<unsigned int>::max());
+    unsigned int NumberOfJobThreads = std::max(1U,
+            std::thread::hardware_concurrency() / MaximumNumberOfJobs);
+    std::map<pid_t,ServerJob> Jobs;
+    unsigned long long NumberOfJobs = 0;
+    bool Stopping = false;
+
+    std::cout << "Serving on socket: " << SocketFilename << ", Jobs: ";
+    std::cout << MaximumNumberOfJobs << ", Threads per job: ";
+    std::cout << NumberOfJobThreads << std::endl;
+
+    while(Stopping == false || Jobs.empty() == false)
+    {
+        // Accept jobs only while fewer than the maximum are running
+        pollfd Descriptors[2];
+        Descriptors[0].fd = ServerSignalPipe[0];
+        Descriptors[0].events = POLLIN;
+        Descriptors[1].fd = Server;
+        Descriptors[1].events = (Stopping == false &&
+                Jobs.size() < MaximumNumberOfJobs) ? POLLIN : 0;
+
+        if(poll(Descriptors,2,-1) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "Can not wait for jobs." << std::endl;
+            exit(1);
+        }
+
+        if((Descriptors[0].revents & POLLIN) != 0)
+        {
+            char Signals[64];
+            ssize_t NumberOfSignals = read(ServerSignalPipe[0],Signals,
+                    sizeof(Signals));
+            for(ssize_t SignalIterator = 0;
+                SignalIterator < NumberOfSignals;
+                SignalIterator++)
+            {
+                if(Signals[SignalIterator] != SIGCHLD)
+                {
+                    Stopping = true;
+                }
+            }
+
+            FinishServerJobs(Jobs);
+        }
+
+        if((Descriptors[1].revents & POLLIN) == 0)
+        {
+            continue;
+        }
+
+        int Connection = accept(Server,NULL,NULL);
+        if(Connection < 0)
+        {
+            continue;
+        }
+
+        std::cout.flush();
+        pid_t ProcessId = fork();
+        if(ProcessId == 0)
+        {
+            close(Server);
+            close(ServerSignalPipe[0]);
+            close(ServerSignalPipe[1]);
+
+            // The client of another job reads until its connection is
+            // closed by all processes, not only by the server
+            for(std::map<pid_t,ServerJob>::iterator Job = Jobs.begin();
+                Job != Jobs.end();
+                Job++)
+            {
+                close(Job->second.Connection);
+            }
+
+            signal(SIGCHLD,SIG_DFL);
+            signal(SIGINT,SIG_DFL);
+            signal(SIGTERM,SIG_DFL);
+            RunServerJob(Connection,ExecutableName,NumberOfJobThreads);
+        }
+        else if(ProcessId < 0)
+        {
+            const char Message[] = "Can not start job.\nExit: 1\n";
+            send(Connection,Message,sizeof(Message)-1,MSG_NOSIGNAL);
+            close(Connection);
+            continue;
+        }
+
+        ServerJob &Job = Jobs[ProcessId];
+        Job.Connection = Connection;
+        Job.Index = NumberOfJobs++;
+        Job.StartTime = std::chrono::steady_clock::now();
+    }
+
+    close(Server);
+    unlink(SocketFilename);
+
+    std::cout << "Server was stopped after " << NumberOfJobs << " jobs.";
+    std::cout << std::endl;
+}
+
+// =============
+// Notify Server
+// =============
+
+// Description:
+// Signal handler of the server, which writes the signal to the pipe that
+// the server waits on.
+
+void NotifyServer(int Signal)
+{
+    int SavedErrno = errno;
+    char Byte = static_cast<char>(Signal);
+    ssize_t Result = write(ServerSignalPipe[1],&Byte,1);
+    static_cast<void>(Result);
+    errno = SavedErrno;
+}
+
+// ==================
+// Finish Server Jobs
+// ==================
+
+// Description:
+// Reaps the jobs that have exited, and sends the status line of each job
+// to its client. The connection is written without blocking, since a
+// client that does not read should not hold the server back.
+
+void FinishServerJobs(std::map<pid_t,ServerJob> &Jobs)
+{
+    int Status = 0;
+    rusage Usage;
+    pid_t ProcessId;
+    while((ProcessId = wait4(-1,&Status,WNOHANG,&Usage)) > 0)
+    {
+        std::map<pid_t,ServerJob>::iterator Job = Jobs.find(ProcessId);
+        if(Job == Jobs.end())
+        {
+            continue;
+        }
+
+        std::chrono::duration<double,std::milli> Time = \
+            std::chrono::steady_clock::now() - Job->second.StartTime;
+        double ProcessorTime = \
+            (Usage.ru_utime.tv_sec + Usage.ru_stime.tv_sec) * 1e3 +
+            (Usage.ru_utime.tv_usec + Usage.ru_stime.tv_usec) * 1e-3;
+        int ExitStatus = WIFEXITED(Status) ? WEXITSTATUS(Status) :
+            128 + WTERMSIG(Status);
+
+        std::ostringstream StatusLine;
+        StatusLine << std::fixed << std::setprecision(1);
+        StatusLine << "Exit: " << ExitStatus << ", Time: " << Time.count();
+        StatusLine << " ms, CPU: " << ProcessorTime << " ms, Memory: ";
+        StatusLine << Usage.ru_maxrss << " KB" << std::endl;
+
+        int Connection = Job->second.Connection;
+        fcntl(Connection,F_SETFL,fcntl(Connection,F_GETFL) | O_NONBLOCK);
+        send(Connection,StatusLine.str().c_str(),StatusLine.str().size(),
+                MSG_NOSIGNAL);
+        close(Connection);
+
+        std::cout << "Job " << Job->second.Index << ": " << StatusLine.str();
+        std::cout.flush();
+
+        Jobs.erase(Job);
+    }
+}
+
+// ==============
+// Run Server Job
+// ==============
+
+// Description:
+// Runs a job in the process forked for it, with the messages written to
+// the client, and exits with the status of the job. Jobs read and write
+// files or shared memory, not the standard input and output, which are the
+// connection. A job without a --threads option is given NumberOfThreads.
+
+void RunServerJob(
+        int Connection,
+        char *ExecutableName,
+        unsigned int NumberOfThreads)
+{
+    // A client that does not send its line would hold the job forever
+    timeval Timeout;
+    Timeout.tv_sec = JOB_LINE_TIMEOUT;
+    Timeout.tv_usec = 0;
+    setsockopt(Connection,SOL_SOCKET,SO_RCVTIMEO,&Timeout,sizeof(Timeout));
+
+    std::vector<std::string> JobArguments;
+    bool ValidJob = ReadJobArguments(Connection,JobArguments);
+
+    int NullFile = open("/dev/null",O_RDONLY);
+    dup2(NullFile,STDIN_FILENO);
+    dup2(Connection,STDOUT_FILENO);
+    dup2(Connection,STDERR_FILENO);
+    close(NullFile);
+    close(Connection);
+
+    if(ValidJob == false)
+    {
+        std::cerr << "A job is one line of arguments separated by tabs, ";
+        std::cerr << "sent within " << JOB_LINE_TIMEOUT << " seconds.";
+        std::cerr << std::endl;
+        exit(1);
+    }
+
+    // Threads of the job, before its own arguments
+    if(std::find(JobArguments.begin(),JobArguments.end(),"--threads") ==
+       JobArguments.end())
+    {
+        std::ostringstream ThreadsStream;
+        ThreadsStream << NumberOfThreads;
+        JobArguments.insert(JobArguments.begin(),ThreadsStream.str());
+        JobArguments.insert(JobArguments.begin(),"--threads");
+    }
+
+    std::vector<char*> Arguments(1,ExecutableName);
+    for(unsigned int ArgumentIterator = 0;
+        ArgumentIterator < JobArguments.size();
+        ArgumentIterator++)
+    {
+        std::string &Argument = JobArguments[ArgumentIterator];
+        if(Argument == STANDARD_OUTPUT || Argument == "--serve")
+        {
+            std::cerr << "Jobs can not use the standard input or output, ";
+            std::cerr << "or --serve." << std::endl;
+            exit(1);
+        }
+        Arguments.push_back(&Argument[0]);
+    }
+    Arguments.push_back(NULL);
+
+    exit(RunCommand(Arguments.size()-1,&Arguments[0]));
+}
+
+// ==================
+// Read Job Arguments
+// ==================
+
+// Description:
+// Reads the line of a job, up to the new line, and splits it at tabs.
+// Empty arguments are skipped. Returns false if the connection is closed
+// before the new line, or if the line is not received within
+// JOB_LINE_TIMEOUT seconds.
+
+bool ReadJobArguments(
+        int Connection,
+        std::vector<std::string> &Arguments)      // Output
+{
+    std::chrono::steady_clock::time_point Deadline = \
+        std::chrono::steady_clock::now() +
+        std::chrono::seconds(JOB_LINE_TIMEOUT);
+
+    std::string Line;
+    while(true)
+    {
+        if(std::chrono::steady_clock::now() > Deadline)
+        {
+            return false;
+        }
+
+        char Character;
+        ssize_t Result = read(Connection,&Character,1);
+        if(Result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if(Result <= 0)
+        {
+            return false;
+        }
+        else if(Character == '\n')
+        {
+            break;
+        }
+        Line += Character;
+    }
+
+    if(Line.empty() == false && Line[Line.size()-1] == '\r')
+    {
+        Line.erase(Line.size()-1);
+    }
+
+    std::istringstream LineStream(Line);
+    std::string Argument;
+    while(std::getline(LineStream,Argument,'\t'))
+    {
+        if(Argument.empty() == false)
+        {
+            Arguments.push_back(Argument);
+        }
+    }
+
+    return true;
+}
+
+// ===============
+// Reader Registry
+// ===============
+
+// Description:
+// All readers are registered here. A file type may have several handlers,
+// such as a fast native reader and a general VTK reader. For each input
+// file, the first handler of its type is chosen that supports the dataset
+// type, has the capabilities that the options need, and, if it has a CanRead
+// function, accepts the scanned header of the file. Among these, a handler
+// with the capabilities that the options prefer comes first (see
+// SelectReaderHandler). New readers are added by adding an entry to this
+// table, before the handlers they should replace.
+//
+// The DataSetTypes of a handler is a space separated list of the legacy
+// DATASET keywords, or the XML VTKFile type attribute, that it can read.
+// Readers are created only inside the Read function of the chosen handler.
+
+static const ReaderHandler ReaderRegistry[] = {
+    {VTK, "VTK", "vtk", LEGACY_DATASET_TYPES,
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_EXTENT_STREAMING,
+        ScanLegacyFileHeader,
+        CanReadLegacyInputFile,
+        ReadLegacyInputFileWriteToOutputFile},
+    {VTK, "VTK", "vtk", LEGACY_DATASET_TYPES,
+        READER_HEADER_PROBE,
+        ScanLegacyFileHeader,
+        NULL,
+        ReadVTKLegacyInputFileWriteToOutputFile},
+    {VTI, "VTI", "vti", "ImageData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_EXTENT_STREAMING,
+        ScanXMLFileHeader,
+        CanReadAppendedImageData,
+        ReadAppendedImageDataWriteToOutputFile},
+    {VTI, "VTI", "vti", "ImageData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING | READER_EXTENT_STREAMING,
+        ScanXMLFileHeader,
+        NULL,
+        ReadXMLInputFileWriteToOutputFile<vtkXMLImageDataReader>},
+    {VTP, "VTP", "vtp", "PolyData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING,
+        ScanXMLFileHeader,
+        NULL,
+        ReadXMLInputFileWriteToOutputFile<vtkXMLPolyDataReader>},
+    {VTU, "VTU", "vtu", "UnstructuredGrid",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING,
+        ScanXMLFileHeader,
+        NULL,
+        ReadXMLInputFileWriteToOutputFile<vtkXMLUnstructuredGridReader>},
+    {PVTI, "PVTI", "pvti", "PImageData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING | READER_EXTENT_STREAMING,
+        ScanParallelFileHeader,
+        CanReadParallelPieces,
+        ReadParallelPiecesWriteToOutputFile},
+    {PVTI, "PVTI", "pvti", "PImageData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING | READER_EXTENT_STREAMING,
+        ScanParallelFileHeader,
+        NULL,
+        ReadXMLInputFileWriteToOutputFile<vtkXMLPImageDataReader>},
+    {PVTP, "PVTP", "pvtp", "PPolyData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING,
+        ScanParallelFileHeader,
+        CanReadParallelPieces,
+        ReadParallelPiecesWriteToOutputFile},
+    {PVTP, "PVTP", "pvtp", "PPolyData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING,
+        ScanParallelFileHeader,
+        NULL,
+        ReadXMLInputFileWriteToOutputFile<vtkXMLPPolyDataReader>},
+    {PVTU, "PVTU", "pvtu", "PUnstructuredGrid",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING,
+        ScanParallelFileHeader,
+        CanReadParallelPieces,
+        ReadParallelPiecesWriteToOutputFile},
+    {PVTU, "PVTU", "pvtu", "PUnstructuredGrid",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_PIECE_STREAMING,
+        ScanParallelFileHeader,
+        NULL,
+        ReadXMLInputFileWriteToOutputFile<vtkXMLPUnstructuredGridReader>},
+    {VTKHDF, "VTKHDF", "vtkhdf", "ImageData UnstructuredGrid PolyData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION |
+        READER_EXTENT_STREAMING,
+        ScanHDFFileHeader,
+        CanReadHDFDatasets,
+        ReadHDFDatasetsWriteToOutputFile},
+    {VTKHDF, "VTKHDF", "hdf", "ImageData UnstructuredGrid PolyData",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION,
+        ScanHDFFileHeader,
+        NULL,
+        ReadVTKHDFInputFileWriteToOutputFile},
+    {VTM, "VTM", "vtm", "vtkMultiBlockDataSet",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION,
+        ScanMultiBlockFileHeader,
+        NULL,
+        ReadMultiBlockWriteToOutputFiles},
+    {PVD, "PVD", "pvd", "Collection",
+        READER_HEADER_PROBE | READER_ARRAY_SELECTION,
+        ScanTimeSeriesFileHeader,
+        NULL,
+        ReadTimeSeriesWriteToOutputFiles}
+};
+
+static const unsigned int NumberOfReaderHandlers = \
+    sizeof(ReaderRegistry) / sizeof(ReaderHandler);
+
+// ============================
+// Read DataSet Write To Output
+// ============================
+
+void ReadDataSetWriteToOutput(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    // Determine input file type
+    FileHeader Header;
+    Header.FileType = DetectInputFileType(InputFilename,Header.DataSetType);
+
+    if(Header.FileType == NUMBER_OF_INPUT_FILE_TYPES)
+    {
+        std::cerr << "Invalid input file type." << std::endl;
+        throw ConversionError();
+    }
+
+    // Choose a reader before reading any data
+    const ReaderHandler *Handler = SelectReaderHandler(
+            InputFilename,Options,Header);
+
+    if(Handler == NULL)
+    {
+        std::cerr << "No reader can read " << GetInputFileTypeName(
+                Header.FileType) << " dataset type: ";
+        std::cerr << Header.DataSetType << "." << std::endl;
+        throw ConversionError();
+    }
+
+    // Read file
+    Handler->Read(InputFilename,OutputFilename,Header,Options);
+}
+
+// =====================
+// Select Reader Handler
+// =====================
+
+// Description:
+// Returns the first registered handler that can read the file and has the
+// capabilities that the options prefer, or else the first handler that can
+// read the file, or NULL. Probing requires a header probe. Array selection,
+// sub-volumes and a memory limit only prefer handlers that read less of the
+// file, since every handler converts them, possibly after reading it whole.
+// The header of the file is scanned only if a candidate handler needs it to
+// decide, and is then kept in the Header for the Read function.
+
+const ReaderHandler *SelectReaderHandler(
+        const char *InputFilename,
+        const ConversionOptions &Options,
+        FileHeader &Header)                   // Input/Output
+{
+    // Capabilities needed by the options
+    unsigned int RequiredCapabilities = 0;
+    if(Options.Probe == true)
+    {
+        RequiredCapabilities |= READER_HEADER_PROBE;
+    }
+
+    // Capabilities preferred by the options
+    unsigned int PreferredCapabilities = 0;
+    if(Options.ArrayNames.empty() == false)
+    {
+        PreferredCapabilities |= READER_ARRAY_SELECTION;
+    }
+    if(Options.ExtractExtent == true || Options.Stride[0] > 1 ||
+       Options.Stride[1] > 1 || Options.Stride[2] > 1)
+    {
+        PreferredCapabilities |= READER_EXTENT_STREAMING;
+    }
+
+    // Either streaming bounds the memory
+    bool PreferStreaming = (Options.MemoryLimit > 0);
+
+    bool HeaderScanned = (Header.Pieces.empty() == false);
+    const ReaderHandler *FallbackHandler = NULL;
+
+    for(unsigned int HandlerIterator = 0;
+        HandlerIterator < NumberOfReaderHandlers;
+        HandlerIterator++)
+    {
+        const ReaderHandler &Handler = ReaderRegistry[HandlerIterator];
+
+        if(Handler.FileType != Header.FileType ||
+           (Handler.Capabilities & RequiredCapabilities) != \
+               RequiredCapabilities)
+        {
+            continue;
+        }
+
+        // Data set type is not known if detected from the extension
+        if(Header.DataSetType.empty() == false &&
+           HandlerSupportsDataSetType(Handler,Header.DataSetType) == false)
+        {
+            continue;
+        }
+
+        // Let the handler inspect the header
+        if(Handler.CanRead != NULL)
+        {
+            if(HeaderScanned == false && Handler.ScanHeader != NULL)
+            {
+                std::string DataSetType = Header.DataSetType;
+                if(Handler.ScanHeader(InputFilename,Header) == false)
+                {
+                    Header = FileHeader();
+                    Header.FileType = Handler.FileType;
+                    Header.DataSetType = DataSetType;
+                    continue;
+                }
+                HeaderScanned = true;
+            }
+
+            if(HeaderScanned == false ||
+               Handler.CanRead(Header,Options) == false)
+            {
+                continue;
+            }
+        }
+
+        if((Handler.Capabilities & PreferredCapabilities) == \
+               PreferredCapabilities &&
+           (PreferStreaming == false || (Handler.Capabilities &
+               (READER_PIECE_STREAMING | READER_EXTENT_STREAMING)) != 0))
+        {
+            return &Handler;
+        }
+
+        if(FallbackHandler == NULL)
+        {
+            FallbackHandler = &Handler;
+        }
+    }
+
+    return FallbackHandler;
+}
+
+// ======================
+// Detect Input File Type
+// ======================
+
+// Description:
+// The file type is determined from the first bytes of the file: a legacy
+// file starts with "# vtk DataFile" and has a DATASET keyword, and an XML
+// file has a VTKFile element with a type attribute. The first bytes of a
+// gzip compressed file are those after decompression. Only if the content
+// is not recognized, the file extension is used, regardless of its case.
+//
+// The DataSetType output is the DATASET keyword or the XML type attribute,
+// or empty if the type was found from the extension. If no type is found,
+// NUMBER_OF_INPUT_FILE_TYPES is returned.
+
+InputFileType DetectInputFileType(
+        const char *InputFilename,
+        std::string &DataSetType)             // Output
+{
+    DataSetType.clear();
+
+    // Read the first bytes
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        return NUMBER_OF_INPUT_FILE_TYPES;
+    }
+
+    char Buffer[SNIFF_LENGTH];
+    InputFile.read(Buffer,SNIFF_LENGTH);
+    std::string Leading(Buffer,InputFile.gcount());
+    InputFile.close();
+
+    bool Compressed = IsCompressedInputFile(InputFilename);
+    InputFileType FileType = SniffInputFileType(Leading,DataSetType);
+    if(FileType == VTKHDF && ReadsFromInputString(InputFilename) == true)
+    {
+        std::cerr << "HDF5 files can not be read compressed or from the ";
+        std::cerr << "standard input: " << InputFilename << std::endl;
+        return NUMBER_OF_INPUT_FILE_TYPES;
+    }
+    else if(FileType != NUMBER_OF_INPUT_FILE_TYPES)
+    {
+        return FileType;
+    }
+
+    // Fall back to the file extension, before the .gz extension
+    std::string InputFilenameString(InputFilename);
+    std::size_t FoundLastDot = InputFilenameString.find_last_of(".");
+    if(Compressed == true && FoundLastDot != std::string::npos)
+    {
+        InputFilenameString.erase(FoundLastDot);
+        FoundLastDot = InputFilenameString.find_last_of(".");
+    }
+
+    if(FoundLastDot == std::string::npos)
+    {
+        std::cerr << "No file extension found in the Input filename.";
+        std::cerr << std::endl;
+        return NUMBER_OF_INPUT_FILE_TYPES;
+    }
+
+    std::string FileExtension = InputFilenameString.substr(FoundLastDot+1);
+    for(unsigned int HandlerIterator = 0;
+        HandlerIterator < NumberOfReaderHandlers;
+        HandlerIterator++)
+    {
+        if(strcasecmp(FileExtension.c_str(),
+                    ReaderRegistry[HandlerIterator].Extension) == 0)
+        {
+            return ReaderRegistry[HandlerIterator].FileType;
+        }
+    }
+
+    std::cerr << "No valid input file extension found." << std::endl;
+    return NUMBER_OF_INPUT_FILE_TYPES;
+}
+
+// =====================
+// Sniff Input File Type
+// =====================
+
+// Description:
+// Finds the file type from the leading bytes of a file.
+
+InputFileType SniffInputFileType(
+        const std::string &Leading,
+        std::string &DataSetType)             // Output
+{
+    // Legacy file
+    if(Leading.compare(0,14,"# vtk DataFile") == 0)
+    {
+        std::string UpperCaseLeading = ToUpperCase(Leading);
+        std::size_t Position = UpperCaseLeading.find("\nDATASET");
+        if(Position != std::string::npos)
+        {
+            std::istringstream DataSetStream(
+                    UpperCaseLeading.substr(Position+9,CHAR_LENGTH));
+            DataSetStream >> DataSetType;
+        }
+
+        return VTK;
+    }
+
+    // HDF5 file, whose dataset type is an attribute of its VTKHDF group
+    if(Leading.compare(0,8,HDF_SIGNATURE) == 0)
+    {
+        return VTKHDF;
+    }
+
+    // XML file
+    std::size_t Position = Leading.find("<VTKFile");
+    if(Position == std::string::npos)
+    {
+        return NUMBER_OF_INPUT_FILE_TYPES;
+    }
+
+    std::size_t TypePosition = Leading.find(" type=",Position);
+    std::size_t TagEnd = Leading.find('>',Position);
+    if(TypePosition == std::string::npos ||
+       (TagEnd != std::string::npos && TypePosition > TagEnd) ||
+       TypePosition + 7 >= Leading.size())
+    {
+        return NUMBER_OF_INPUT_FILE_TYPES;
+    }
+
+    std::size_t ValueStart = TypePosition + 7;
+    std::size_t ValueEnd = Leading.find(Leading[TypePosition+6],ValueStart);
+    if(ValueEnd == std::string::npos)
+    {
+        return NUMBER_OF_INPUT_FILE_TYPES;
+    }
+    DataSetType = Leading.substr(ValueStart,ValueEnd-ValueStart);
+
+    for(unsigned int HandlerIterator = 0;
+        HandlerIterator < NumberOfReaderHandlers;
+        HandlerIterator++)
+    {
+        if(ReaderRegistry[HandlerIterator].FileType != VTK &&
+           HandlerSupportsDataSetType(ReaderRegistry[HandlerIterator],
+               DataSetType) == true)
+        {
+            return ReaderRegistry[HandlerIterator].FileType;
+        }
+    }
+
+    std::cerr << "Unsupported XML file type: " << DataSetType << std::endl;
+    return NUMBER_OF_INPUT_FILE_TYPES;
+}
+
+// =============================
+// Handler Supports DataSet Type
+// =============================
+
+bool HandlerSupportsDataSetType(
+        const ReaderHandler &Handler,
+        const std::string &DataSetType)
+{
+    std::istringstream DataSetTypesStream(Handler.DataSetTypes);
+    std::string SupportedDataSetType;
+    while(DataSetTypesStream >> SupportedDataSetType)
+    {
+        if(SupportedDataSetType == DataSetType)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ========================
+// Is Compressed Input File
+// ========================
+
+// Description:
+// True if the file starts with the gzip signature. Such files are read
+// through a DecompressionStreamBuffer by the native readers, and are
+// decompressed into memory for the VTK readers. The standard input is
+// already decompressed when it is read.
+
+bool IsCompressedInputFile(const char *InputFilename)
+{
+    if(strcmp(InputFilename,STANDARD_INPUT) == 0)
+    {
+        return false;
+    }
+
+    std::ifstream InputFile(InputFilename,std::ios::in | std::ios::binary);
+    char Signature[2] = {0,0};
+    InputFile.read(Signature,2);
+
+    return InputFile.gcount() == 2 &&
+           std::string(Signature,2) == GZIP_SIGNATURE;
+}
+
+// =======================
+// Reads From Input String
+// =======================
+
+// Description:
+// True if the VTK readers can not open the file by its name, and read its
+// content from an input string instead: compressed files, and the standard
+// input.
+
+bool ReadsFromInputString(const char *InputFilename)
+{
+    return strcmp(InputFilename,STANDARD_INPUT) == 0 ||
+           IsCompressedInputFile(InputFilename) == true;
+}
+
+// =======================
+// Read Input File Content
+// =======================
+
+// Description:
+// Reads the whole decompressed content of a file, for the VTK readers that
+// read from an input string.
+
+bool ReadInputFileContent(
+        const char *InputFilename,
+        std::string &Content)                 // Output
+{
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() == false)
+    {
+        return false;
+    }
+
+    std::ostringstream ContentStream;
+    ContentStream << InputFile.rdbuf();
+    Content = ContentStream.str();
+
+    return true;
+}
+
+// ===========================
+// Decompression Stream Buffer
+// ===========================
+
+// Description:
+// A gzip file is decompressed by zlib on a background thread, in blocks of
+// DECOMPRESSION_BLOCK_SIZE bytes, into a queue of at most
+// DECOMPRESSION_QUEUE_LENGTH blocks. The reader takes the blocks from the
+// queue while the next blocks are decompressed, so that reading the file,
+// decompressing it and parsing its data overlap, and the memory is bounded
+// by the queue. No decompressed file is written.
+//
+// The stream is read forward, as the readers read a file. A seek forward
+// skips the blocks up to the position, and a short seek backward, such as
+// to the start of a line, moves within the last DECOMPRESSION_KEEP_SIZE
+// bytes that are kept of the previous block. A seek further back, such as
+// from the last array of a slab to the first array of the next slab,
+// restarts the decompression from the last checkpoint before the position,
+// and so does a seek forward past a checkpoint. A checkpoint is a copy of
+// the inflate state, with its window of 32 KB, which is kept every
+// DECOMPRESSION_CHECKPOINT_SIZE uncompressed bytes, so that a seek to data
+// that was decompressed before decompresses at most that many bytes again.
+
+DecompressionStreamBuffer::DecompressionStreamBuffer():
+    File(NULL),
+    Stop(false),
+    Finished(false),
+    Failed(false),
+    BufferStart(0),
+    DecompressionStart(0)
+{
+    memset(&Stream,0,sizeof(Stream));
+}
+
+DecompressionStreamBuffer::~DecompressionStreamBuffer()
+{
+    Close();
+}
+
+// ====
+// Open
+// ====
+
+bool DecompressionStreamBuffer::Open(const char *InputFilename)
+{
+    FILE *InputFile = fopen(InputFilename,"rb");
+    if(InputFile == NULL)
+    {
+        return false;
+    }
+
+    return Open(InputFile,InputFilename);
+}
+
+// Description:
+// Takes the ownership of an open file, which should be seekable.
+
+bool DecompressionStreamBuffer::Open(
+        FILE *InputFile,
+        const char *InputFilename)
+{
+    Close();
+    File = InputFile;
+
+    // Gzip or zlib header, and concatenated gzip members
+    memset(&Stream,0,sizeof(Stream));
+    if(inflateInit2(&Stream,MAX_WBITS + 32) != Z_OK)
+    {
+        fclose(File);
+        File = NULL;
+        return false;
+    }
+
+    Filename = InputFilename;
+    StartDecompression(NULL);
+
+    return true;
+}
+
+// =======
+// Is Open
+// =======
+
+bool DecompressionStreamBuffer::IsOpen() const
+{
+    return File != NULL;
+}
+
+// =====
+// Close
+// =====
+
+void DecompressionStreamBuffer::Close()
+{
+    if(File == NULL)
+    {
+        return;
+    }
+
+    StopDecompression();
+    ClearCheckpoints();
+    inflateEnd(&Stream);
+    fclose(File);
+    File = NULL;
+}
+
+// =========
+// Underflow
+// =========
+
+DecompressionStreamBuffer::int_type DecompressionStreamBuffer::underflow()
+{
+    if(gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    if(ReadNextBlock() == false)
+    {
+        return traits_type::eof();
+    }
+
+    return traits_type::to_int_type(*gptr());
+}
+
+// ========
+// Seek Off
+// ========
+
+DecompressionStreamBuffer::pos_type DecompressionStreamBuffer::seekoff(
+        off_type Offset,
+        std::ios_base::seekdir Direction,
+        std::ios_base::openmode Mode)
+{
+    if(Direction == std::ios_base::beg)
+    {
+        return seekpos(pos_type(Offset),Mode);
+    }
+    else if(Direction == std::ios_base::cur)
+    {
+        long long Position = BufferStart + (gptr() - eback());
+        if(Offset == 0)
+        {
+            return pos_type(Position);
+        }
+        return seekpos(pos_type(Position + Offset),Mode);
+    }
+
+    // The end of the stream is not known before it is decompressed
+    return pos_type(off_type(-1));
+}
+
+// ========
+// Seek Pos
+// ========
+
+DecompressionStreamBuffer::pos_type DecompressionStreamBuffer::seekpos(
+        pos_type Position,
+        std::ios_base::openmode Mode)
+{
+    long long Target = static_cast<long long>(off_type(Position));
+    if(Target < 0 || (Mode & std::ios_base::in) == 0 || File == NULL)
+    {
+        return pos_type(off_type(-1));
+    }
+
+    // Last checkpoint before the position
+    DecompressionCheckpoint *Checkpoint = NULL;
+    for(unsigned int CheckpointIterator = 0;
+        CheckpointIterator < Checkpoints.size() &&
+        Checkpoints[CheckpointIterator].Position <= Target;
+        CheckpointIterator++)
+    {
+        Checkpoint = &Checkpoints[CheckpointIterator];
+    }
+
+    // Restart from the checkpoint, or from the start of the file, if the
+    // position is behind the buffer, or if the checkpoint is ahead of it
+    long long BufferEnd = BufferStart + static_cast<long long>(Buffer.size());
+    if(Target < BufferStart ||
+       (Checkpoint != NULL && Checkpoint->Position > BufferEnd))
+    {
+        StopDecompression();
+
+        inflateEnd(&Stream);
+        if(Checkpoint != NULL &&
+           inflateCopy(&Stream,&Checkpoint->Stream) == Z_OK)
+        {
+            fseeko(File,Checkpoint->FileOffset,SEEK_SET);
+        }
+        else
+        {
+            Checkpoint = NULL;
+            memset(&Stream,0,sizeof(Stream));
+            if(inflateInit2(&Stream,MAX_WBITS + 32) != Z_OK)
+            {
+                return pos_type(off_type(-1));
+            }
+            fseeko(File,0,SEEK_SET);
+        }
+
+        StartDecompression(Checkpoint);
+    }
+
+    // Skip blocks up to the position
+    while(Target > BufferStart + static_cast<long long>(Buffer.size()))
+    {
+        if(ReadNextBlock() == false)
+        {
+            return pos_type(off_type(-1));
+        }
+    }
+
+    char *Begin = Buffer.empty() == true ? NULL : &Buffer[0];
+    setg(Begin,Begin + (Target - BufferStart),Begin + Buffer.size());
+
+    return Position;
+}
+
+// ===================
+// Start Decompression
+// ===================
+
+// Description:
+// Starts the thread from the start of the file, or from a checkpoint, to
+// which the inflate state and the file are already restored.
+
+void DecompressionStreamBuffer::StartDecompression(
+        const DecompressionCheckpoint *Checkpoint)
+{
+    Queue.clear();
+    Buffer.clear();
+    BufferStart = Checkpoint != NULL ? Checkpoint->Position : 0;
+    DecompressionStart = BufferStart;
+    setg(NULL,NULL,NULL);
+    Stop = false;
+    Finished = false;
+    Failed = false;
+
+    DecompressionThread = std::thread(
+            &DecompressionStreamBuffer::Decompress,this);
+}
+
+// ==================
+// Stop Decompression
+// ==================
+
+void DecompressionStreamBuffer::StopDecompression()
+{
+    {
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        Stop = true;
+    }
+    QueueCondition.notify_all();
+
+    if(DecompressionThread.joinable() == true)
+    {
+        DecompressionThread.join();
+    }
+}
+
+// ==========
+// Decompress
+// ==========
+
+// Description:
+// Runs on the decompression thread until the end of the file, or until it
+// is stopped.
+
+void DecompressionStreamBuffer::Decompress()
+{
+    std::vector<unsigned char> Input(DECOMPRESSION_BLOCK_SIZE);
+    std::vector<char> Block(DECOMPRESSION_BLOCK_SIZE);
+    std::size_t BlockSize = 0;
+    long long Position = DecompressionStart;
+    bool Error = false;
+    bool EndOfMember = false;
+
+    Stream.avail_in = 0;
+    while(Error == false)
+    {
+        // Compressed data
+        if(Stream.avail_in == 0)
+        {
+            std::size_t InputSize = fread(&Input[0],1,Input.size(),File);
+            if(InputSize == 0)
+            {
+                // A truncated member is an error
+                Error = (ferror(File) != 0 || EndOfMember == false);
+                break;
+            }
+            Stream.next_in = &Input[0];
+            Stream.avail_in = InputSize;
+        }
+
+        // Next member of a multi-member file
+        if(EndOfMember == true)
+        {
+            inflateReset(&Stream);
+            EndOfMember = false;
+        }
+
+        Stream.next_out = reinterpret_cast<Bytef*>(&Block[BlockSize]);
+        Stream.avail_out = Block.size() - BlockSize;
+        int Status = inflate(&Stream,Z_NO_FLUSH);
+        BlockSize = Block.size() - Stream.avail_out;
+
+        if(Status == Z_STREAM_END)
+        {
+            EndOfMember = true;
+        }
+        else if(Status != Z_OK && Status != Z_BUF_ERROR)
+        {
+            Error = true;
+        }
+
+        if(BlockSize == Block.size())
+        {
+            Position += BlockSize;
+            if(EndOfMember == false)
+            {
+                AddCheckpoint(Position);
+            }
+
+            if(PushBlock(Block) == false)
+            {
+                return;
+            }
+            Block.assign(DECOMPRESSION_BLOCK_SIZE,0);
+            BlockSize = 0;
+        }
+    }
+
+    // Last block
+    Block.resize(BlockSize);
+    if(Block.empty() == false && PushBlock(Block) == false)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        Finished = true;
+        Failed = Error;
+    }
+    QueueCondition.notify_all();
+}
+
+// ==============
+// Add Checkpoint
+// ==============
+
+// Description:
+// Keeps a copy of the inflate state at the uncompressed Position, if it is
+// DECOMPRESSION_CHECKPOINT_SIZE bytes past the last checkpoint. Runs on the
+// decompression thread, after all input before the state is read.
+
+void DecompressionStreamBuffer::AddCheckpoint(long long Position)
+{
+    long long LastPosition = Checkpoints.empty() == true ?
+        0 : Checkpoints.back().Position;
+    long long FileOffset = ftello(File);
+    if(Position < LastPosition + DECOMPRESSION_CHECKPOINT_SIZE ||
+       FileOffset < 0)
+    {
+        return;
+    }
+
+    Checkpoints.push_back(DecompressionCheckpoint());
+    DecompressionCheckpoint &Checkpoint = Checkpoints.back();
+    Checkpoint.Position = Position;
+    Checkpoint.FileOffset = FileOffset - Stream.avail_in;
+    if(inflateCopy(&Checkpoint.Stream,&Stream) != Z_OK)
+    {
+        Checkpoints.pop_back();
+    }
+}
+
+// =================
+// Clear Checkpoints
+// =================
+
+void DecompressionStreamBuffer::ClearCheckpoints()
+{
+    for(unsigned int CheckpointIterator = 0;
+        CheckpointIterator < Checkpoints.size();
+        CheckpointIterator++)
+    {
+        inflateEnd(&Checkpoints[CheckpointIterator].Stream);
+    }
+    Checkpoints.clear();
+}
+
+// ==========
+// Push Block
+// ==========
+
+// Description:
+// Waits for room in the queue. Returns false if the decompression is
+// stopped.
+
+bool DecompressionStreamBuffer::PushBlock(std::vector<char> &Block)
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    while(Stop == false && Queue.size() >= DECOMPRESSION_QUEUE_LENGTH)
+    {
+        QueueCondition.wait(Lock);
+    }
+
+    if(Stop == true)
+    {
+        return false;
+    }
+
+    Queue.push_back(std::vector<char>());
+    Queue.back().swap(Block);
+    Lock.unlock();
+    QueueCondition.notify_all();
+
+    return true;
+}
+
+// ===============
+// Read Next Block
+// ===============
+
+// Description:
+// Waits for the next decompressed block and makes it the buffer of the
+// reader, after the end of the current block. Returns false at the end of
+// the file. A corrupt file is an error.
+
+bool DecompressionStreamBuffer::ReadNextBlock()
+{
+    std::vector<char> Block;
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        while(Queue.empty() == true && Finished == false)
+        {
+            QueueCondition.wait(Lock);
+        }
+
+        if(Queue.empty() == true)
+        {
+            if(Failed == true)
+            {
+                std::cerr << "Can not decompress input file: " << Filename;
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+            return false;
+        }
+
+        Block.swap(Queue.front());
+        Queue.pop_front();
+    }
+    QueueCondition.notify_all();
+
+    // Keep the end of the current block
+    std::size_t KeepSize = std::min(Buffer.size(),
+            static_cast<std::size_t>(DECOMPRESSION_KEEP_SIZE));
+    long long Position = BufferStart + (gptr() - eback());
+    BufferStart += Buffer.size() - KeepSize;
+    Buffer.erase(Buffer.begin(),Buffer.end() - KeepSize);
+    Buffer.insert(Buffer.end(),Block.begin(),Block.end());
+
+    char *Begin = &Buffer[0];
+    setg(Begin,Begin + std::max(Position - BufferStart,0LL),
+            Begin + Buffer.size());
+
+    return true;
+}
+
+// ====================
+// Memory Stream Buffer
+// ====================
+
+// Description:
+// Reads data that is held in memory, without copying it.
+
+MemoryStreamBuffer::MemoryStreamBuffer():
+    Opened(false)
+{
+}
+
+// ====
+// Open
+// ====
+
+void MemoryStreamBuffer::Open(const std::string &Content)
+{
+    char *Begin = const_cast<char*>(Content.data());
+    setg(Begin,Begin,Begin + Content.size());
+    Opened = true;
+}
+
+// =======
+// Is Open
+// =======
+
+bool MemoryStreamBuffer::IsOpen() const
+{
+    return Opened;
+}
+
+// =====
+// Close
+// =====
+
+void MemoryStreamBuffer::Close()
+{
+    setg(NULL,NULL,NULL);
+    Opened = false;
+}
+
+// ========
+// Seek Off
+// ========
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(
+        off_type Offset,
+        std::ios_base::seekdir Direction,
+        std::ios_base::openmode Mode)
+{
+    off_type Position = Offset;
+    if(Direction == std::ios_base::cur)
+    {
+        Position += gptr() - eback();
+    }
+    else if(Direction == std::ios_base::end)
+    {
+        Position += egptr() - eback();
+    }
+
+    return seekpos(pos_type(Position),Mode);
+}
+
+// ========
+// Seek Pos
+// ========
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(
+        pos_type Position,
+        std::ios_base::openmode Mode)
+{
+    off_type Offset = off_type(Position);
+    if(Offset < 0 || Offset > egptr() - eback() ||
+       (Mode & std::ios_base::in) == 0)
+    {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(),eback() + Offset,egptr());
+    return Position;
+}
+
+// ==================
+// Get Standard Input
+// ==================
+
+// Description:
+// The content of the standard input, which is read once, as a whole, the
+// first time it is asked for. The file type, the header and the data of
+// the input are then all read from memory, since a pipe can only be read
+// once. Gzip compressed input is decompressed while it is read.
+
+const std::string &GetStandardInput()
+{
+    static std::string Content;
+    static bool ContentRead = false;
+    if(ContentRead == true)
+    {
+        return Content;
+    }
+    ContentRead = true;
+
+    // Read the input in blocks
+    std::vector<char> Block(BUFFER_SIZE);
+    std::size_t BlockSize = 0;
+    while((BlockSize = fread(&Block[0],1,Block.size(),stdin)) > 0)
+    {
+        Content.append(&Block[0],BlockSize);
+    }
+
+    if(ferror(stdin) != 0)
+    {
+        std::cerr << "Can not read the standard input." << std::endl;
+        throw ConversionError();
+    }
+
+    if(Content.compare(0,4,ZSTD_SIGNATURE) == 0)
+    {
+        std::cerr << "Zstandard compressed input is not supported.";
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // Decompress gzip data from memory
+    if(Content.compare(0,2,GZIP_SIGNATURE) == 0)
+    {
+        std::string Compressed;
+        Compressed.swap(Content);
+
+        FILE *CompressedFile = fmemopen(&Compressed[0],Compressed.size(),
+                "rb");
+        DecompressionStreamBuffer Decompression;
+        if(CompressedFile == NULL ||
+           Decompression.Open(CompressedFile,"standard input") == false)
+        {
+            std::cerr << "Can not decompress the standard input.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        std::ostringstream ContentStream;
+        ContentStream << &Decompression;
+        Content = ContentStream.str();
+    }
+
+    return Content;
+}
+
+// =================
+// Input File Stream
+// =================
+
+// Description:
+// Opens a file with a file buffer, or with a decompression buffer if it is
+// gzip compressed. The file "-" is the standard input, which is read from
+// memory. Zstandard files are detected, but can not be read, since VTK has
+// no zstd library. They can be decompressed to the standard input instead.
+
+InputFileStream::InputFileStream(const char *InputFilename):
+    std::istream(NULL)
+{
+    if(strcmp(InputFilename,STANDARD_INPUT) == 0)
+    {
+        Memory.Open(GetStandardInput());
+        rdbuf(&Memory);
+        return;
+    }
+
+    std::ifstream SignatureFile(InputFilename,
+            std::ios::in | std::ios::binary);
+    char Signature[4] = {0,0,0,0};
+    SignatureFile.read(Signature,4);
+    std::string Leading(Signature,SignatureFile.gcount());
+    SignatureFile.close();
+
+    if(Leading.compare(0,4,ZSTD_SIGNATURE) == 0)
+    {
+        std::cerr << "Zstandard compressed files are not supported: ";
+        std::cerr << InputFilename << ". Decompress them to the standard ";
+        std::cerr << "input instead, such as with: zstdcat ";
+        std::cerr << InputFilename << " | vtk2raw - OutputFileName.raw";
+        std::cerr << std::endl;
+        setstate(std::ios::failbit);
+    }
+    else if(Leading.compare(0,2,GZIP_SIGNATURE) == 0)
+    {
+        Decompression.Open(InputFilename);
+        rdbuf(&Decompression);
+    }
+    else
+    {
+        FileBuffer.open(InputFilename,std::ios::in | std::ios::binary);
+        rdbuf(&FileBuffer);
+    }
+
+    if(is_open() == false)
+    {
+        setstate(std::ios::failbit);
+    }
+}
+
+// =======
+// Is Open
+// =======
+
+bool InputFileStream::is_open() const
+{
+    return FileBuffer.is_open() == true || Decompression.IsOpen() == true ||
+           Memory.IsOpen() == true;
+}
+
+// =====
+// Close
+// =====
+
+void InputFileStream::close()
+{
+    FileBuffer.close();
+    Decompression.Close();
+    Memory.Close();
+}
+
+// ===========================
+// Shared Memory Stream Buffer
+// ===========================
+
+// Description:
+// Maps a shared memory segment that was created by CreateSharedMemory, and
+// exposes its matrix as the put area. Writes are copies into the segment,
+// without system calls, and Reserve lets a writer convert rows directly
+// into the segment. Each thread that writes pieces opens its own buffer,
+// with its own position, on the same segment.
+
+SharedMemoryStreamBuffer::SharedMemoryStreamBuffer():
+    Segment(NULL),
+    SegmentSize(0),
+    Data(NULL),
+    DataSize(0)
+{
+}
+
+// ==========
+// Destructor
+// ==========
+
+SharedMemoryStreamBuffer::~SharedMemoryStreamBuffer()
+{
+    Close();
+}
+
+// ====
+// Open
+// ====
+
+bool SharedMemoryStreamBuffer::Open(const char *Name)
+{
+    Close();
+
+    int FileDescriptor = shm_open(Name,O_RDWR,0);
+    if(FileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat Status;
+    if(fstat(FileDescriptor,&Status) != 0 ||
+       static_cast<unsigned long long>(Status.st_size) < \
+           sizeof(SharedMemoryHeader))
+    {
+        close(FileDescriptor);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void *Mapping = mmap(NULL,Status.st_size,PROT_READ | PROT_WRITE,
+            MAP_SHARED,FileDescriptor,0);
+    close(FileDescriptor);
+    if(Mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    Segment = static_cast<char*>(Mapping);
+    SegmentSize = Status.st_size;
+
+    const SharedMemoryHeader *Header = \
+        reinterpret_cast<const SharedMemoryHeader*>(Segment);
+    if(Header->DataOffset > SegmentSize)
+    {
+        Close();
+        return false;
+    }
+
+    Data = Segment + Header->DataOffset;
+    DataSize = SegmentSize - Header->DataOffset;
+    SetPutPosition(0);
+
+    return true;
+}
+
+// =======
+// Is Open
+// =======
+
+bool SharedMemoryStreamBuffer::IsOpen() const
+{
+    return Segment != NULL;
+}
+
+// =====
+// Close
+// =====
+
+void SharedMemoryStreamBuffer::Close()
+{
+    if(Segment != NULL)
+    {
+        munmap(Segment,SegmentSize);
+    }
+
+    Segment = NULL;
+    SegmentSize = 0;
+    Data = NULL;
+    DataSize = 0;
+    setp(NULL,NULL);
+}
+
+// =======
+// Reserve
+// =======
+
+// Description:
+// Returns the memory of the next Size bytes of the matrix, and moves the
+// position after them, or returns NULL if they are beyond the matrix.
+
+char *SharedMemoryStreamBuffer::Reserve(unsigned long long Size)
+{
+    unsigned long long Position = pptr() - Data;
+    if(Data == NULL || Size > DataSize - Position)
+    {
+        return NULL;
+    }
+
+    SetPutPosition(Position + Size);
+    return Data + Position;
+}
+
+// ========
+// Seek Off
+// ========
+
+SharedMemoryStreamBuffer::pos_type SharedMemoryStreamBuffer::seekoff(
+        off_type Offset,
+        std::ios_base::seekdir Direction,
+        std::ios_base::openmode Mode)
+{
+    off_type Position = Offset;
+    if(Direction == std::ios_base::cur)
+    {
+        Position += pptr() - Data;
+    }
+    else if(Direction == std::ios_base::end)
+    {
+        Position += DataSize;
+    }
+
+    return seekpos(pos_type(Position),Mode);
+}
+
+// ========
+// Seek Pos
+// ========
+
+SharedMemoryStreamBuffer::pos_type SharedMemoryStreamBuffer::seekpos(
+        pos_type Position,
+        std::ios_base::openmode Mode)
+{
+    off_type Offset = off_type(Position);
+    if(Data == NULL || Offset < 0 ||
+       static_cast<unsigned long long>(Offset) > DataSize ||
+       (Mode & std::ios_base::out) == 0)
+    {
+        return pos_type(off_type(-1));
+    }
+
+    SetPutPosition(Offset);
+    return Position;
+}
+
+// ================
+// Set Put Position
+// ================
+
+// Description:
+// pbump only moves by an int, so large positions are reached in steps.
+
+void SharedMemoryStreamBuffer::SetPutPosition(unsigned long long Position)
+{
+    setp(Data,Data + DataSize);
+    while(Position > 0)
+    {
+        int Step = static_cast<int>(std::min<unsigned long long>(
+                Position,std::numeric_limits<int>::max()));
+        pbump(Step);
+        Position -= Step;
+    }
+}
+
+// =========================
+// File Region Stream Buffer
+// =========================
+
+// Description:
+// Writes a region of a file that exists, with pwrite at the offset of the
+// region, so that threads that each open their own buffer on the same file
+// write their regions concurrently, without a shared file position. Small
+// writes are collected in a buffer, which never extends past the end of the
+// region, such that a write past the end fails when it is made.
+//
+// The region may also span several shard files, each with ShardSize bytes
+// of the region from its start, in which case a write is split at the end
+// of each shard.
+
+FileRegionStreamBuffer::FileRegionStreamBuffer():
+    RegionOffset(0),
+    RegionSize(0),
+    ShardSize(0),
+    Position(0),
+    Seeked(false)
+{
+}
+
+// ==========
+// Destructor
+// ==========
+
+FileRegionStreamBuffer::~FileRegionStreamBuffer()
+{
+    Close();
+}
+
+// ====
+// Open
+// ====
+
+bool FileRegionStreamBuffer::Open(
+        const char *Filename,
+        unsigned long long Offset,
+        unsigned long long Size)
+{
+    Close();
+
+    int FileDescriptor = open(Filename,O_WRONLY);
+    if(FileDescriptor < 0)
+    {
+        return false;
+    }
+
+    FileDescriptors.push_back(FileDescriptor);
+    RegionOffset = Offset;
+    RegionSize = Size;
+    ShardSize = Size;
+    Position = 0;
+    Seeked = false;
+    Buffer.resize(std::min(BUFFER_SIZE,std::max(1ULL,Size)));
+    ResetPutArea();
+
+    return true;
+}
+
+// Description:
+// Opens shard files that exist, whose first ShardSize bytes are the region
+// of Size bytes in order.
+
+bool FileRegionStreamBuffer::Open(
+        const std::vector<std::string> &Filenames,
+        unsigned long long ShardSize,
+        unsigned long long Size)
+{
+    Close();
+
+    if(Filenames.empty() == true || ShardSize == 0 ||
+       Size > ShardSize * Filenames.size())
+    {
+        return false;
+    }
+
+    for(unsigned int ShardIterator = 0;
+        ShardIterator < Filenames.size();
+        ShardIterator++)
+    {
+        int FileDescriptor = open(Filenames[ShardIterator].c_str(),O_WRONLY);
+        if(FileDescriptor < 0)
+        {
+            Close();
+            return false;
+        }
+        FileDescriptors.push_back(FileDescriptor);
+    }
+
+    RegionOffset = 0;
+    RegionSize = Size;
+    this->ShardSize = ShardSize;
+    Position = 0;
+    Seeked = false;
+    Buffer.resize(std::min(BUFFER_SIZE,std::max(1ULL,Size)));
+    ResetPutArea();
+
+    return true;
+}
+
+// =======
+// Is Open
+// =======
+
+bool FileRegionStreamBuffer::IsOpen() const
+{
+    return FileDescriptors.empty() == false;
+}
+
+// =======
+// Is Full
+// =======
+
+// Description:
+// Whether the bytes up to the end of the region have been written, with
+// those that are still in the buffer. A region that has been seeked is
+// written out of order by several writers, which each write only their
+// part of it, and is taken as full.
+
+bool FileRegionStreamBuffer::IsFull() const
+{
+    return Seeked == true ||
+           Position + (pptr() - pbase()) == RegionSize;
+}
+
+// =====
+// Close
+// =====
+
+// Description:
+// Writes the buffer, and returns false if it could not be written.
+
+bool FileRegionStreamBuffer::Close()
+{
+    bool Status = true;
+    if(FileDescriptors.empty() == false)
+    {
+        Status = Flush();
+    }
+
+    for(unsigned int ShardIterator = 0;
+        ShardIterator < FileDescriptors.size();
+        ShardIterator++)
+    {
+        close(FileDescriptors[ShardIterator]);
+    }
+
+    FileDescriptors.clear();
+    RegionOffset = 0;
+    RegionSize = 0;
+    ShardSize = 0;
+    Position = 0;
+    Seeked = false;
+    setp(NULL,NULL);
+
+    return Status;
+}
+
+// ========
+// Overflow
+// ========
+
+FileRegionStreamBuffer::int_type FileRegionStreamBuffer::overflow(
+        int_type Character)
+{
+    if(Flush() == false)
+    {
+        return traits_type::eof();
+    }
+
+    if(traits_type::eq_int_type(Character,traits_type::eof()) == false)
+    {
+        if(pptr() == epptr())
+        {
+            return traits_type::eof();
+        }
+        *pptr() = traits_type::to_char_type(Character);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(Character);
+}
+
+// ========
+// Xs Put N
+// ========
+
+// Description:
+// Blocks of at least the size of the buffer are written directly.
+
+std::streamsize FileRegionStreamBuffer::xsputn(
+        const char *Characters,
+        std::streamsize Count)
+{
+    if(static_cast<unsigned long long>(Count) < Buffer.size())
+    {
+        return std::streambuf::xsputn(Characters,Count);
+    }
+
+    if(Flush() == false || WriteAt(Characters,Count) == false)
+    {
+        return 0;
+    }
+
+    Position += Count;
+    ResetPutArea();
+
+    return Count;
+}
+
+// ====
+// Sync
+// ====
+
+int FileRegionStreamBuffer::sync()
+{
+    return Flush() == true ? 0 : -1;
+}
+
+// ========
+// Seek Off
+// ========
+
+FileRegionStreamBuffer::pos_type FileRegionStreamBuffer::seekoff(
+        off_type Offset,
+        std::ios_base::seekdir Direction,
+        std::ios_base::openmode Mode)
+{
+    off_type RegionPosition = Offset;
+    if(Direction == std::ios_base::cur)
+    {
+        RegionPosition += Position + (pptr() - pbase());
+    }
+    else if(Direction == std::ios_base::end)
+    {
+        RegionPosition += RegionSize;
+    }
+
+    return seekpos(pos_type(RegionPosition),Mode);
+}
+
+// ========
+// Seek Pos
+// ========
+
+FileRegionStreamBuffer::pos_type FileRegionStreamBuffer::seekpos(
+        pos_type RegionPosition,
+        std::ios_base::openmode Mode)
+{
+    off_type Offset = off_type(RegionPosition);
+    if(FileDescriptors.empty() == true || Offset < 0 ||
+       static_cast<unsigned long long>(Offset) > RegionSize ||
+       (Mode & std::ios_base::out) == 0 ||
+       Flush() == false)
+    {
+        return pos_type(off_type(-1));
+    }
+
+    Position = Offset;
+    Seeked = true;
+    ResetPutArea();
+
+    return RegionPosition;
+}
+
+// =====
+// Flush
+// =====
+
+// Description:
+// Writes the bytes of the buffer at the position of the put area, and
+// moves the put area after them.
+
+bool FileRegionStreamBuffer::Flush()
+{
+    unsigned long long Count = pptr() - pbase();
+    if(Count == 0)
+    {
+        return true;
+    }
+
+    if(WriteAt(pbase(),Count) == false)
+    {
+        return false;
+    }
+
+    Position += Count;
+    ResetPutArea();
+
+    return true;
+}
+
+// ========
+// Write At
+// ========
+
+// Description:
+// Writes bytes at the current position in the region, in several writes
+// if a write is interrupted or partial, or crosses the end of a shard.
+
+bool FileRegionStreamBuffer::WriteAt(
+        const char *Bytes,
+        unsigned long long Count)
+{
+    if(FileDescriptors.empty() == true || Count > RegionSize - Position)
+    {
+        return false;
+    }
+
+    unsigned long long Written = 0;
+    while(Written < Count)
+    {
+        unsigned long long Shard = (Position + Written) / ShardSize;
+        unsigned long long ShardPosition = (Position + Written) % ShardSize;
+        unsigned long long ShardCount = std::min(Count - Written,
+                ShardSize - ShardPosition);
+        ssize_t Result = pwrite(FileDescriptors[Shard],Bytes + Written,
+                ShardCount,RegionOffset + ShardPosition);
+        if(Result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if(Result <= 0)
+        {
+            return false;
+        }
+
+        Written += Result;
+    }
+
+    return true;
+}
+
+// ==============
+// Reset Put Area
+// ==============
+
+// Description:
+// The put area is the buffer, cut at the end of the region.
+
+void FileRegionStreamBuffer::ResetPutArea()
+{
+    unsigned long long Size = std::min<unsigned long long>(
+            Buffer.size(),RegionSize - Position);
+    setp(&Buffer[0],&Buffer[0] + Size);
+}
+
+// =============================
+// Standard Output Stream Buffer
+// =============================
+
+// Description:
+// Writes the standard output through its file descriptor, which is not
+// closed. Small writes are collected in a buffer, and blocks of at least
+// its size are written directly. The standard output can not be seeked.
+
+StandardOutputStreamBuffer::StandardOutputStreamBuffer():
+    Opened(false)
+{
+}
+
+// ==========
+// Destructor
+// ==========
+
+StandardOutputStreamBuffer::~StandardOutputStreamBuffer()
+{
+    Close();
+}
+
+// ====
+// Open
+// ====
+
+void StandardOutputStreamBuffer::Open()
+{
+    Close();
+
+    Opened = true;
+    Buffer.resize(BUFFER_SIZE);
+    setp(&Buffer[0],&Buffer[0] + Buffer.size());
+}
+
+// =======
+// Is Open
+// =======
+
+bool StandardOutputStreamBuffer::IsOpen() const
+{
+    return Opened;
+}
+
+// =====
+// Close
+// =====
+
+// Description:
+// Writes the buffer, and returns false if it could not be written.
+
+bool StandardOutputStreamBuffer::Close()
+{
+    bool Status = true;
+    if(Opened == true)
+    {
+        Status = Flush();
+    }
+
+    Opened = false;
+    setp(NULL,NULL);
+
+    return Status;
+}
+
+// ========
+// Overflow
+// ========
+
+StandardOutputStreamBuffer::int_type StandardOutputStreamBuffer::overflow(
+        int_type Character)
+{
+    if(Opened == false || Flush() == false)
+    {
+        return traits_type::eof();
+    }
+
+    if(traits_type::eq_int_type(Character,traits_type::eof()) == false)
+    {
+        *pptr() = traits_type::to_char_type(Character);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(Character);
+}
+
+// ========
+// Xs Put N
+// ========
+
+std::streamsize StandardOutputStreamBuffer::xsputn(
+        const char *Characters,
+        std::streamsize Count)
+{
+    if(static_cast<unsigned long long>(Count) < Buffer.size())
+    {
+        return std::streambuf::xsputn(Characters,Count);
+    }
+
+    if(Opened == false || Flush() == false ||
+       Write(Characters,Count) == false)
+    {
+        return 0;
+    }
+
+    return Count;
+}
+
+// ====
+// Sync
+// ====
+
+int StandardOutputStreamBuffer::sync()
+{
+    return Flush() == true ? 0 : -1;
+}
+
+// =====
+// Flush
+// =====
+
+bool StandardOutputStreamBuffer::Flush()
+{
+    unsigned long long Count = pptr() - pbase();
+    if(Count == 0)
+    {
+        return true;
+    }
+
+    bool Status = Write(pbase(),Count);
+    setp(&Buffer[0],&Buffer[0] + Buffer.size());
+
+    return Status;
+}
+
+// =====
+// Write
+// =====
+
+// Description:
+// Writes bytes in several writes if a write is interrupted or partial, as
+// on a pipe or a socket.
+
+bool StandardOutputStreamBuffer::Write(
+        const char *Bytes,
+        unsigned long long Count)
+{
+    unsigned long long Written = 0;
+    while(Written < Count)
+    {
+        ssize_t Result = write(STDOUT_FILENO,Bytes + Written,
+                Count - Written);
+        if(Result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if(Result <= 0)
+        {
+            return false;
+        }
+
+        Written += Result;
+    }
+
+    return true;
+}
+
+// ==================
+// Output File Stream
+// ==================
+
+// Description:
+// Writes a file with a file buffer, the matrix of a shared memory segment,
+// a region of a file, or shard files, such that the writers do not depend
+// on where the rows go.
+
+OutputFileStream::OutputFileStream():
+    std::ostream(NULL)
+{
+    setstate(std::ios::badbit);
+}
+
+// ====
+// Open
+// ====
+
+void OutputFileStream::open(
+        const char *OutputFilename,
+        std::ios::openmode Mode)
+{
+    close();
+    if(FileBuffer.open(OutputFilename,Mode | std::ios::out) != NULL)
+    {
+        rdbuf(&FileBuffer);
+    }
+}
+
+// ====================
+// Open Standard Output
+// ====================
+
+void OutputFileStream::OpenStandardOutput()
+{
+    close();
+    StandardOutput.Open();
+    rdbuf(&StandardOutput);
+}
+
+// ==================
+// Open Shared Memory
+// ==================
+
+void OutputFileStream::OpenSharedMemory(const char *Name)
+{
+    close();
+    if(SharedMemory.Open(Name) == true)
+    {
+        rdbuf(&SharedMemory);
+    }
+}
+
+// ===========
+// Open Region
+// ===========
+
+void OutputFileStream::OpenRegion(
+        const char *OutputFilename,
+        unsigned long long Offset,
+        unsigned long long Size)
+{
+    close();
+    if(Region.Open(OutputFilename,Offset,Size) == true)
+    {
+        rdbuf(&Region);
+    }
+}
+
+// ===========
+// Open Shards
+// ===========
+
+void OutputFileStream::OpenShards(
+        const std::vector<std::string> &Filenames,
+        unsigned long long ShardSize,
+        unsigned long long Size)
+{
+    close();
+    if(Region.Open(Filenames,ShardSize,Size) == true)
+    {
+        rdbuf(&Region);
+    }
+}
+
+// =======
+// Is Open
+// =======
+
+bool OutputFileStream::is_open() const
+{
+    return FileBuffer.is_open() == true || StandardOutput.IsOpen() == true ||
+           SharedMemory.IsOpen() == true || Region.IsOpen() == true;
+}
+
+// =====
+// Close
+// =====
+
+// Description:
+// The buffer of a region is written on close, which is the last chance to
+// report that it could not be written. A region that is closed before it is
+// full would leave the rows of its writer as zeros, or as the rows of an
+// earlier output, so that is an error too.
+
+void OutputFileStream::close()
+{
+    FileBuffer.close();
+    SharedMemory.Close();
+    if(StandardOutput.Close() == false)
+    {
+        std::cerr << "Can not write to output file." << std::endl;
+        throw ConversionError();
+    }
+    if(Region.IsOpen() == true)
+    {
+        bool Full = Region.IsFull();
+        if(Region.Close() == false)
+        {
+            std::cerr << "Can not write to output file." << std::endl;
+            throw ConversionError();
+        }
+        else if(Full == false)
+        {
+            std::cerr << "The rows written to the output file do not fill ";
+            std::cerr << "the rows that were laid out for them." << std::endl;
+            throw ConversionError();
+        }
+    }
+    rdbuf(NULL);
+}
+
+// ==========================
+// Can Read Legacy Input File
+// ==========================
+
+// Description:
+// The native legacy reader reads numeric arrays and explicit points. Files
+// with selected bit or string arrays, or whose cells should be written, are
+// left to the VTK legacy reader.
+
+bool CanReadLegacyInputFile(
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    // Cells are left to the VTK reader
+    if(Options.WriteTopology == true)
+    {
+        return false;
+    }
+
+    // Explicit points of point sets
+    const ArrayHeader &Points = Header.Pieces[0].Points;
+    if(Options.WritePoints == true &&
+       (Points.Offset < 0 || Points.DataType == VTK_VOID))
+    {
+        return false;
+    }
+
+    const std::vector<ArrayHeader> *Arrays[2] = {
+        &Header.Pieces[0].PointArrays,&Header.Pieces[0].CellArrays};
+    bool ReadAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        for(unsigned int ArrayIterator = 0;
+            ReadAttribute[AttributeIterator] == true &&
+            ArrayIterator < Arrays[AttributeIterator]->size();
+            ArrayIterator++)
+        {
+            const ArrayHeader &Array = \
+                (*Arrays[AttributeIterator])[ArrayIterator];
+            if(IsArraySelected(Array.Name,Options) == false)
+            {
+                continue;
+            }
+
+            if(Array.DataType == VTK_VOID || Array.DataType == VTK_BIT ||
+               Array.DataType == VTK_STRING)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// ===========================================
+// Read Legacy Input File Write To Output File
+// ===========================================
+
+// Description:
+// Native reader for all legacy dataset types: structured points, structured
+// grid, rectilinear grid, unstructured grid and polydata.
+//
+// The header scan has already skipped the geometry and topology sections,
+// by seeking over binary data or counting ASCII tokens, and has recorded the
+// file position of each point and cell data attribute. Here, only the
+// selected arrays are read, each by seeking directly to its data. Points,
+// cells and connectivity are never parsed.
+//
+// Unlike the VTK legacy readers, all scalars, vectors, normals, tensors,
+// texture coordinates and field arrays are read without ReadAll...On.
+
+void ReadLegacyInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // Implicit geometry of structured points
+    ImageGeometry Geometry;
+    bool StructuredPoints = (Header.DataSetType == "STRUCTURED_POINTS");
+    if(StructuredPoints == true)
+    {
+        GetHeaderImageGeometry(Header,Geometry);
+    }
+
+    // Out-of-core conversion
+    if(Options.MemoryLimit > 0)
+    {
+        StreamPieceToOutputFiles(
+                InputFile,
+                InputFilename,
+                Header,
+                Header.Pieces[0],
+                StructuredPoints == true ? &Geometry : NULL,
+                OutputFilename,
+                Options);
+        return;
+    }
+
+    // Read selected point and cell data arrays
+    vtkSmartPointer<vtkPointData> InputPointData = \
+            vtkSmartPointer<vtkPointData>::New();
+    vtkSmartPointer<vtkCellData> InputCellData = \
+            vtkSmartPointer<vtkCellData>::New();
+
+    ReadPieceArrays(
+            InputFile,
+            InputFilename,
+            Header,
+            Header.Pieces[0],
+            Options,
+            StructuredPoints == true ? &Geometry : NULL,
+            InputPointData,
+            InputCellData);
+
+    // Point coordinates
+    vtkSmartPointer<vtkDataArray> InputPoints;
+    if(Options.WritePoints == true && Options.WritePointData == true)
+    {
+        const ArrayHeader &Points = Header.Pieces[0].Points;
+        InputPoints = vtkSmartPointer<vtkDataArray>::Take(
+                vtkDataArray::CreateDataArray(Points.DataType));
+
+        if(ReadLegacyArray(InputFile,Points,InputPoints) == false)
+        {
+            std::cerr << "Can not read points from: " << InputFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    // Write to output file
+    WriteAttributesToOutputFiles(
+            InputPointData,
+            InputCellData,
+            InputPoints,
+            StructuredPoints == true ? &Geometry : NULL,
+            OutputFilename,
+            Options);
+}
+
+// =================
+// Read Piece Arrays
+// =================
+
+// Description:
+// Reads the selected point and cell data arrays of one piece of a file
+// whose header has been scanned, by seeking to the data of each array.
+// Offsets of legacy arrays are file positions, and offsets of XML arrays
+// are relative to the appended data, where each array starts with a block
+// header that gives its size in bytes.
+//
+// For image data, Geometry holds the extent of the piece. If a sub-volume
+// is extracted, or a stride is given, only the tuples in the sub-volume at
+// the stride are read, and on return the extent and stride of the Geometry
+// describe the tuples that were read. Cell data is read for the cells
+// between the points that were read, at the same stride.
+
+void ReadPieceArrays(
+        std::istream &InputFile,
+        const char *InputFilename,
+        const FileHeader &Header,
+        const PieceHeader &Piece,
+        const ConversionOptions &Options,
+        ImageGeometry *Geometry,              // Input/Output
+        vtkDataSetAttributes *InputPointData, // Output
+        vtkDataSetAttributes *InputCellData)  // Output
+{
+    vtkDataSetAttributes *InputData[2] = {InputPointData,InputCellData};
+    const std::vector<ArrayHeader> *Arrays[2] = {
+        &Piece.PointArrays,&Piece.CellArrays};
+    bool ReadAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+
+    // Extents of the data in the file, and of the data to read
+    int DataExtents[2][6];
+    int ReadExtents[2][6];
+    if(Geometry != NULL)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            DataExtents[0][i] = Geometry->Extent[i];
+        }
+
+        GetExtractExtent(DataExtents[0],Options,ReadExtents[0]);
+        GetCellExtent(DataExtents[0],DataExtents[0],DataExtents[1]);
+        GetCellExtent(ReadExtents[0],DataExtents[0],ReadExtents[1]);
+        AlignExtentToStride(ReadExtents[1],Options.Stride);
+    }
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(ReadAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        ReadAttributeArrays(
+                InputFile,
+                InputFilename,
+                Header,
+                *Arrays[AttributeIterator],
+                Geometry != NULL ? DataExtents[AttributeIterator] : NULL,
+                Geometry != NULL ? ReadExtents[AttributeIterator] : NULL,
+                NULL,
+                Options.Stride,
+                Options,
+                InputData[AttributeIterator]);
+    }
+
+    if(Geometry != NULL)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Geometry->Extent[i] = ReadExtents[0][i];
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Geometry->Stride[i] = Options.Stride[i];
+        }
+    }
+}
+
+// =====================
+// Read Attribute Arrays
+// =====================
+
+// Description:
+// Reads the selected arrays of the point or cell data of a piece. If
+// DataExtent is NULL, the rows ReadRows (first row and number of rows) of
+// each array are read, or all of its tuples if ReadRows is NULL. Otherwise,
+// the tuples in ReadExtent at the Stride are read, where the file stores
+// the tuples of DataExtent.
+//
+// The arrays are read in the order of their data in the file, so that a
+// compressed file is decompressed forward, and are added in the order of
+// the header.
+
+void ReadAttributeArrays(
+        std::istream &InputFile,
+        const char *InputFilename,
+        const FileHeader &Header,
+        const std::vector<ArrayHeader> &Arrays,
+        const int *DataExtent,
+        const int *ReadExtent,
+        const unsigned long long *ReadRows,
+        const int Stride[3],
+        const ConversionOptions &Options,
+        vtkDataSetAttributes *InputData)      // Output
+{
+    // Selected arrays in the order of their data
+    std::vector<std::pair<long long,unsigned int> > Offsets;
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Arrays.size();
+        ArrayIterator++)
+    {
+        if(IsArraySelected(Arrays[ArrayIterator].Name,Options) == true)
+        {
+            Offsets.push_back(std::make_pair(
+                        Arrays[ArrayIterator].Offset,ArrayIterator));
+        }
+    }
+    std::sort(Offsets.begin(),Offsets.end());
+
+    std::vector<vtkSmartPointer<vtkDataArray> > InputDataArrays(
+            Arrays.size());
+    for(unsigned int OffsetIterator = 0;
+        OffsetIterator < Offsets.size();
+        OffsetIterator++)
+    {
+        unsigned int ArrayIndex = Offsets[OffsetIterator].second;
+        const ArrayHeader &Array = Arrays[ArrayIndex];
+
+        vtkSmartPointer<vtkDataArray> InputDataArray = \
+                vtkSmartPointer<vtkDataArray>::Take(
+                        vtkDataArray::CreateDataArray(Array.DataType));
+        InputDataArrays[ArrayIndex] = InputDataArray;
+
+        bool Status = false;
+        if(DataExtent == NULL && ReadRows == NULL &&
+           Header.FileType == VTK)
+        {
+            Status = ReadLegacyArray(InputFile,Array,InputDataArray);
+        }
+        else
+        {
+            long long DataOffset = Array.Offset;
+            if(Header.FileType != VTK)
+            {
+                DataOffset += Header.AppendedDataOffset + \
+                              Header.HeaderTypeSize;
+            }
+
+            if(DataExtent != NULL)
+            {
+                Status = ReadArrayExtent(
+                        InputFile,
+                        Array,
+                        DataOffset,
+                        Header.BigEndian,
+                        DataExtent,
+                        ReadExtent,
+                        Stride,
+                        InputDataArray);
+            }
+            else
+            {
+                Status = ReadArrayRows(
+                        InputFile,
+                        Array,
+                        DataOffset,
+                        Header.BigEndian,
+                        ReadRows != NULL ? ReadRows[0] : 0,
+                        ReadRows != NULL ? ReadRows[1] : \
+                                           Array.NumberOfTuples,
+                        InputDataArray);
+            }
+        }
+
+        if(Status == false)
+        {
+            std::cerr << "Can not read array " << Array.Name;
+            std::cerr << " from: " << InputFilename << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Arrays.size();
+        ArrayIterator++)
+    {
+        if(InputDataArrays[ArrayIterator] != NULL)
+        {
+            InputData->AddArray(InputDataArrays[ArrayIterator]);
+        }
+    }
+}
+
+// =========================
+// Get Header Image Geometry
+// =========================
+
+void GetHeaderImageGeometry(
+        const FileHeader &Header,
+        ImageGeometry &Geometry)              // Output
+{
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        Geometry.Extent[2*Dimension] = Header.WholeExtent[2*Dimension];
+        Geometry.Extent[2*Dimension+1] = Header.WholeExtent[2*Dimension+1];
+        Geometry.Origin[Dimension] = Header.Origin[Dimension];
+        Geometry.Spacing[Dimension] = Header.Spacing[Dimension];
+    }
+}
+
+// ==================
+// Get Extract Extent
+// ==================
+
+// Description:
+// The part of the extent of the data that is converted: the whole extent,
+// or its intersection with the sub-volume of the --extent option. The last
+// index in each direction is aligned to the --stride option.
+
+void GetExtractExtent(
+        const int DataExtent[6],
+        const ConversionOptions &Options,
+        int ReadExtent[6])                    // Output
+{
+    if(Options.ExtractExtent == false)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            ReadExtent[i] = DataExtent[i];
+        }
+        AlignExtentToStride(ReadExtent,Options.Stride);
+        return;
+    }
+
+    bool Overlap = IntersectExtents(DataExtent,Options.Extent,ReadExtent);
+    if(Overlap == false && Options.SliceAxis >= 0)
+    {
+        std::cerr << "Slice " << "xyz"[Options.SliceAxis] << " = ";
+        std::cerr << Options.SliceIndex << " is outside of the data extent ";
+        std::cerr << DataExtent[2*Options.SliceAxis] << " ";
+        std::cerr << DataExtent[2*Options.SliceAxis+1] << "." << std::endl;
+        throw ConversionError();
+    }
+    else if(Overlap == false)
+    {
+        std::cerr << "Extent " << Options.Extent[0];
+        for(unsigned int i = 1; i < 6; i++)
+        {
+            std::cerr << " " << Options.Extent[i];
+        }
+        std::cerr << " is outside of the data extent " << DataExtent[0];
+        for(unsigned int i = 1; i < 6; i++)
+        {
+            std::cerr << " " << DataExtent[i];
+        }
+        std::cerr << "." << std::endl;
+        throw ConversionError();
+    }
+
+    AlignExtentToStride(ReadExtent,Options.Stride);
+}
+
+// ======================
+// Align Extent To Stride
+// ======================
+
+// Description:
+// Moves the last index of the extent in each direction down to the last
+// index that is reached from the first index in steps of Stride.
+
+void AlignExtentToStride(
+        int Extent[6],                        // Input/Output
+        const int Stride[3])
+{
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        int Steps = (Extent[2*Dimension+1] - Extent[2*Dimension]) / \
+                    Stride[Dimension];
+        Extent[2*Dimension+1] = Extent[2*Dimension] + \
+                                Steps * Stride[Dimension];
+    }
+}
+
+// ===========================
+// Get Number Of Extent Tuples
+// ===========================
+
+// Description:
+// Number of tuples at every Stride-th index of an aligned extent.
+
+unsigned long long GetNumberOfExtentTuples(
+        const int Extent[6],
+        const int Stride[3])
+{
+    unsigned long long NumberOfTuples = 1;
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        NumberOfTuples *= static_cast<unsigned long long>(
+                (Extent[2*Dimension+1] - Extent[2*Dimension]) / \
+                Stride[Dimension] + 1);
+    }
+
+    return NumberOfTuples;
+}
+
+// =================
+// Intersect Extents
+// =================
+
+// Description:
+// Returns false if the extents do not overlap.
+
+bool IntersectExtents(
+        const int FirstExtent[6],
+        const int SecondExtent[6],
+        int Intersection[6])                  // Output
+{
+    bool Overlap = true;
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        Intersection[2*Dimension] = std::max(
+                FirstExtent[2*Dimension],SecondExtent[2*Dimension]);
+        Intersection[2*Dimension+1] = std::min(
+                FirstExtent[2*Dimension+1],SecondExtent[2*Dimension+1]);
+
+        if(Intersection[2*Dimension] > Intersection[2*Dimension+1])
+        {
+            Overlap = false;
+        }
+    }
+
+    return Overlap;
+}
+
+// ===============
+// Get Cell Extent
+// ===============
+
+// Description:
+// Extent of the cells between the points of PointExtent, which lies in the
+// WholePointExtent of the data. Cell i lies between points i and i+1. In a
+// direction where the data has a single point, or where PointExtent has a
+// single point, the cells of one layer are taken, as VTK does for the cell
+// data of image data.
+
+void GetCellExtent(
+        const int PointExtent[6],
+        const int WholePointExtent[6],
+        int CellExtent[6])                    // Output
+{
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        int WholeLastCell = std::max(WholePointExtent[2*Dimension],
+                WholePointExtent[2*Dimension+1] - 1);
+        CellExtent[2*Dimension] = std::min(PointExtent[2*Dimension],
+                WholeLastCell);
+        CellExtent[2*Dimension+1] = std::max(CellExtent[2*Dimension],
+                PointExtent[2*Dimension+1] - 1);
+    }
+}
+
+// =================
+// Read Legacy Array
+// =================
+
+// Description:
+// Allocates the array and reads all its values from the file position found
+// by the header scan.
+
+bool ReadLegacyArray(
+        std::istream &InputFile,
+        const ArrayHeader &Array,
+        vtkDataArray *InputDataArray)         // Output
+{
+    return ReadArrayRows(
+            InputFile,
+            Array,
+            Array.Offset,
+            true,
+            0,
+            Array.NumberOfTuples,
+            InputDataArray);
+}
+
+// =================
+// Read Array Extent
+// =================
+
+// Description:
+// Allocates the array and reads the tuples in ReadExtent, where the file
+// stores the tuples of DataExtent from DataOffset on, with i varying
+// fastest. With a Stride, only every Stride-th tuple of ReadExtent in each
+// direction is read, starting from its first index. ReadExtent should be
+// aligned to the Stride.
+//
+// The tuples are read in runs that are contiguous in the file: a row of i,
+// a set of whole rows of a plane, or the whole extent. Rows and planes that
+// are skipped by the stride are never read. If i is strided, the span of
+// each row from its first to its last sampled tuple is read into a row
+// buffer, and the sampled tuples are copied from it.
+//
+// Binary data is read with one seek and one read per run, so the data
+// outside of the extent is never read. ASCII data is read sequentially, and
+// the values between runs are skipped without being parsed.
+
+bool ReadArrayExtent(
+        std::istream &InputFile,
+        const ArrayHeader &Array,
+        long long DataOffset,
+        bool BigEndian,
+        const int DataExtent[6],
+        const int ReadExtent[6],
+        const int Stride[3],
+        vtkDataArray *InputDataArray)         // Output
+{
+    long long DataSize[3];
+    long long ReadSize[3];
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        DataSize[Dimension] = DataExtent[2*Dimension+1] - \
+                              DataExtent[2*Dimension] + 1;
+        ReadSize[Dimension] = (ReadExtent[2*Dimension+1] - \
+                               ReadExtent[2*Dimension]) / \
+                              Stride[Dimension] + 1;
+    }
+
+    unsigned long long NumberOfDataTuples = \
+        DataSize[0] * DataSize[1] * DataSize[2];
+    if(Array.NumberOfTuples != NumberOfDataTuples)
+    {
+        std::cerr << "Array " << Array.Name << " has ";
+        std::cerr << Array.NumberOfTuples << " tuples, but its extent has ";
+        std::cerr << NumberOfDataTuples << "." << std::endl;
+        return false;
+    }
+
+    unsigned int NumberOfComponents = Array.NumberOfComponents;
+    long long NumberOfReadTuples = ReadSize[0] * ReadSize[1] * ReadSize[2];
+
+    InputDataArray->SetName(Array.Name.c_str());
+    InputDataArray->SetNumberOfComponents(NumberOfComponents);
+    InputDataArray->SetNumberOfTuples(NumberOfReadTuples);
+
+    if(NumberOfReadTuples == 0)
+    {
+        return true;
+    }
+
+    // Runs of contiguous tuples
+    bool StridedRows = (Stride[0] > 1);
+    bool WholeRows = (StridedRows == false && Stride[1] == 1 &&
+                      ReadSize[0] == DataSize[0]);
+    bool WholePlanes = (WholeRows == true && Stride[2] == 1 &&
+                        ReadSize[1] == DataSize[1]);
+    long long RunSize = ReadSize[0];
+    if(WholePlanes == true)
+    {
+        RunSize = NumberOfReadTuples;
+    }
+    else if(WholeRows == true)
+    {
+        RunSize = ReadSize[0] * ReadSize[1];
+    }
+
+    // Tuples of a run in the file
+    long long RunSpan = RunSize;
+    if(StridedRows == true)
+    {
+        RunSpan = (ReadSize[0] - 1) * Stride[0] + 1;
+    }
+
+    long long NumberOfRuns = NumberOfReadTuples / RunSize;
+    unsigned long long NumberOfSpanValues = RunSpan * NumberOfComponents;
+    unsigned int TypeSize = InputDataArray->GetDataTypeSize();
+    unsigned long long TupleBytes = NumberOfComponents * TypeSize;
+    char *Values = static_cast<char*>(InputDataArray->GetVoidPointer(0));
+
+    std::vector<char> RowBuffer;
+    if(StridedRows == true)
+    {
+        RowBuffer.resize(RunSpan * TupleBytes);
+    }
+
+    InputFile.clear();
+    InputFile.seekg(DataOffset);
+    long long NextTuple = 0;
+
+    for(long long RunIterator = 0; RunIterator < NumberOfRuns; RunIterator++)
+    {
+        // Index of the first tuple of the run in the file
+        long long J = 0;
+        long long K = 0;
+        if(WholePlanes == false)
+        {
+            J = WholeRows == true ? 0 : RunIterator % ReadSize[1];
+            K = WholeRows == true ? RunIterator : RunIterator / ReadSize[1];
+        }
+
+        long long FirstTuple = (ReadExtent[0] - DataExtent[0]) + \
+            DataSize[0] * ((ReadExtent[2] - DataExtent[2] + J * Stride[1]) + \
+            DataSize[1] * (ReadExtent[4] - DataExtent[4] + K * Stride[2]));
+
+        // Move to the run
+        if(Array.BinaryData == true)
+        {
+            InputFile.seekg(DataOffset + FirstTuple * NumberOfComponents * \
+                    static_cast<long long>(Array.ValueSize));
+        }
+        else if(SkipLegacyValues(InputFile,false,"",
+                    (FirstTuple - NextTuple) * NumberOfComponents) == false)
+        {
+            return false;
+        }
+
+        // Read the run
+        char *RunValues = Values + RunIterator * RunSize * TupleBytes;
+        void *SpanValues = StridedRows == true ? &RowBuffer[0] : RunValues;
+        bool Status = false;
+        switch(InputDataArray->GetDataType())
+        {
+            vtkTemplateMacro(
+                    Status = ReadValues(
+                        InputFile,
+                        Array.BinaryData,
+                        BigEndian,
+                        Array.ValueSize,
+                        Array.ColorScalars,
+                        NumberOfSpanValues,
+                        static_cast<VTK_TT*>(SpanValues)));
+            default:
+                std::cerr << "Unsupported data type: ";
+                std::cerr << GetDataTypeName(Array.DataType) << std::endl;
+        }
+
+        if(Status == false)
+        {
+            return false;
+        }
+
+        // Sampled tuples of a strided row
+        if(StridedRows == true)
+        {
+            for(long long TupleIterator = 0;
+                TupleIterator < RunSize;
+                TupleIterator++)
+            {
+                memcpy(RunValues + TupleIterator * TupleBytes,
+                       &RowBuffer[TupleIterator * Stride[0] * TupleBytes],
+                       TupleBytes);
+            }
+        }
+
+        NextTuple = FirstTuple + RunSpan;
+    }
+
+    return true;
+}
+
+// ===============
+// Read Array Rows
+// ===============
+
+// Description:
+// Allocates the array and reads NumberOfRows tuples from tuple FirstRow of
+// an array of unstructured data, whose tuples are stored from DataOffset
+// on. The rows are counted in 64 bits, so that an array may have more
+// tuples than an extent can index. Binary data is read with one seek and
+// one read, and ASCII values before the first row are skipped.
+
+bool ReadArrayRows(
+        std::istream &InputFile,
+        const ArrayHeader &Array,
+        long long DataOffset,
+        bool BigEndian,
+        unsigned long long FirstRow,
+        unsigned long long NumberOfRows,
+        vtkDataArray *InputDataArray)         // Output
+{
+    if(FirstRow + NumberOfRows > Array.NumberOfTuples)
+    {
+        std::cerr << "Array " << Array.Name << " has ";
+        std::cerr << Array.NumberOfTuples << " tuples, but rows up to ";
+        std::cerr << FirstRow + NumberOfRows << " are read." << std::endl;
+        return false;
+    }
+
+    unsigned int NumberOfComponents = Array.NumberOfComponents;
+    InputDataArray->SetName(Array.Name.c_str());
+    InputDataArray->SetNumberOfComponents(NumberOfComponents);
+    InputDataArray->SetNumberOfTuples(NumberOfRows);
+
+    if(NumberOfRows == 0)
+    {
+        return true;
+    }
+
+    // Move to the first row
+    InputFile.clear();
+    if(Array.BinaryData == true)
+    {
+        InputFile.seekg(DataOffset + static_cast<long long>(
+                FirstRow * NumberOfComponents * Array.ValueSize));
+    }
+    else
+    {
+        InputFile.seekg(DataOffset);
+        if(SkipLegacyValues(InputFile,false,"",
+                    FirstRow * NumberOfComponents) == false)
+        {
+            return false;
+        }
+    }
+
+    bool Status = false;
+    switch(InputDataArray->GetDataType())
+    {
+        vtkTemplateMacro(
+                Status = ReadValues(
+                    InputFile,
+                    Array.BinaryData,
+                    BigEndian,
+                    Array.ValueSize,
+                    Array.ColorScalars,
+                    NumberOfRows * NumberOfComponents,
+                    static_cast<VTK_TT*>(
+                        InputDataArray->GetVoidPointer(0))));
+        default:
+            std::cerr << "Unsupported data type: ";
+            std::cerr << GetDataTypeName(Array.DataType) << std::endl;
+    }
+
+    return Status;
+}
+
+// ===========
+// Read Values
+// ===========
+
+// Description:
+// Reads values from the current position of the file. Binary values are
+// read directly into the array memory and swapped in place if their byte
+// order differs from this machine. Binary legacy data is big endian. The
+// legacy writer stores vtkIdType as 4-byte integers, which are widened in
+// chunks. ASCII values are parsed token by token. ASCII color scalars are
+// written as fractions, which are scaled to the unsigned chars of binary
+// files, as the VTK legacy reader does.
+
+template <class ValueType>
+bool ReadValues(
+        std::istream &InputFile,
+        bool BinaryData,
+        bool BigEndian,
+        unsigned int ValueSize,
+        bool ColorScalars,
+        unsigned long long NumberOfValues,
+        ValueType *Values)                    // Output
+{
+    if(BinaryData == true && ValueSize == sizeof(ValueType))
+    {
+        InputFile.read(reinterpret_cast<char*>(Values),
+                NumberOfValues*sizeof(ValueType));
+        SwapValueBytes(Values,NumberOfValues,sizeof(ValueType),BigEndian);
+    }
+    else if(BinaryData == true && ValueSize == sizeof(int))
+    {
+        const unsigned long long ChunkSize = 65536;
+        std::vector<int> Chunk(ChunkSize);
+
+        for(unsigned long long ChunkStart = 0;
+            ChunkStart < NumberOfValues && InputFile.good();
+            ChunkStart += ChunkSize)
+        {
+            unsigned long long NumberOfChunkValues = \
+                std::min(ChunkSize,NumberOfValues-ChunkStart);
+            InputFile.read(reinterpret_cast<char*>(&Chunk[0]),
+                    NumberOfChunkValues*sizeof(int));
+            SwapValueBytes(&Chunk[0],NumberOfChunkValues,sizeof(int),
+                    BigEndian);
+
+            for(unsigned long long ValueIterator = 0;
+                ValueIterator < NumberOfChunkValues;
+                ValueIterator++)
+            {
+                Values[ChunkStart+ValueIterator] = \
+                    static_cast<ValueType>(Chunk[ValueIterator]);
+            }
+        }
+    }
+    else if(BinaryData == true)
+    {
+        std::cerr << "Unexpected size of binary values." << std::endl;
+        return false;
+    }
+    else
+    {
+        std::streambuf *Buffer = InputFile.rdbuf();
+        char Token[CHAR_LENGTH];
+
+        for(unsigned long long ValueIterator = 0;
+            ValueIterator < NumberOfValues;
+            ValueIterator++)
+        {
+            // Leading white spaces
+            int Character = Buffer->sbumpc();
+            while(Character != EOF && isspace(Character))
+            {
+                Character = Buffer->sbumpc();
+            }
+
+            // Token
+            unsigned int Length = 0;
+            while(Character != EOF && !isspace(Character) &&
+                  Length < CHAR_LENGTH - 1)
+            {
+                Token[Length++] = static_cast<char>(Character);
+                Character = Buffer->sbumpc();
+            }
+            Token[Length] = '\0';
+
+            if(Length == 0)
+            {
+                InputFile.setstate(std::ios::eofbit);
+                break;
+            }
+
+            if(ColorScalars == true)
+            {
+                Values[ValueIterator] = static_cast<ValueType>(
+                        255.0 * strtod(Token,NULL) + 0.5);
+            }
+            else if(std::numeric_limits<ValueType>::is_integer)
+            {
+                Values[ValueIterator] = static_cast<ValueType>(
+                        strtoll(Token,NULL,10));
+            }
+            else
+            {
+                Values[ValueIterator] = static_cast<ValueType>(
+                        strtod(Token,NULL));
+            }
+        }
+    }
+
+    if(InputFile.fail() == true || InputFile.eof() == true)
+    {
+        std::cerr << "Unexpected end of input file." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// ================
+// Swap Value Bytes
+// ================
+
+// Description:
+// Converts values of the given byte order to the byte order of this
+// machine, in place.
+
+void SwapValueBytes(
+        void *Values,                         // Input/Output
+        unsigned long long NumberOfValues,
+        unsigned int ValueSize,
+        bool BigEndian)
+{
+    const unsigned int One = 1;
+    bool BigEndianMachine = \
+        (*reinterpret_cast<const unsigned char*>(&One) == 0);
+
+    if(BigEndianMachine == BigEndian || ValueSize < 2)
+    {
+        return;
+    }
+
+    unsigned char *Bytes = static_cast<unsigned char*>(Values);
+    for(unsigned long long ValueIterator = 0;
+        ValueIterator < NumberOfValues;
+        ValueIterator++)
+    {
+        std::reverse(Bytes,Bytes+ValueSize);
+        Bytes += ValueSize;
+    }
+}
+
+// ===============================================
+// Read VTK Legacy Input File Write To Output File
+// ===============================================
+
+// Description:
+//
+// Note that VTK legacy file readers such as
+//    StructuredPointsReader,
+//    StructuredGridReader,
+//    UnstructuredGridReader,
+//    ImageDataReader,
+//    PolyDataReader
+// Do not read all Scalars and vectors and Tensors. They only read the first
+// scalar, the first vector, etc. To Read them all, we should add enable
+// methods ReadAll...On.
+//
+// Note: For XML data (see next function), these options do not have to be
+// enabled, since XML readers will read all scalars, vectors, etc.
+//
+// This reader is used only for legacy files that the native reader can not
+// read. vtkDataSetReader reads all legacy dataset types.
+
+void ReadVTKLegacyInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    // Reader
+    vtkSmartPointer<vtkDataSetReader> DataSetReader = \
+            vtkSmartPointer<vtkDataSetReader>::New();
+
+    // Compressed file or standard input, from memory
+    std::string InputString;
+    if(ReadsFromInputString(InputFilename) == true)
+    {
+        if(ReadInputFileContent(InputFilename,InputString) == false ||
+           InputString.size() > static_cast<std::size_t>(
+               std::numeric_limits<int>::max()))
+        {
+            std::cerr << "Can not read input file: " << InputFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        DataSetReader->ReadFromInputStringOn();
+        DataSetReader->SetBinaryInputString(InputString.c_str(),
+                static_cast<int>(InputString.size()));
+    }
+    else
+    {
+        DataSetReader->SetFileName(InputFilename);
+    }
+    DataSetReader->ReadAllScalarsOn();
+    DataSetReader->ReadAllVectorsOn();
+    DataSetReader->ReadAllNormalsOn();
+    DataSetReader->ReadAllTensorsOn();
+    DataSetReader->ReadAllColorScalarsOn();
+    DataSetReader->ReadAllTCoordsOn();
+    DataSetReader->ReadAllFieldsOn();
+
+    if(Options.MemoryLimit > 0)
+    {
+        std::cerr << "Warning: --memory-limit is not available for this ";
+        std::cerr << "legacy file. The whole dataset is read." << std::endl;
+    }
+
+    DataSetReader->Update();
+
+    if(DataSetReader->GetOutput() == NULL)
+    {
+        std::cerr << "Can not read legacy file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // Write to output file
+    WriteDataSetToOutputFiles(DataSetReader->GetOutput(),OutputFilename,
+            Options);
+}
+
+// ============================
+// Can Read Appended Image Data
+// ============================
+
+// Description:
+// The native image data reader reads single piece VTI files whose selected
+// arrays are stored uncompressed in raw appended data, which is how
+// vtkXMLImageDataWriter writes them by default without compression. Other
+// files are read by vtkXMLImageDataReader.
+
+bool CanReadAppendedImageData(
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    return Header.Pieces.size() == 1 && CanReadAppendedData(Header,Options);
+}
+
+// ======================
+// Can Read Appended Data
+// ======================
+
+// Description:
+// True if the selected point and cell data arrays of all pieces of an XML
+// file can be read by seeking to their raw appended data.
+
+bool CanReadAppendedData(
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    if(Header.Compressor.empty() == false ||
+       Header.AppendedDataOffset < 0 ||
+       Header.AppendedDataEncoding != "raw" ||
+       Options.WritePoints == true ||
+       Options.WriteTopology == true)
+    {
+        return false;
+    }
+
+    bool ReadAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+
+    for(unsigned int PieceIterator = 0;
+        PieceIterator < Header.Pieces.size();
+        PieceIterator++)
+    {
+        const PieceHeader &Piece = Header.Pieces[PieceIterator];
+        const std::vector<ArrayHeader> *Arrays[2] = {
+            &Piece.PointArrays,&Piece.CellArrays};
+
+        for(unsigned int AttributeIterator = 0;
+            AttributeIterator < 2;
+            AttributeIterator++)
+        {
+            if(ReadAttribute[AttributeIterator] == false)
+            {
+                continue;
+            }
+
+            for(unsigned int ArrayIterator = 0;
+                ArrayIterator < Arrays[AttributeIterator]->size();
+                ArrayIterator++)
+            {
+                const ArrayHeader &Array = \
+                    (*Arrays[AttributeIterator])[ArrayIterator];
+                if(IsArraySelected(Array.Name,Options) == false)
+                {
+                    continue;
+                }
+
+                if(Array.Format != "appended" || Array.Offset < 0 ||
+                   Array.ValueSize == 0 || Array.DataType == VTK_BIT ||
+                   Array.DataType == VTK_STRING)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// =============================================
+// Read Appended Image Data Write To Output File
+// =============================================
+
+// Description:
+// Native reader of VTI files with raw appended data. The header scan has
+// recorded the offset of each array in the appended data, so each selected
+// array is read by seeking directly to it. With --extent, only the rows of
+// the sub-volume are read from the file.
+
+void ReadAppendedImageDataWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // Geometry of the piece
+    const PieceHeader &Piece = Header.Pieces[0];
+    ImageGeometry Geometry;
+    GetHeaderImageGeometry(Header,Geometry);
+    for(unsigned int i = 0; i < 6; i++)
+    {
+        Geometry.Extent[i] = Piece.Extent[i];
+    }
+
+    // Out-of-core conversion
+    if(Options.MemoryLimit > 0)
+    {
+        StreamPieceToOutputFiles(
+                InputFile,
+                InputFilename,
+                Header,
+                Piece,
+                &Geometry,
+                OutputFilename,
+                Options);
+        return;
+    }
+
+    // Read selected point and cell data arrays
+    vtkSmartPointer<vtkPointData> InputPointData = \
+            vtkSmartPointer<vtkPointData>::New();
+    vtkSmartPointer<vtkCellData> InputCellData = \
+            vtkSmartPointer<vtkCellData>::New();
+
+    ReadPieceArrays(
+            InputFile,
+            InputFilename,
+            Header,
+            Piece,
+            Options,
+            &Geometry,
+            InputPointData,
+            InputCellData);
+
+    // Write to output file
+    WriteAttributesToOutputFiles(
+            InputPointData,
+            InputCellData,
+            NULL,
+            &Geometry,
+            OutputFilename,
+            Options);
+}
+
+// ========================================
+// Read XML Input File Write To Output File
+// ========================================
+
+// Description:
+// One function for all serial XML readers, such as vtkXMLImageDataReader,
+// vtkXMLPolyDataReader and vtkXMLUnstructuredGridReader. If arrays are
+// selected, the reader is asked to read only those arrays. If a sub-volume
+// of image data is extracted, it is requested as the update extent of the
+// reader, so that only the sub-volume is read.
+
+template <class XMLReaderType>
+void ReadXMLInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    // Reader
+    vtkSmartPointer<XMLReaderType> XMLReader = \
+            vtkSmartPointer<XMLReaderType>::New();
+    std::string InputString;
+    SetXMLReaderInput(XMLReader,InputFilename,InputString);
+    SelectReaderArrays(
+            XMLReader->GetPointDataArraySelection(),
+            XMLReader->GetCellDataArraySelection(),
+            Options);
+
+    // Sub-volume of structured data
+    vtkInformation *OutputInformation = XMLReader->GetOutputInformation(0);
+    if(Options.ExtractExtent == true || Options.MemoryLimit > 0)
+    {
+        XMLReader->UpdateInformation();
+    }
+
+    // Out-of-core conversion of structured data, slab by slab
+    if(Options.MemoryLimit > 0 && OutputInformation->Has(
+                vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+    {
+        FileHeader StreamHeader = Header;
+        if(StreamHeader.Pieces.empty() == true)
+        {
+            ScanFileHeader(InputFilename,Header.FileType,StreamHeader);
+        }
+
+        StreamImageDataToOutputFiles(XMLReader,StreamHeader,OutputFilename,
+                Options);
+        return;
+    }
+
+    // Out-of-core conversion of unstructured data, piece by piece
+    FileHeader PiecesHeader = Header;
+    if(Options.MemoryLimit > 0 && PiecesHeader.Pieces.empty() == true)
+    {
+        ScanFileHeader(InputFilename,Header.FileType,PiecesHeader);
+    }
+
+    unsigned int NumberOfPieces = PiecesHeader.Pieces.size();
+    if(Options.MemoryLimit > 0 && NumberOfPieces > 1 &&
+       Options.WriteTopology == false &&
+       Options.BinaryOutputFile == true &&
+       Options.SequentialOutputFile == false &&
+       GetNumberOfThreads(Options,NumberOfPieces) > 1)
+    {
+        // Pieces of this file on a pool of threads
+        for(unsigned int PieceIterator = 0;
+            PieceIterator < NumberOfPieces;
+            PieceIterator++)
+        {
+            PieceHeader &Piece = PiecesHeader.Pieces[PieceIterator];
+            if(Piece.Source.empty() == true)
+            {
+                Piece.SourcePiece = PieceIterator;
+                Piece.NumberOfSourcePieces = NumberOfPieces;
+            }
+        }
+
+        WritePiecesToOutputFiles(InputFilename,PiecesHeader,NULL,
+                OutputFilename,Options);
+        return;
+    }
+    else if(Options.MemoryLimit > 0 && NumberOfPieces > 1 &&
+            Options.WriteTopology == false)
+    {
+        StreamDataSetPiecesToOutputFiles(XMLReader,PiecesHeader,
+                OutputFilename,Options);
+        return;
+    }
+    else if(Options.MemoryLimit > 0)
+    {
+        std::cerr << "Warning: --memory-limit is only available for image ";
+        std::cerr << "data, or for multiple pieces without --topology, for ";
+        std::cerr << "this file type. The whole dataset is read.";
+        std::cerr << std::endl;
+    }
+
+    if(Options.ExtractExtent == true && OutputInformation->Has(
+                vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+    {
+        int WholeExtent[6];
+        int UpdateExtent[6];
+        OutputInformation->Get(
+                vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(),WholeExtent);
+        GetExtractExtent(WholeExtent,Options,UpdateExtent);
+        XMLReader->UpdateExtent(UpdateExtent);
+    }
+    else
+    {
+        XMLReader->Update();
+    }
+
+    // Write to output file
+    WriteDataSetToOutputFiles(XMLReader->GetOutput(),OutputFilename,Options);
+}
+
+// ====================
+// Set XML Reader Input
+// ====================
+
+// Description:
+// Sets the file of an XML reader. A compressed file is decompressed into
+// InputString, and the standard input is copied to it. The reader reads
+// from InputString, which should be kept until the reader is done.
+
+void SetXMLReaderInput(
+        vtkXMLReader *XMLReader,
+        const char *InputFilename,
+        std::string &InputString)             // Output
+{
+    if(ReadsFromInputString(InputFilename) == false)
+    {
+        XMLReader->SetFileName(InputFilename);
+        return;
+    }
+
+    if(ReadInputFileContent(InputFilename,InputString) == false)
+    {
+        std::cerr << "Can not read input file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    XMLReader->ReadFromInputStringOn();
+    XMLReader->SetInputString(InputString);
+}
+
+// ====================
+// Select Reader Arrays
+// ====================
+
+// Description:
+// Asks a reader, by its point and cell data array selections, to read only
+// the selected arrays. Arrays of attributes that are not written are not
+// read.
+
+void SelectReaderArrays(
+        vtkDataArraySelection *PointDataArraySelection,
+        vtkDataArraySelection *CellDataArraySelection,
+        const ConversionOptions &Options)
+{
+    vtkDataArraySelection *ArraySelections[2] = {
+        PointDataArraySelection,CellDataArraySelection};
+    bool ReadAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(ReadAttribute[AttributeIterator] == true &&
+           Options.ArrayNames.empty() == true)
+        {
+            continue;
+        }
+
+        ArraySelections[AttributeIterator]->DisableAllArrays();
+        for(unsigned int NameIterator = 0;
+            ReadAttribute[AttributeIterator] == true &&
+            NameIterator < Options.ArrayNames.size();
+            NameIterator++)
+        {
+            ArraySelections[AttributeIterator]->EnableArray(
+                    Options.ArrayNames[NameIterator].c_str());
+        }
+    }
+}
+
+// ====================
+// New XML Piece Reader
+// ====================
+
+// Description:
+// Creates the serial XML reader of the piece files of a file type. The
+// caller owns the reader.
+
+vtkXMLReader *NewXMLPieceReader(InputFileType FileType)
+{
+    switch(FileType)
+    {
+        case VTI:
+        case PVTI:
+            return vtkXMLImageDataReader::New();
+
+        case VTP:
+        case PVTP:
+            return vtkXMLPolyDataReader::New();
+
+        case VTU:
+        case PVTU:
+            return vtkXMLUnstructuredGridReader::New();
+
+        default:
+            std::cerr << "No piece reader for ";
+            std::cerr << GetInputFileTypeName(FileType) << " files.";
+            std::cerr << std::endl;
+            throw ConversionError();
+    }
+}
+
+// =====================
+// Can Read HDF Datasets
+// =====================
+
+// Description:
+// The datasets of a VTKHDF file are read natively, unless the cells are
+// written, or a selected dataset has a type or shape that is not read
+// natively, which are left to vtkHDFReader.
+
+bool CanReadHDFDatasets(
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    if(Options.WriteTopology == true || Header.Pieces.empty() == true)
+    {
+        return false;
+    }
+
+    // Explicit points of unstructured data
+    const PieceHeader &Piece = Header.Pieces[0];
+    if(Options.WritePoints == true && Piece.Points.DataType == VTK_VOID)
+    {
+        return false;
+    }
+
+    const std::vector<ArrayHeader> *Arrays[2] = {
+        &Piece.PointArrays,&Piece.CellArrays};
+    bool ReadAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        for(unsigned int ArrayIterator = 0;
+            ReadAttribute[AttributeIterator] == true &&
+            ArrayIterator < Arrays[AttributeIterator]->size();
+            ArrayIterator++)
+        {
+            const ArrayHeader &Array = \
+                (*Arrays[AttributeIterator])[ArrayIterator];
+            if(IsArraySelected(Array.Name,Options) == true &&
+               Array.DataType == VTK_VOID)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// ================
+// HDF Library Lock
+// ================
+
+// Description:
+// Locks the HDF5 library for the HDF5 calls of this thread, and turns off
+// the automatic printing of HDF5 errors, which the readers report as their
+// own errors. The handler of the library is saved, and restored on
+// release, since vtkHDFReader uses the same library.
+
+static std::mutex HDFMutex;
+
+HDFLibraryLock::HDFLibraryLock():
+    Lock(HDFMutex),
+    ErrorFunction(NULL),
+    ErrorData(NULL)
+{
+    H5Eget_auto2(H5E_DEFAULT,&ErrorFunction,&ErrorData);
+    H5Eset_auto2(H5E_DEFAULT,NULL,NULL);
+}
+
+// ==========
+// Destructor
+// ==========
+
+HDFLibraryLock::~HDFLibraryLock()
+{
+    Release();
+}
+
+// =======
+// Release
+// =======
+
+void HDFLibraryLock::Release()
+{
+    if(Lock.owns_lock() == true)
+    {
+        H5Eset_auto2(H5E_DEFAULT,ErrorFunction,ErrorData);
+        Lock.unlock();
+    }
+}
+
+// ======================================
+// Read HDF Datasets Write To Output File
+// ======================================
+
+// Description:
+// Native reader of VTKHDF files. Each selected point or cell data array is
+// an HDF5 dataset, which is read with a hyperslab selection of the rows that
+// are written: for image data, the sub-volume at the stride, and with
+// --memory-limit, one slab at a time. HDF5 reads the chunks of the dataset
+// that hold the selected rows, and converts the values to the native byte
+// order. The datasets of all pieces of unstructured data are stored one
+// after another, so they are read as one piece.
+//
+// The HDF5 library of VTK is not thread safe, so that the HDF5 calls of
+// the threads of several files, such as the blocks of a multiblock file, are
+// made one at a time, while the output is written concurrently.
+
+struct HDFSlabReader
+{
+    hid_t File;
+    const char *InputFilename;
+    const FileHeader *Header;
+    const ImageGeometry *Geometry;       // Whole image, or NULL
+    const ConversionOptions *Options;
+    int DataExtents[2][6];               // Point and cell tuples of image
+                                         // data in the file
+    vtkSmartPointer<vtkDataSetAttributes> InputData;
+    vtkSmartPointer<vtkDataArray> InputPoints;
+};
+
+void ReadHDFDatasetsWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    HDFLibraryLock Lock;
+    hid_t File = H5Fopen(InputFilename,H5F_ACC_RDONLY,H5P_DEFAULT);
+    if(File < 0)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // Geometry of image data
+    const PieceHeader &Piece = Header.Pieces[0];
+    bool Structured = (Header.DataSetType == "ImageData");
+    ImageGeometry Geometry;
+    if(Structured == true)
+    {
+        GetHeaderImageGeometry(Header,Geometry);
+    }
+
+    SlabLayout Layout;
+    GetSlabLayout(Piece,Structured == true ? &Geometry : NULL,Options,Layout);
+
+    HDFSlabReader Reader;
+    Reader.File = File;
+    Reader.InputFilename = InputFilename;
+    Reader.Header = &Header;
+    Reader.Geometry = Structured == true ? &Geometry : NULL;
+    Reader.Options = &Options;
+
+    // Extents of the point and cell tuples of image data in the file
+    if(Structured == true)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Reader.DataExtents[0][i] = Geometry.Extent[i];
+        }
+        GetCellExtent(Reader.DataExtents[0],Reader.DataExtents[0],
+                Reader.DataExtents[1]);
+    }
+
+    // Out-of-core conversion, which holds the library for each slab
+    if(Options.MemoryLimit > 0)
+    {
+        Lock.Release();
+        StreamAttributesToOutputFiles(
+                ReadHDFSlab,
+                &Reader,
+                Layout,
+                OutputFilename,
+                Options);
+
+        HDFLibraryLock CloseLock;
+        H5Fclose(File);
+        return;
+    }
+
+    // Read selected point and cell data arrays
+    vtkSmartPointer<vtkPointData> InputPointData = \
+            vtkSmartPointer<vtkPointData>::New();
+    vtkSmartPointer<vtkCellData> InputCellData = \
+            vtkSmartPointer<vtkCellData>::New();
+    vtkDataSetAttributes *InputData[2] = {InputPointData,InputCellData};
+    bool ReadAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    const char *GroupNames[2] = {"PointData","CellData"};
+    const std::vector<ArrayHeader> *Arrays[2] = {
+        &Piece.PointArrays,&Piece.CellArrays};
+    int NoStride[3] = {1,1,1};
+
+    // All rows of unstructured data
+    unsigned long long ReadRows[2][2] = {
+        {0,Layout.NumberOfRows[0]},{0,Layout.NumberOfRows[1]}};
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(ReadAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        ReadHDFAttributeArrays(
+                File,
+                InputFilename,
+                GroupNames[AttributeIterator],
+                *Arrays[AttributeIterator],
+                Structured == true ? Reader.DataExtents[AttributeIterator] :
+                                     NULL,
+                Structured == true ? Layout.RowExtents[AttributeIterator] :
+                                     NULL,
+                ReadRows[AttributeIterator],
+                Options.Stride,
+                Options,
+                InputData[AttributeIterator]);
+    }
+
+    // Points of unstructured data
+    vtkSmartPointer<vtkDataArray> InputPoints;
+    if(Options.WritePoints == true && Options.WritePointData == true)
+    {
+        InputPoints = vtkSmartPointer<vtkDataArray>::Take(
+                vtkDataArray::CreateDataArray(Piece.Points.DataType));
+        ReadHDFDataset(File,InputFilename,"Points",Piece.Points,
+                Structured == true ? Reader.DataExtents[0] : NULL,
+                Structured == true ? Layout.RowExtents[0] : NULL,
+                ReadRows[0],NoStride,InputPoints);
+    }
+
+    if(Structured == true)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Geometry.Extent[i] = Layout.RowExtents[0][i];
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Geometry.Stride[i] = Options.Stride[i];
+        }
+    }
+
+    H5Fclose(File);
+    Lock.Release();
+
+    // Write to output file
+    WriteAttributesToOutputFiles(
+            InputPointData,
+            InputCellData,
+            InputPoints,
+            Structured == true ? &Geometry : NULL,
+            OutputFilename,
+            Options);
+}
+
+// =============
+// Read HDF Slab
+// =============
+
+// Description:
+// Slab reader of the datasets of a VTKHDF file.
+
+void ReadHDFSlab(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry)                      // Output
+{
+    HDFSlabReader *Reader = static_cast<HDFSlabReader*>(SlabReader);
+    const ConversionOptions &Options = *Reader->Options;
+    HDFLibraryLock Lock;
+    const PieceHeader &Piece = Reader->Header->Pieces[0];
+    bool Structured = (Reader->Geometry != NULL);
+    int NoStride[3] = {1,1,1};
+
+    // Arrays of the slab
+    if(Attribute == 0)
+    {
+        Reader->InputData = vtkSmartPointer<vtkPointData>::New();
+    }
+    else
+    {
+        Reader->InputData = vtkSmartPointer<vtkCellData>::New();
+    }
+
+    ReadHDFAttributeArrays(
+            Reader->File,
+            Reader->InputFilename,
+            Attribute == 0 ? "PointData" : "CellData",
+            Attribute == 0 ? Piece.PointArrays : Piece.CellArrays,
+            Structured == true ? Reader->DataExtents[Attribute] : NULL,
+            SlabExtent,
+            SlabRows,
+            Options.Stride,
+            Options,
+            Reader->InputData);
+
+    SelectArrays(Reader->InputData,Options,SelectedArrays);
+
+    // Points of the slab
+    if(Attribute == 0 && Options.WritePoints == true)
+    {
+        Reader->InputPoints = vtkSmartPointer<vtkDataArray>::Take(
+                vtkDataArray::CreateDataArray(Piece.Points.DataType));
+        ReadHDFDataset(Reader->File,Reader->InputFilename,"Points",
+                Piece.Points,
+                Structured == true ? Reader->DataExtents[0] : NULL,
+                SlabExtent,SlabRows,NoStride,Reader->InputPoints);
+
+        SelectedArrays.push_back(Reader->InputPoints);
+    }
+
+    // Geometry of the slab
+    if(Reader->Geometry != NULL)
+    {
+        Geometry = *Reader->Geometry;
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Geometry.Extent[i] = SlabExtent[i];
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Geometry.Stride[i] = Options.Stride[i];
+        }
+    }
+}
+
+// =========================
+// Read HDF Attribute Arrays
+// =========================
+
+// Description:
+// Reads the selected datasets of the PointData or CellData group of a
+// VTKHDF file, in the same way as ReadAttributeArrays reads the arrays of
+// the other native readers.
+
+void ReadHDFAttributeArrays(
+        hid_t File,
+        const char *InputFilename,
+        const char *GroupName,
+        const std::vector<ArrayHeader> &Arrays,
+        const int *DataExtent,
+        const int *ReadExtent,
+        const unsigned long long *ReadRows,
+        const int Stride[3],
+        const ConversionOptions &Options,
+        vtkDataSetAttributes *InputData)      // Output
+{
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Arrays.size();
+        ArrayIterator++)
+    {
+        const ArrayHeader &Array = Arrays[ArrayIterator];
+        if(IsArraySelected(Array.Name,Options) == false)
+        {
+            continue;
+        }
+
+        vtkSmartPointer<vtkDataArray> InputDataArray = \
+                vtkSmartPointer<vtkDataArray>::Take(
+                        vtkDataArray::CreateDataArray(Array.DataType));
+
+        std::string DatasetName = std::string(GroupName) + "/" + Array.Name;
+        ReadHDFDataset(File,InputFilename,DatasetName.c_str(),Array,
+                DataExtent,ReadExtent,ReadRows,Stride,InputDataArray);
+
+        InputData->AddArray(InputDataArray);
+    }
+}
+
+// ================
+// Read HDF Dataset
+// ================
+
+// Description:
+// Reads the tuples in ReadExtent at the Stride of a dataset of the VTKHDF
+// group, which stores the tuples of DataExtent. The dimensions of the
+// dataset of image data are the k, j and i indices, followed by the
+// components if there is more than one, and those of unstructured data are
+// the tuples and the components. If DataExtent is NULL, the rows ReadRows
+// (first row and number of rows) of unstructured data are read instead.
+// The selection is a single hyperslab, so that HDF5 reads each chunk once,
+// through a chunk cache that holds the chunks of a slab.
+
+void ReadHDFDataset(
+        hid_t File,
+        const char *InputFilename,
+        const char *DatasetName,
+        const ArrayHeader &Array,
+        const int *DataExtent,
+        const int *ReadExtent,
+        const unsigned long long *ReadRows,
+        const int Stride[3],
+        vtkDataArray *InputDataArray)         // Output
+{
+    // First tuple and tuples in each direction
+    hsize_t Starts[3] = {0,0,0};
+    hsize_t Counts[3] = {1,1,1};
+    unsigned long long NumberOfTuples = 1;
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        if(DataExtent != NULL)
+        {
+            Starts[Dimension] = ReadExtent[2*Dimension] - \
+                                DataExtent[2*Dimension];
+            Counts[Dimension] = (ReadExtent[2*Dimension+1] -
+                    ReadExtent[2*Dimension]) / Stride[Dimension] + 1;
+        }
+        else if(Dimension == 0)
+        {
+            Starts[Dimension] = ReadRows[0];
+            Counts[Dimension] = ReadRows[1];
+        }
+        NumberOfTuples *= Counts[Dimension];
+    }
+
+    InputDataArray->SetName(Array.Name.c_str());
+    InputDataArray->SetNumberOfComponents(Array.NumberOfComponents);
+    InputDataArray->SetNumberOfTuples(NumberOfTuples);
+    if(NumberOfTuples * Array.NumberOfComponents == 0)
+    {
+        return;
+    }
+
+    hid_t AccessList = H5Pcreate(H5P_DATASET_ACCESS);
+    H5Pset_chunk_cache(AccessList,H5D_CHUNK_CACHE_NSLOTS_DEFAULT,
+            HDF_CHUNK_CACHE_SIZE,H5D_CHUNK_CACHE_W0_DEFAULT);
+
+    std::string DatasetPath = std::string("/VTKHDF/") + DatasetName;
+    hid_t Dataset = H5Dopen(File,DatasetPath.c_str(),AccessList);
+    hid_t FileSpace = Dataset < 0 ? -1 : H5Dget_space(Dataset);
+    herr_t Status = -1;
+
+    if(FileSpace >= 0)
+    {
+        // Hyperslab of the file, with the slowest dimension first
+        int Rank = H5Sget_simple_extent_ndims(FileSpace);
+        int TupleRank = (Rank >= 3 ? 3 : 1);
+        hsize_t Start[4] = {0,0,0,0};
+        hsize_t Step[4] = {1,1,1,1};
+        hsize_t Count[4] = {1,1,1,1};
+
+        for(int RankIterator = 0; RankIterator < TupleRank; RankIterator++)
+        {
+            int Dimension = TupleRank - 1 - RankIterator;
+            Start[RankIterator] = Starts[Dimension];
+            Step[RankIterator] = DataExtent != NULL ? Stride[Dimension] : 1;
+            Count[RankIterator] = Counts[Dimension];
+        }
+        if(Rank > TupleRank)
+        {
+            Count[TupleRank] = Array.NumberOfComponents;
+        }
+
+        hsize_t NumberOfValues = NumberOfTuples * Array.NumberOfComponents;
+        hid_t MemorySpace = H5Screate_simple(1,&NumberOfValues,NULL);
+
+        if(H5Sselect_hyperslab(FileSpace,H5S_SELECT_SET,Start,Step,Count,
+                    NULL) >= 0)
+        {
+            Status = H5Dread(Dataset,GetHDFMemoryType(Array.DataType),
+                    MemorySpace,FileSpace,H5P_DEFAULT,
+                    InputDataArray->GetVoidPointer(0));
+        }
+
+        H5Sclose(MemorySpace);
+        H5Sclose(FileSpace);
+    }
+
+    if(Dataset >= 0)
+    {
+        H5Dclose(Dataset);
+    }
+    H5Pclose(AccessList);
+
+    if(Status < 0)
+    {
+        std::cerr << "Can not read array " << Array.Name;
+        std::cerr << " from: " << InputFilename << std::endl;
+        throw ConversionError();
+    }
+}
+
+// ===================
+// Get HDF Memory Type
+// ===================
+
+// Description:
+// The HDF5 type of the values of a VTK array in memory, to which HDF5
+// converts the values of the file.
+
+hid_t GetHDFMemoryType(int DataType)
+{
+    switch(DataType)
+    {
+        case VTK_CHAR: return H5T_NATIVE_CHAR;
+        case VTK_SIGNED_CHAR: return H5T_NATIVE_SCHAR;
+        case VTK_UNSIGNED_CHAR: return H5T_NATIVE_UCHAR;
+        case VTK_SHORT: return H5T_NATIVE_SHORT;
+        case VTK_UNSIGNED_SHORT: return H5T_NATIVE_USHORT;
+        case VTK_INT: return H5T_NATIVE_INT;
+        case VTK_UNSIGNED_INT: return H5T_NATIVE_UINT;
+        case VTK_LONG: return H5T_NATIVE_LONG;
+        case VTK_UNSIGNED_LONG: return H5T_NATIVE_ULONG;
+        case VTK_LONG_LONG: return H5T_NATIVE_LLONG;
+        case VTK_UNSIGNED_LONG_LONG: return H5T_NATIVE_ULLONG;
+        case VTK_FLOAT: return H5T_NATIVE_FLOAT;
+        case VTK_DOUBLE: return H5T_NATIVE_DOUBLE;
+        default: return H5T_NATIVE_DOUBLE;
+    }
+}
+
+// ===========================================
+// Read VTKHDF Input File Write To Output File
+// ===========================================
+
+// Description:
+// Reads a VTKHDF file with vtkHDFReader, such as to write the cells of
+// unstructured data, or files that the native reader does not read.
+// vtkHDFReader is only built with VTK 9.1 or later with the IOHDF module.
+
+void ReadVTKHDFInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+#ifndef HAVE_VTK_HDF_READER
+    std::cerr << "This VTKHDF file, or --topology, needs vtkHDFReader, ";
+    std::cerr << "which is not in this build of VTK: " << InputFilename;
+    std::cerr << std::endl;
+    throw ConversionError();
+#else
+    HDFLibraryLock Lock;
+    vtkSmartPointer<vtkHDFReader> HDFReader = \
+            vtkSmartPointer<vtkHDFReader>::New();
+    if(HDFReader->CanReadFile(InputFilename) == 0)
+    {
+        std::cerr << "Not a VTKHDF file: " << InputFilename << std::endl;
+        throw ConversionError();
+    }
+
+    HDFReader->SetFileName(InputFilename);
+    SelectReaderArrays(
+            HDFReader->GetPointDataArraySelection(),
+            HDFReader->GetCellDataArraySelection(),
+            Options);
+
+    if(Options.MemoryLimit > 0)
+    {
+        std::cerr << "Warning: --memory-limit is not available with ";
+        std::cerr << "--topology for VTKHDF files. The whole dataset is ";
+        std::cerr << "read." << std::endl;
+    }
+
+    HDFReader->Update();
+
+    vtkSmartPointer<vtkDataSet> InputDataSet = vtkDataSet::SafeDownCast(
+            HDFReader->GetOutputDataObject(0));
+    if(InputDataSet == NULL)
+    {
+        std::cerr << "Can not read dataset of VTKHDF file: ";
+        std::cerr << InputFilename << std::endl;
+        throw ConversionError();
+    }
+
+    // The reader closes the file when it is deleted
+    HDFReader = NULL;
+    Lock.Release();
+
+    // Write to output file
+    WriteDataSetToOutputFiles(InputDataSet,OutputFilename,Options);
+#endif
+}
+
+// ========================
+// Can Read Parallel Pieces
+// ========================
+
+// Description:
+// The pieces of a partitioned file are converted in parallel if each row
+// of the binary output has a fixed size, such that each piece can be
+// written at its own offset. ASCII output and cells are left to the VTK
+// parallel readers, which merge all pieces.
+
+bool CanReadParallelPieces(
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    return Options.BinaryOutputFile == true &&
+           Options.SequentialOutputFile == false &&
+           Options.WriteTopology == false &&
+           Header.Pieces.empty() == false;
+}
+
+// =========================================
+// Read Parallel Pieces Write To Output File
+// =========================================
+
+// Description:
+// Reader of partitioned files, such as PVTI, PVTP and PVTU files, whose
+// header scan has found the number of tuples of each piece file. The piece
+// files are read and written concurrently by a pool of threads.
+
+void ReadParallelPiecesWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    ImageGeometry Geometry;
+    bool Structured = (Header.DataSetType == "PImageData");
+    if(Structured == true)
+    {
+        GetHeaderImageGeometry(Header,Geometry);
+    }
+
+    WritePiecesToOutputFiles(
+            InputFilename,
+            Header,
+            Structured == true ? &Geometry : NULL,
+            OutputFilename,
+            Options);
+}
+
+// ======================================
+// Read Multi Block Write To Output Files
+// ======================================
+
+// Description:
+// Reader of multiblock files (VTM), whose blocks are separate dataset files,
+// such as VTU or VTI files. Each block file is converted with the reader of
+// its own file type, by a pool of threads in this process, such that the
+// blocks are converted concurrently without starting a process per block.
+//
+// By default, the output of each block is written to OutputFileName.block0.raw,
+// OutputFileName.block1.raw, etc. With --concatenate-blocks, the rows of all
+// blocks are written to one output file in the order of the blocks, and the
+// first row and the number of rows of each block are written to the table
+// OutputFileName.blocks.txt. The blocks should then have the same selected
+// arrays, which is checked from their headers before any data is read. The
+// rows of each block are also found from its header, such that the binary
+// output of a block is written in place, to its region of the output file.
+// The rows of ASCII output have no fixed size, and a named pipe or a device
+// can not be seeked, so ASCII blocks, and blocks written to a pipe, are
+// written to files of their own, which are then appended to the output.
+
+struct BlockConversion
+{
+    const FileHeader *Header;
+    ConversionOptions Options;           // Options of each block
+    std::vector<std::string> OutputFilenames;   // Output of each block
+    std::vector<unsigned long long> RegionOffsets[2];  // Concatenated binary:
+    std::vector<unsigned long long> RegionSizes[2];    // region of each block
+    std::streambuf *MessageBuffer;       // Messages of each block, or NULL
+                                         // to discard them
+    std::atomic<unsigned int> NextBlock;
+    std::atomic<bool> Failed;            // A thread has thrown an error
+};
+
+void ReadMultiBlockWriteToOutputFiles(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    FileHeader MultiBlockHeader = Header;
+    if(MultiBlockHeader.Blocks.empty() == true &&
+       ScanMultiBlockFileHeader(InputFilename,MultiBlockHeader) == false)
+    {
+        std::cerr << "Can not read multiblock file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    const std::vector<BlockHeader> &Blocks = MultiBlockHeader.Blocks;
+    unsigned int NumberOfBlocks = Blocks.size();
+    unsigned int NumberOfThreads = GetNumberOfThreads(Options,NumberOfBlocks);
+
+    if(strcmp(OutputFilename,STANDARD_OUTPUT) == 0 ||
+       Options.SharedMemoryOutput == true)
+    {
+        std::cerr << "The blocks of a multiblock file can not be written to ";
+        std::cerr << "the standard output or to shared memory." << std::endl;
+        throw ConversionError();
+    }
+
+    // Blocks are concatenated only if they have the same columns
+    std::vector<unsigned long long> FirstRows[2];
+    std::vector<unsigned long long> NumberOfRows[2];
+    unsigned int NumberOfColumns[2] = {0,0};
+    if(Options.ConcatenateBlocks == true)
+    {
+        if(Options.WriteTopology == true)
+        {
+            std::cerr << "Option --topology can not be used with ";
+            std::cerr << "--concatenate-blocks." << std::endl;
+            throw ConversionError();
+        }
+
+        GetBlockLayout(MultiBlockHeader,Options,FirstRows,NumberOfRows,
+                NumberOfColumns);
+    }
+    bool InPlace = (Options.ConcatenateBlocks == true &&
+            Options.BinaryOutputFile == true &&
+            Options.SequentialOutputFile == false);
+
+    // Output of each block
+    BlockConversion Conversion;
+    Conversion.Header = &MultiBlockHeader;
+    Conversion.Options = Options;
+    Conversion.Options.SequentialOutputFile = false;
+    Conversion.NextBlock = 0;
+    Conversion.Failed = false;
+
+    // The concatenated binary output is sized to the rows of all blocks,
+    // which the threads open again to write
+    bool WriteAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    bool WriteBothAttributes = (WriteAttribute[0] && WriteAttribute[1]);
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2 && InPlace == true;
+        AttributeIterator++)
+    {
+        if(WriteAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        std::string AttributeOutputFilename(OutputFilename);
+        if(WriteBothAttributes == true && AttributeIterator == 1)
+        {
+            AttributeOutputFilename = MakeDerivedFilename(
+                    OutputFilename,"cell");
+        }
+
+        unsigned long long RowSize = \
+            NumberOfColumns[AttributeIterator] * sizeof(double);
+        unsigned long long OutputSize = 0;
+        for(unsigned int BlockIterator = 0;
+            BlockIterator < NumberOfBlocks;
+            BlockIterator++)
+        {
+            Conversion.RegionOffsets[AttributeIterator].push_back(
+                    FirstRows[AttributeIterator][BlockIterator] * RowSize);
+            Conversion.RegionSizes[AttributeIterator].push_back(
+                    NumberOfRows[AttributeIterator][BlockIterator] * RowSize);
+            OutputSize += Conversion.RegionSizes[AttributeIterator].back();
+        }
+
+        OutputFileStream OutputFile;
+        OpenFile(AttributeOutputFilename.c_str(),true,OutputFile);
+        OutputFile.close();
+
+        if(truncate(AttributeOutputFilename.c_str(),OutputSize) != 0)
+        {
+            std::cerr << "Can not allocate output file: ";
+            std::cerr << AttributeOutputFilename << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    // Pieces of a block are converted by the thread of the block
+    if(NumberOfThreads > 1)
+    {
+        Conversion.Options.NumberOfThreads = 1;
+    }
+
+    for(unsigned int BlockIterator = 0;
+        BlockIterator < NumberOfBlocks;
+        BlockIterator++)
+    {
+        std::ostringstream Suffix;
+        Suffix << "block" << BlockIterator;
+        Conversion.OutputFilenames.push_back(InPlace == true ?
+                std::string(OutputFilename) :
+                MakeDerivedFilename(OutputFilename,Suffix.str()));
+
+        Messages << "Block: " << BlockIterator << ", Name: ";
+        Messages << Blocks[BlockIterator].Name << ", File: ";
+        Messages << Blocks[BlockIterator].Filename;
+        if(Options.ConcatenateBlocks == false)
+        {
+            Messages << ", Output: ";
+            Messages << Conversion.OutputFilenames[BlockIterator];
+        }
+        Messages << std::endl;
+    }
+    Messages << "Blocks: " << NumberOfBlocks << ", Threads: ";
+    Messages << NumberOfThreads << std::endl;
+
+    // Messages of blocks that are converted at the same time would be mixed
+    Conversion.MessageBuffer = (NumberOfThreads > 1 ?
+            NULL : Messages.rdbuf());
+
+    // Pool of threads
+    std::vector<std::thread> Threads;
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < NumberOfThreads;
+        ThreadIterator++)
+    {
+        Threads.push_back(std::thread(ConvertBlocksOnThread,&Conversion));
+    }
+
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < NumberOfThreads;
+        ThreadIterator++)
+    {
+        Threads[ThreadIterator].join();
+    }
+
+    // The error of a block was printed by its thread
+    if(Conversion.Failed == true)
+    {
+        throw ConversionError();
+    }
+
+    if(Options.ConcatenateBlocks == true)
+    {
+        ConcatenateBlockFiles(
+                MultiBlockHeader,
+                Conversion.OutputFilenames,
+                NumberOfColumns,
+                OutputFilename,
+                Options,
+                FirstRows,
+                NumberOfRows);
+    }
+    else
+    {
+        Messages << NumberOfBlocks << " blocks were written." << std::endl;
+    }
+}
+
+// ========================
+// Convert Blocks On Thread
+// ========================
+
+// Description:
+// One thread of the pool. Each thread takes the next block that is not yet
+// converted, until all blocks are converted.
+
+void ConvertBlocksOnThread(BlockConversion *Conversion)
+{
+    std::ostream Messages(Conversion->MessageBuffer);
+    SetMessageStream(&Messages);
+
+    try
+    {
+        const std::vector<BlockHeader> &Blocks = Conversion->Header->Blocks;
+        for(unsigned int BlockIndex = Conversion->NextBlock++;
+            BlockIndex < Blocks.size() && Conversion->Failed == false;
+            BlockIndex = Conversion->NextBlock++)
+        {
+            // A concatenated binary block is written to its regions of the
+            // output, where the region of the cell data is selected by the
+            // writers of --point-and-cell-data
+            ConversionOptions BlockOptions = Conversion->Options;
+            for(unsigned int AttributeIterator = 0;
+                AttributeIterator < 2;
+                AttributeIterator++)
+            {
+                if(Conversion->RegionSizes[AttributeIterator].empty() == true)
+                {
+                    continue;
+                }
+
+                unsigned long long Offset = \
+                    Conversion->RegionOffsets[AttributeIterator][BlockIndex];
+                unsigned long long Size = \
+                    Conversion->RegionSizes[AttributeIterator][BlockIndex];
+                BlockOptions.RegionOutput = true;
+                if(AttributeIterator == 1 &&
+                   BlockOptions.WritePointData == true)
+                {
+                    BlockOptions.CellRegionOffset = Offset;
+                    BlockOptions.CellRegionSize = Size;
+                }
+                else
+                {
+                    BlockOptions.RegionOffset = Offset;
+                    BlockOptions.RegionSize = Size;
+                }
+            }
+
+            ReadDataSetWriteToOutput(
+                    Blocks[BlockIndex].Filename.c_str(),
+                    Conversion->OutputFilenames[BlockIndex].c_str(),
+                    BlockOptions);
+        }
+    }
+    catch(const ConversionError &)
+    {
+        Conversion->Failed = true;
+    }
+}
+
+// ================
+// Have Same Arrays
+// ================
+
+// Description:
+// True if two lists of array headers have the same names and number of
+// components, in the same order, such that their rows can be written to
+// the same output matrix.
+
+bool HaveSameArrays(
+        const std::vector<ArrayHeader> &Arrays,
+        const std::vector<ArrayHeader> &OtherArrays)
+{
+    if(Arrays.size() != OtherArrays.size())
+    {
+        return false;
+    }
+
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Arrays.size();
+        ArrayIterator++)
+    {
+        if(Arrays[ArrayIterator].Name != OtherArrays[ArrayIterator].Name ||
+           Arrays[ArrayIterator].NumberOfComponents != \
+               OtherArrays[ArrayIterator].NumberOfComponents)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ================
+// Get Output Shape
+// ================
+
+// Description:
+// The selected arrays of the point (Attribute 0) or cell (Attribute 1) data
+// of a dataset file, and the number of rows and columns of its output, found
+// from the header of the file before any data is read.
+//
+// The rows of image data are the points or cells of the --extent, --slice
+// and --stride of the whole extent, or of the piece of a VTI file of one
+// piece. The rows of other datasets are the tuples of all pieces.
+//
+// Structured and rectilinear grids have an extent too, but the legacy
+// readers write all their points, while the XML readers of VTK crop them
+// to the --extent. Their rows are not known from the header for a
+// sub-volume, so --extent, --slice and --stride are rejected for them.
+
+bool GetOutputShape(
+        const char *InputFilename,
+        unsigned int Attribute,
+        const ConversionOptions &Options,
+        std::vector<ArrayHeader> &SelectedArrays,   // Output
+        unsigned long long &NumberOfRows,           // Output
+        unsigned int &NumberOfColumns)              // Output
+{
+    std::string DataSetType;
+    InputFileType FileType = DetectInputFileType(InputFilename,DataSetType);
+
+    FileHeader Header;
+    if(FileType == NUMBER_OF_INPUT_FILE_TYPES ||
+       ScanFileHeader(InputFilename,FileType,Header) == false ||
+       Header.Pieces.empty() == true)
+    {
+        return false;
+    }
+
+    const PieceHeader &Piece = Header.Pieces[0];
+    GetSelectedArrayHeaders(
+            Attribute == 0 ? Piece.PointArrays : Piece.CellArrays,
+            Options,
+            SelectedArrays);
+
+    // Sub-volume of grids that are not image data
+    bool SubVolume = (Options.ExtractExtent == true ||
+            Options.Stride[0] > 1 || Options.Stride[1] > 1 ||
+            Options.Stride[2] > 1);
+    if(SubVolume == true &&
+       (Header.DataSetType == "STRUCTURED_GRID" ||
+        Header.DataSetType == "RECTILINEAR_GRID" ||
+        Header.DataSetType == "StructuredGrid" ||
+        Header.DataSetType == "RectilinearGrid" ||
+        Header.DataSetType == "PStructuredGrid" ||
+        Header.DataSetType == "PRectilinearGrid"))
+    {
+        std::cerr << "--extent, --slice and --stride are only available ";
+        std::cerr << "for image data, not for the " << Header.DataSetType;
+        std::cerr << " of: " << InputFilename << std::endl;
+        throw ConversionError();
+    }
+
+    // Rows
+    NumberOfRows = 0;
+    if(Header.DataSetType == "STRUCTURED_POINTS" ||
+       Header.DataSetType == "ImageData" ||
+       Header.DataSetType == "PImageData")
+    {
+        ImageGeometry Geometry;
+        GetHeaderImageGeometry(Header,Geometry);
+        if(Header.DataSetType == "ImageData" && Header.Pieces.size() == 1)
+        {
+            std::copy(Piece.Extent,Piece.Extent+6,Geometry.Extent);
+        }
+
+        int RowExtent[6];
+        GetExtractExtent(Geometry.Extent,Options,RowExtent);
+        if(Attribute == 1)
+        {
+            int PointExtent[6];
+            std::copy(RowExtent,RowExtent+6,PointExtent);
+            GetCellExtent(PointExtent,Geometry.Extent,RowExtent);
+            AlignExtentToStride(RowExtent,Options.Stride);
+        }
+        NumberOfRows = GetNumberOfExtentTuples(RowExtent,Options.Stride);
+    }
+    else
+    {
+        for(unsigned int PieceIterator = 0;
+            PieceIterator < Header.Pieces.size();
+            PieceIterator++)
+        {
+            const PieceHeader &RowPiece = Header.Pieces[PieceIterator];
+            const std::vector<ArrayHeader> &Arrays = (Attribute == 0 ?
+                    RowPiece.PointArrays : RowPiece.CellArrays);
+            if(Arrays.empty() == false)
+            {
+                NumberOfRows += Arrays[0].NumberOfTuples;
+            }
+            else
+            {
+                NumberOfRows += (Attribute == 0 ?
+                        RowPiece.NumberOfPoints : RowPiece.NumberOfCells);
+            }
+        }
+    }
+
+    NumberOfColumns = 0;
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < SelectedArrays.size();
+        ArrayIterator++)
+    {
+        NumberOfColumns += SelectedArrays[ArrayIterator].NumberOfComponents;
+    }
+
+    // Columns that are not arrays of the file
+    if(Attribute == 0 && Options.WritePoints == true)
+    {
+        NumberOfColumns += 3;
+    }
+    if(Attribute == 0 && Options.Coordinates != COORDINATES_NONE)
+    {
+        NumberOfColumns += 3;
+    }
+
+    return true;
+}
+
+// ================
+// Get Block Layout
+// ================
+
+// Description:
+// Checks from the headers of the blocks of a multiblock file that they have
+// the same selected arrays, such that they can be concatenated, and finds
+// the first row and the number of rows of each block in the concatenated
+// output of the point data and of the cell data.
+
+void GetBlockLayout(
+        const FileHeader &Header,
+        const ConversionOptions &Options,
+        std::vector<unsigned long long> FirstRows[2],
+        std::vector<unsigned long long> NumberOfRows[2],
+        unsigned int NumberOfColumns[2])
+{
+    bool WriteAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    const char *AttributeNames[2] = {"point","cell"};
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(WriteAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        std::vector<ArrayHeader> FirstArrays;
+        unsigned long long FirstRow = 0;
+        for(unsigned int BlockIterator = 0;
+            BlockIterator < Header.Blocks.size();
+            BlockIterator++)
+        {
+            std::vector<ArrayHeader> Arrays;
+            unsigned long long Rows = 0;
+            unsigned int Columns = 0;
+            if(GetOutputShape(
+                        Header.Blocks[BlockIterator].Filename.c_str(),
+                        AttributeIterator,Options,Arrays,Rows,
+                        Columns) == false)
+            {
+                std::cerr << "Can not read block file: ";
+                std::cerr << Header.Blocks[BlockIterator].Filename;
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+
+            // A block without columns has no rows to write
+            if(Columns == 0)
+            {
+                Rows = 0;
+            }
+
+            FirstRows[AttributeIterator].push_back(FirstRow);
+            NumberOfRows[AttributeIterator].push_back(Rows);
+            FirstRow += Rows;
+
+            if(BlockIterator == 0)
+            {
+                FirstArrays = Arrays;
+                NumberOfColumns[AttributeIterator] = Columns;
+                continue;
+            }
+
+            if(Columns != NumberOfColumns[AttributeIterator] ||
+               HaveSameArrays(Arrays,FirstArrays) == false)
+            {
+                std::cerr << "Blocks can not be concatenated: block ";
+                std::cerr << BlockIterator << " has other ";
+                std::cerr << AttributeNames[AttributeIterator];
+                std::cerr << " data arrays than block 0." << std::endl;
+                throw ConversionError();
+            }
+        }
+    }
+}
+
+// ==================
+// Select Cell Region
+// ==================
+
+// Description:
+// The cell data of --point-and-cell-data is written to a file of its own,
+// whose region is given separately from the region of the point data.
+
+void SelectCellRegion(ConversionOptions &Options)
+{
+    Options.RegionOffset = Options.CellRegionOffset;
+    Options.RegionSize = Options.CellRegionSize;
+}
+
+// =======================
+// Concatenate Block Files
+// =======================
+
+// Description:
+// Binary blocks are already written in place to an output file, at the rows
+// of the layout of the blocks. ASCII blocks, and blocks written to a pipe,
+// are appended to the output in the order of the blocks, and removed. Their
+// rows are counted from the size of binary output, or from the lines of
+// ASCII output, which has no new line after its last row. The
+// table of blocks has one line per block, with the first row and the number
+// of rows of the point data, and of the cell data if both are written,
+// followed by the name and the file of the block, separated by tabs.
+
+void ConcatenateBlockFiles(
+        const FileHeader &Header,
+        const std::vector<std::string> &BlockOutputFilenames,
+        const unsigned int NumberOfColumns[2],
+        const char *OutputFilename,
+        const ConversionOptions &Options,
+        std::vector<unsigned long long> FirstRows[2],
+        std::vector<unsigned long long> NumberOfRows[2])
+{
+    std::ostream &Messages = GetMessageStream();
+
+    bool WriteAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    bool WriteBothAttributes = (WriteAttribute[0] && WriteAttribute[1]);
+    const char *ColumnNames[2] = {"Row","CellRow"};
+    unsigned int NumberOfBlocks = Header.Blocks.size();
+
+    std::vector<char> Buffer(BUFFER_SIZE);
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(WriteAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        std::string AttributeOutputFilename(OutputFilename);
+        if(WriteBothAttributes == true && AttributeIterator == 1)
+        {
+            AttributeOutputFilename = MakeDerivedFilename(
+                    OutputFilename,"cell");
+        }
+
+        unsigned long long Row = 0;
+        if(Options.BinaryOutputFile == true &&
+           Options.SequentialOutputFile == false)
+        {
+            for(unsigned int BlockIterator = 0;
+                BlockIterator < NumberOfBlocks;
+                BlockIterator++)
+            {
+                Row += NumberOfRows[AttributeIterator][BlockIterator];
+            }
+        }
+        else
+        {
+            FirstRows[AttributeIterator].clear();
+            NumberOfRows[AttributeIterator].clear();
+
+            OutputFileStream OutputFile;
+            OpenFile(AttributeOutputFilename.c_str(),true,OutputFile);
+
+            for(unsigned int BlockIterator = 0;
+                BlockIterator < NumberOfBlocks;
+                BlockIterator++)
+            {
+                std::string BlockOutputFilename = \
+                    BlockOutputFilenames[BlockIterator];
+                if(WriteBothAttributes == true && AttributeIterator == 1)
+                {
+                    BlockOutputFilename = MakeDerivedFilename(
+                            BlockOutputFilename,"cell");
+                }
+
+                // A block without arrays to write has no output file
+                unsigned long long Bytes = 0;
+                unsigned long long Lines = 0;
+                std::ifstream BlockOutputFile(BlockOutputFilename.c_str(),
+                        std::ios::in | std::ios::binary);
+                if(BlockOutputFile.is_open() == true)
+                {
+                    while(BlockOutputFile.read(&Buffer[0],Buffer.size()) ||
+                          BlockOutputFile.gcount() > 0)
+                    {
+                        // ASCII rows are separated by new lines
+                        std::streamsize Count = BlockOutputFile.gcount();
+                        if(Options.BinaryOutputFile == false && Bytes == 0 &&
+                           Row > 0)
+                        {
+                            OutputFile << "\n";
+                        }
+
+                        OutputFile.write(&Buffer[0],Count);
+                        Bytes += Count;
+                        Lines += std::count(&Buffer[0],&Buffer[0]+Count,
+                                '\n');
+                    }
+
+                    BlockOutputFile.close();
+                    std::remove(BlockOutputFilename.c_str());
+                }
+
+                unsigned long long Rows = Bytes > 0 ? Lines + 1 : 0;
+                if(Options.BinaryOutputFile == true)
+                {
+                    Rows = NumberOfColumns[AttributeIterator] == 0 ? 0 :
+                        Bytes / (NumberOfColumns[AttributeIterator] *
+                                sizeof(double));
+                }
+
+                FirstRows[AttributeIterator].push_back(Row);
+                NumberOfRows[AttributeIterator].push_back(Rows);
+                Row += Rows;
+            }
+
+            if(OutputFile.good() != true)
+            {
+                std::cerr << "Can not write to output file." << std::endl;
+                throw ConversionError();
+            }
+            OutputFile.close();
+        }
+
+        Messages << NumberOfBlocks << " blocks were written to: ";
+        Messages << AttributeOutputFilename << "." << std::endl;
+        Messages << "Rows: " << Row << ", Columns: ";
+        Messages << NumberOfColumns[AttributeIterator] << "." << std::endl;
+    }
+
+    // Table of blocks
+    std::string IndexFilename = MakeTableFilename(OutputFilename,"blocks");
+
+    OutputFileStream IndexFile;
+    OpenFile(IndexFilename.c_str(),false,IndexFile);
+
+    IndexFile << "Block";
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(FirstRows[AttributeIterator].empty() == false)
+        {
+            const char *ColumnName = WriteBothAttributes == true ?
+                ColumnNames[AttributeIterator] : ColumnNames[0];
+            IndexFile << "\tFirst" << ColumnName;
+            IndexFile << "\tNumberOf" << ColumnName << "s";
+        }
+    }
+    IndexFile << "\tName\tFile\n";
+
+    for(unsigned int BlockIterator = 0;
+        BlockIterator < NumberOfBlocks;
+        BlockIterator++)
+    {
+        IndexFile << BlockIterator;
+        for(unsigned int AttributeIterator = 0;
+            AttributeIterator < 2;
+            AttributeIterator++)
+        {
+            if(FirstRows[AttributeIterator].empty() == false)
+            {
+                IndexFile << "\t";
+                IndexFile << FirstRows[AttributeIterator][BlockIterator];
+                IndexFile << "\t";
+                IndexFile << NumberOfRows[AttributeIterator][BlockIterator];
+            }
+        }
+        IndexFile << "\t" << Header.Blocks[BlockIterator].Name;
+        IndexFile << "\t" << Header.Blocks[BlockIterator].Filename << "\n";
+    }
+
+    if(IndexFile.good() != true)
+    {
+        std::cerr << "Can not write to output file: " << IndexFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    Messages << "Table of blocks was written to: " << IndexFilename << ".";
+    Messages << std::endl;
+}
+
+// ======================================
+// Read Time Series Write To Output Files
+// ======================================
+
+// Description:
+// Reader of time series files (PVD), whose time steps are separate dataset
+// files, such as a VTU or VTI file per time step. The output of each time
+// step is written to OutputFileName.step0.raw, OutputFileName.step1.raw,
+// etc, in the order of the time values, and a tab separated table of the
+// time value, part, input file and output file of each step is written to
+// OutputFileName.steps.txt.
+//
+// The time steps are converted in order by a pipeline: while one time step
+// is written, the next --prefetch time steps are already read and
+// converted by other threads. Each thread takes the next time step as soon
+// as its own is written, so at most 1 + --prefetch time steps are in
+// memory at any time, regardless of the length of the series. The threads
+// of --threads are shared by the time steps in flight, for their pieces.
+//
+// With --stack-time-steps, all time steps are written to one binary output
+// file of shape (time steps, rows, columns), in which time step t is the
+// frame at byte t x frame bytes. The rows and columns of the frames are
+// found from the headers of all time steps before any data is read, which
+// should be the same for all time steps. The output file is sized first,
+// and each thread writes its time step directly into its own frame, so the
+// frames are written concurrently, in any order. The byte offset of each
+// frame is added to the table of time steps.
+
+struct TimeSeriesConversion
+{
+    const FileHeader *Header;
+    ConversionOptions Options;           // Options of each time step
+    std::vector<std::string> OutputFilenames;   // Output of each step
+    unsigned long long FrameSize;        // Stacked: bytes of a time step
+    std::atomic<unsigned int> NextStep;
+    std::atomic<bool> Failed;            // A thread has thrown an error
+    std::streambuf *MessageBuffer;       // Messages of each time step, or
+                                         // NULL to discard them
+    unsigned int NumberOfConvertedSteps;
+    std::mutex LogMutex;                 // Guards Log and the count
+    std::ostream *Log;
+};
+
+void ReadTimeSeriesWriteToOutputFiles(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    FileHeader TimeSeriesHeader = Header;
+    if(TimeSeriesHeader.TimeSteps.empty() == true &&
+       ScanTimeSeriesFileHeader(InputFilename,TimeSeriesHeader) == false)
+    {
+        std::cerr << "Can not read time series file: " << InputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    if(strcmp(OutputFilename,STANDARD_OUTPUT) == 0 ||
+       Options.SharedMemoryOutput == true)
+    {
+        std::cerr << "The time steps of a time series file can not be ";
+        std::cerr << "written to the standard output or to shared memory.";
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    const std::vector<TimeStepHeader> &TimeSteps = TimeSeriesHeader.TimeSteps;
+    unsigned int NumberOfSteps = TimeSteps.size();
+
+    // A frame holds one time step, so the parts of a time step, which are
+    // listed as separate files with the same time value, can not be stacked
+    if(Options.StackTimeSteps == true)
+    {
+        for(unsigned int StepIterator = 1;
+            StepIterator < NumberOfSteps;
+            StepIterator++)
+        {
+            if(TimeSteps[StepIterator].TimeValue ==
+               TimeSteps[StepIterator-1].TimeValue ||
+               TimeSteps[StepIterator].Part != TimeSteps[0].Part)
+            {
+                std::cerr << "The time steps of " << InputFilename;
+                std::cerr << " have several parts, which can not be ";
+                std::cerr << "stacked." << std::endl;
+                throw ConversionError();
+            }
+        }
+    }
+
+    // Shape of the frames of stacked time steps
+    unsigned long long NumberOfFrameRows = 0;
+    unsigned int NumberOfFrameColumns = 0;
+    if(Options.StackTimeSteps == true)
+    {
+        GetTimeStepFrameShape(TimeSeriesHeader,Options,NumberOfFrameRows,
+                NumberOfFrameColumns);
+    }
+
+    // Time step in flight, and the threads of each for its pieces
+    unsigned int NumberOfPipelineThreads = std::min(
+            Options.NumberOfPrefetchedSteps + 1,NumberOfSteps);
+    unsigned int NumberOfThreads = GetNumberOfThreads(Options,
+            std::numeric_limits<unsigned int>::max());
+
+    TimeSeriesConversion Conversion;
+    Conversion.Header = &TimeSeriesHeader;
+    Conversion.Options = Options;
+    Conversion.Options.SequentialOutputFile = false;
+    Conversion.Options.NumberOfThreads = std::max(1U,
+            NumberOfThreads / NumberOfPipelineThreads);
+    Conversion.FrameSize = \
+        NumberOfFrameRows * NumberOfFrameColumns * sizeof(double);
+    Conversion.NextStep = 0;
+    Conversion.Failed = false;
+    Conversion.NumberOfConvertedSteps = 0;
+
+    for(unsigned int StepIterator = 0;
+        StepIterator < NumberOfSteps;
+        StepIterator++)
+    {
+        std::ostringstream Suffix;
+        Suffix << "step" << StepIterator;
+        Conversion.OutputFilenames.push_back(
+                Options.StackTimeSteps == true ? std::string(OutputFilename) :
+                MakeDerivedFilename(OutputFilename,Suffix.str()));
+    }
+
+    // The stacked output is sized to all frames, which the threads open
+    // again to write
+    if(Options.StackTimeSteps == true)
+    {
+        OutputFileStream OutputFile;
+        OpenFile(OutputFilename,true,OutputFile);
+        OutputFile.close();
+
+        if(truncate(OutputFilename,Conversion.FrameSize * NumberOfSteps) != 0)
+        {
+            std::cerr << "Can not allocate output file: " << OutputFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        Messages << "Frames: " << NumberOfSteps << ", Rows: ";
+        Messages << NumberOfFrameRows << ", Columns: ";
+        Messages << NumberOfFrameColumns << ", Frame bytes: ";
+        Messages << Conversion.FrameSize << std::endl;
+    }
+
+    Messages << "Time steps: " << NumberOfSteps << ", Prefetched steps: ";
+    Messages << NumberOfPipelineThreads - 1 << std::endl;
+
+    // Messages of time steps that are converted at the same time would be
+    // mixed, so only one line per time step is printed
+    Conversion.MessageBuffer = (NumberOfPipelineThreads > 1 ?
+            NULL : Messages.rdbuf());
+    Conversion.Log = &Messages;
+
+    // Pipeline of threads
+    std::vector<std::thread> Threads;
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < NumberOfPipelineThreads;
+        ThreadIterator++)
+    {
+        Threads.push_back(std::thread(ConvertTimeStepsOnThread,&Conversion));
+    }
+
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < NumberOfPipelineThreads;
+        ThreadIterator++)
+    {
+        Threads[ThreadIterator].join();
+    }
+
+    // The error of a time step was printed by its thread
+    if(Conversion.Failed == true)
+    {
+        throw ConversionError();
+    }
+
+    WriteTimeStepTable(TimeSeriesHeader,Conversion.OutputFilenames,
+            NumberOfFrameRows,NumberOfFrameColumns,OutputFilename);
+
+    Messages << NumberOfSteps << " time steps were written";
+    if(Options.StackTimeSteps == true)
+    {
+        Messages << " to: " << OutputFilename;
+    }
+    Messages << "." << std::endl;
+}
+
+// ============================
+// Convert Time Steps On Thread
+// ============================
+
+// Description:
+// One thread of the pipeline. Each thread takes the next time step that is
+// not yet converted, in the order of the time values, until all time steps
+// are converted.
+
+void ConvertTimeStepsOnThread(TimeSeriesConversion *Conversion)
+{
+    std::ostream Messages(Conversion->MessageBuffer);
+    SetMessageStream(&Messages);
+
+    try
+    {
+        const std::vector<TimeStepHeader> &TimeSteps = \
+            Conversion->Header->TimeSteps;
+        unsigned int NumberOfSteps = TimeSteps.size();
+
+        for(unsigned int StepIndex = Conversion->NextStep++;
+            StepIndex < NumberOfSteps && Conversion->Failed == false;
+            StepIndex = Conversion->NextStep++)
+        {
+            // A stacked time step is written to its frame
+            ConversionOptions StepOptions = Conversion->Options;
+            if(StepOptions.StackTimeSteps == true)
+            {
+                StepOptions.RegionOutput = true;
+                StepOptions.RegionOffset = StepIndex * Conversion->FrameSize;
+                StepOptions.RegionSize = Conversion->FrameSize;
+            }
+
+            ReadDataSetWriteToOutput(
+                    TimeSteps[StepIndex].Filename.c_str(),
+                    Conversion->OutputFilenames[StepIndex].c_str(),
+                    StepOptions);
+
+            std::lock_guard<std::mutex> Lock(Conversion->LogMutex);
+            Conversion->NumberOfConvertedSteps++;
+            *Conversion->Log << "Step " << StepIndex << ", Time: ";
+            *Conversion->Log << TimeSteps[StepIndex].TimeValue << ": ";
+            *Conversion->Log << TimeSteps[StepIndex].Filename << " -> ";
+            *Conversion->Log << Conversion->OutputFilenames[StepIndex];
+            *Conversion->Log << " (" << Conversion->NumberOfConvertedSteps;
+            *Conversion->Log << " of " << NumberOfSteps << ")" << std::endl;
+        }
+    }
+    catch(const ConversionError &)
+    {
+        Conversion->Failed = true;
+    }
+}
+
+// =========================
+// Get Time Step Frame Shape
+// =========================
+
+// Description:
+// The rows and columns of the frame of each time step in a stacked output,
+// found from the headers of the time step files. All time steps should
+// have the same selected arrays and the same number of rows, since the
+// frames of the output file have one size.
+
+void GetTimeStepFrameShape(
+        const FileHeader &Header,
+        const ConversionOptions &Options,
+        unsigned long long &NumberOfRows,     // Output
+        unsigned int &NumberOfColumns)        // Output
+{
+    if(Options.BinaryOutputFile == false || Options.WriteTopology == true ||
+       (Options.WritePointData == true && Options.WriteCellData == true))
+    {
+        std::cerr << "Option --stack-time-steps needs binary output, and ";
+        std::cerr << "can not be used with --point-and-cell-data or ";
+        std::cerr << "--topology." << std::endl;
+        throw ConversionError();
+    }
+
+    unsigned int Attribute = (Options.WritePointData == true ? 0 : 1);
+    std::vector<ArrayHeader> FirstArrays;
+
+    for(unsigned int StepIterator = 0;
+        StepIterator < Header.TimeSteps.size();
+        StepIterator++)
+    {
+        const std::string &StepFilename = \
+            Header.TimeSteps[StepIterator].Filename;
+
+        std::vector<ArrayHeader> Arrays;
+        unsigned long long Rows = 0;
+        unsigned int Columns = 0;
+        if(GetOutputShape(StepFilename.c_str(),Attribute,Options,Arrays,Rows,
+                    Columns) == false)
+        {
+            std::cerr << "Time steps can not be stacked: the rows of ";
+            std::cerr << StepFilename << " are not known from its header.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        if(StepIterator == 0)
+        {
+            FirstArrays = Arrays;
+            NumberOfRows = Rows;
+            NumberOfColumns = Columns;
+            continue;
+        }
+
+        if(Rows != NumberOfRows || Columns != NumberOfColumns ||
+           HaveSameArrays(Arrays,FirstArrays) == false)
+        {
+            std::cerr << "Time steps can not be stacked: time step ";
+            std::cerr << StepIterator << " has " << Rows << " rows and ";
+            std::cerr << Columns << " columns, or other arrays, instead of ";
+            std::cerr << "the " << NumberOfRows << " rows and ";
+            std::cerr << NumberOfColumns << " columns of time step 0.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    if(NumberOfRows == 0 || NumberOfColumns == 0)
+    {
+        std::cerr << "Time steps can not be stacked: time steps have no ";
+        std::cerr << "rows or no arrays to write." << std::endl;
+        throw ConversionError();
+    }
+}
+
+// =====================
+// Write Time Step Table
+// =====================
+
+// Description:
+// Writes the table of time steps to OutputFileName.steps.txt, one line
+// per time step, with the time values in full precision. For stacked time
+// steps, the output column is replaced by the byte offset of the frame of
+// each time step, and its rows and columns.
+
+void WriteTimeStepTable(
+        const FileHeader &Header,
+        const std::vector<std::string> &StepOutputFilenames,
+        unsigned long long NumberOfFrameRows,
+        unsigned int NumberOfFrameColumns,
+        const char *OutputFilename)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    bool Stacked = (NumberOfFrameRows > 0);
+    unsigned long long FrameSize = \
+        NumberOfFrameRows * NumberOfFrameColumns * sizeof(double);
+
+    std::string IndexFilename = MakeTableFilename(OutputFilename,"steps");
+
+    OutputFileStream IndexFile;
+    OpenFile(IndexFilename.c_str(),false,IndexFile);
+
+    // Time values are written with enough digits to be read back exactly
+    IndexFile << std::setprecision(std::numeric_limits<double>::max_digits10);
+    IndexFile << "Step\tTime\tPart\tFile";
+    IndexFile << (Stacked == true ? "\tOffset\tRows\tColumns\n" :
+                                    "\tOutput\n");
+    for(unsigned int StepIterator = 0;
+        StepIterator < Header.TimeSteps.size();
+        StepIterator++)
+    {
+        const TimeStepHeader &TimeStep = Header.TimeSteps[StepIterator];
+        IndexFile << StepIterator << "\t" << TimeStep.TimeValue << "\t";
+        IndexFile << TimeStep.Part << "\t" << TimeStep.Filename << "\t";
+        if(Stacked == true)
+        {
+            IndexFile << StepIterator * FrameSize << "\t";
+            IndexFile << NumberOfFrameRows << "\t";
+            IndexFile << NumberOfFrameColumns << "\n";
+        }
+        else
+        {
+            IndexFile << StepOutputFilenames[StepIterator] << "\n";
+        }
+    }
+
+    if(IndexFile.good() != true)
+    {
+        std::cerr << "Can not write to output file: " << IndexFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+    IndexFile.close();
+
+    Messages << "Table of time steps was written to: " << IndexFilename;
+    Messages << "." << std::endl;
+}
+
+// =============================
+// Write DataSet To Output Files
+// =============================
+
+// Description:
+// Writes the arrays of a dataset read by a VTK reader. The point coordinates
+// are taken from the vtkPoints of point sets (unstructured grid, polydata
+// and structured grid) without copying them. For image data, the extent,
+// origin and spacing are passed on, from which the writer can compute
+// implicit coordinates.
+
+void WriteDataSetToOutputFiles(
+        vtkDataSet *InputDataSet,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    // Point coordinates
+    vtkDataArray *InputPoints = NULL;
+    if(Options.WritePoints == true)
+    {
+        vtkPointSet *InputPointSet = vtkPointSet::SafeDownCast(InputDataSet);
+        if(InputPointSet == NULL || InputPointSet->GetPoints() == NULL)
+        {
+            std::cerr << "DataSet has no explicit point coordinates.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        InputPoints = InputPointSet->GetPoints()->GetData();
+    }
+
+    // Implicit geometry of image data
+    ImageGeometry Geometry;
+    vtkImageData *InputImageData = vtkImageData::SafeDownCast(InputDataSet);
+    if(InputImageData != NULL)
+    {
+        InputImageData->GetExtent(Geometry.Extent);
+        InputImageData->GetOrigin(Geometry.Origin);
+        InputImageData->GetSpacing(Geometry.Spacing);
+    }
+
+    // Point and cell data
+    WriteAttributesToOutputFiles(
+            InputDataSet->GetPointData(),
+            InputDataSet->GetCellData(),
+            InputPoints,
+            InputImageData != NULL ? &Geometry : NULL,
+            OutputFilename,
+            Options);
+
+    // Cells
+    if(Options.WriteTopology == true)
+    {
+        WriteTopologyToOutputFiles(InputDataSet,OutputFilename);
+    }
+}
+
+// ================================
+// Write Attributes To Output Files
+// ================================
+
+// Description:
+// Writes the point data, the cell data, or both, as the options request.
+// Cell data arrays go through the same writer as point data arrays, with one
+// row per cell. When both are written, the point data is written to the
+// output file, and the cell data to the output file name with ".cell"
+// inserted before its extension, such as OutputFile.cell.raw.
+//
+// With both attributes, a selected array needs to be found in only one of
+// them, and an attribute without any selected array is not written.
+//
+// If InputPoints is not NULL, the point coordinates are appended as the last
+// three columns of the point data. The Geometry of image data, or NULL, is
+// the geometry of the points. The cell data of image data is written with
+// the extent of the cells between the points, such that a sub-volume of
+// the points also selects the cells between them.
+
+void WriteAttributesToOutputFiles(
+        vtkDataSetAttributes *InputPointData,
+        vtkDataSetAttributes *InputCellData,
+        vtkDataArray *InputPoints,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    vtkDataSetAttributes *InputData[2] = {InputPointData,InputCellData};
+    bool WriteAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    const char *AttributeNames[2] = {"point","cell"};
+
+    // Output files
+    bool WriteBothAttributes = (WriteAttribute[0] && WriteAttribute[1]);
+    std::string OutputFilenames[2] = {OutputFilename,OutputFilename};
+    if(WriteBothAttributes == true)
+    {
+        OutputFilenames[1] = MakeDerivedFilename(OutputFilename,"cell");
+
+        for(unsigned int NameIterator = 0;
+            NameIterator < Options.ArrayNames.size();
+            NameIterator++)
+        {
+            const char *Name = Options.ArrayNames[NameIterator].c_str();
+            if(InputPointData->GetArray(Name) == NULL &&
+               InputCellData->GetArray(Name) == NULL)
+            {
+                std::cerr << "Array not found: " << Name << std::endl;
+                throw ConversionError();
+            }
+        }
+    }
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(WriteAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        std::vector<vtkDataArray*> SelectedArrays;
+        SelectArrays(InputData[AttributeIterator],Options,SelectedArrays);
+
+        if(AttributeIterator == 0 && InputPoints != NULL)
+        {
+            SelectedArrays.push_back(InputPoints);
+        }
+
+        if(WriteBothAttributes == true && SelectedArrays.empty() == true &&
+           (AttributeIterator == 1 || Options.Coordinates == COORDINATES_NONE))
+        {
+            Messages << "No " << AttributeNames[AttributeIterator];
+            Messages << " data arrays to write." << std::endl;
+            continue;
+        }
+
+        // Implicit coordinates are only for points
+        ConversionOptions AttributeOptions = Options;
+        if(WriteBothAttributes == true && AttributeIterator == 1)
+        {
+            AttributeOptions.Coordinates = COORDINATES_NONE;
+            SelectCellRegion(AttributeOptions);
+        }
+
+        // Cell extent of image data
+        ImageGeometry CellGeometry;
+        if(AttributeIterator == 1 && Geometry != NULL)
+        {
+            if(AttributeOptions.Coordinates != COORDINATES_NONE)
+            {
+                std::cerr << "Implicit coordinates are only available for ";
+                std::cerr << "point data of image data and structured ";
+                std::cerr << "points." << std::endl;
+                throw ConversionError();
+            }
+
+            CellGeometry = *Geometry;
+            GetCellExtent(Geometry->Extent,Geometry->Extent,
+                    CellGeometry.Extent);
+            AlignExtentToStride(CellGeometry.Extent,Geometry->Stride);
+
+            // Cells between the points that are written
+            int PointExtent[6];
+            GetExtractExtent(Geometry->Extent,Options,PointExtent);
+            GetCellExtent(PointExtent,Geometry->Extent,
+                    AttributeOptions.Extent);
+            AttributeOptions.ExtractExtent = true;
+        }
+
+        WriteArraysToOutputFile(
+                SelectedArrays,
+                AttributeIterator == 0 || Geometry == NULL ?
+                    Geometry : &CellGeometry,
+                OutputFilenames[AttributeIterator].c_str(),
+                AttributeOptions);
+    }
+}
+
+// ===============
+// Get Slab Layout
+// ===============
+
+// Description:
+// Finds the rows of the point and cell data that are written, and the
+// memory of one row while it is read, from the header of a piece. Geometry
+// is the whole image of image data, or NULL.
+//
+// The rows of unstructured data are a range of tuples, written as the
+// extent 0 n-1 0 0 0 0. The memory of a row is estimated as 8 bytes for
+// each component of the selected arrays.
+
+void GetSlabLayout(
+        const PieceHeader &Piece,
+        const ImageGeometry *Geometry,
+        const ConversionOptions &Options,
+        SlabLayout &Layout)                   // Output
+{
+    const std::vector<ArrayHeader> *Arrays[2] = {
+        &Piece.PointArrays,&Piece.CellArrays};
+    unsigned long long NumberOfTuples[2] = {
+        Piece.NumberOfPoints,Piece.NumberOfCells};
+
+    // With both attributes, a selected array needs to be in one of them
+    for(unsigned int NameIterator = 0;
+        Options.WritePointData == true && Options.WriteCellData == true &&
+        NameIterator < Options.ArrayNames.size();
+        NameIterator++)
+    {
+        bool Found = false;
+        for(unsigned int AttributeIterator = 0;
+            AttributeIterator < 2;
+            AttributeIterator++)
+        {
+            for(unsigned int ArrayIterator = 0;
+                ArrayIterator < Arrays[AttributeIterator]->size();
+                ArrayIterator++)
+            {
+                Found = Found || ((*Arrays[AttributeIterator])[ArrayIterator]
+                        .Name == Options.ArrayNames[NameIterator]);
+            }
+        }
+
+        if(Found == false)
+        {
+            std::cerr << "Array not found: ";
+            std::cerr << Options.ArrayNames[NameIterator] << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    // Rows
+    Layout.Structured = (Geometry != NULL);
+    if(Layout.Structured == true)
+    {
+        GetExtractExtent(Geometry->Extent,Options,Layout.RowExtents[0]);
+        GetCellExtent(Layout.RowExtents[0],Geometry->Extent,
+                Layout.RowExtents[1]);
+        AlignExtentToStride(Layout.RowExtents[1],Options.Stride);
+    }
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        // Tuples of unstructured data
+        if(Arrays[AttributeIterator]->empty() == false)
+        {
+            NumberOfTuples[AttributeIterator] = \
+                (*Arrays[AttributeIterator])[0].NumberOfTuples;
+        }
+
+        if(Layout.Structured == true)
+        {
+            Layout.NumberOfRows[AttributeIterator] = GetNumberOfExtentTuples(
+                    Layout.RowExtents[AttributeIterator],Options.Stride);
+        }
+        else
+        {
+            Layout.NumberOfRows[AttributeIterator] = \
+                NumberOfTuples[AttributeIterator];
+        }
+
+        // Memory of a row
+        Layout.RowBytes[AttributeIterator] = 0;
+        for(unsigned int ArrayIterator = 0;
+            ArrayIterator < Arrays[AttributeIterator]->size();
+            ArrayIterator++)
+        {
+            const ArrayHeader &Array = \
+                (*Arrays[AttributeIterator])[ArrayIterator];
+            if(IsArraySelected(Array.Name,Options) == true)
+            {
+                Layout.RowBytes[AttributeIterator] += \
+                    Array.NumberOfComponents * sizeof(double);
+            }
+        }
+    }
+
+    if(Options.WritePoints == true)
+    {
+        Layout.RowBytes[0] += 3 * sizeof(double);
+    }
+}
+
+// =================================
+// Stream Attributes To Output Files
+// =================================
+
+// Description:
+// Out-of-core version of WriteAttributesToOutputFiles. The rows of the
+// point and cell data are divided into slabs of at most the number of rows
+// that fit in the memory limit. Each slab is read by the ReadSlab function
+// of the reader, converted and appended to the output file before the next
+// slab is read, so the memory does not depend on the size of the dataset.
+//
+// For image data, a slab is a set of whole k planes, or if a plane does not
+// fit, a set of whole rows of one plane, or a part of one row. The slabs of
+// the cell data are slabs of the cell extent, so that no cell is read twice.
+// For unstructured data, a slab is a range of rows, counted in 64 bits. If
+// the layout has pieces, each piece is one slab instead.
+// The output files are the same as written by WriteAttributesToOutputFiles.
+
+void StreamAttributesToOutputFiles(
+        ReadSlabFunction ReadSlab,
+        void *SlabReader,
+        const SlabLayout &Layout,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    bool WriteAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    const char *AttributeNames[2] = {"point","cell"};
+
+    // Output files
+    bool WriteBothAttributes = (WriteAttribute[0] && WriteAttribute[1]);
+    std::string OutputFilenames[2] = {OutputFilename,OutputFilename};
+    if(WriteBothAttributes == true)
+    {
+        OutputFilenames[1] = MakeDerivedFilename(OutputFilename,"cell");
+    }
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(WriteAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        // Implicit coordinates are only for points
+        ConversionOptions AttributeOptions = Options;
+        if(AttributeIterator == 1 && WriteBothAttributes == true)
+        {
+            AttributeOptions.Coordinates = COORDINATES_NONE;
+            SelectCellRegion(AttributeOptions);
+        }
+        else if(AttributeIterator == 1 && Layout.Structured == true &&
+                AttributeOptions.Coordinates != COORDINATES_NONE)
+        {
+            std::cerr << "Implicit coordinates are only available for ";
+            std::cerr << "point data of image data and structured points.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        // Slabs, or one slab per piece whose extent is the piece index
+        unsigned long long NumberOfRows = \
+            Layout.NumberOfRows[AttributeIterator];
+        unsigned long long NumberOfSlabRows = GetNumberOfSlabRows(
+                Layout.RowBytes[AttributeIterator],Options);
+        std::vector<int> SlabExtents;
+        std::vector<unsigned long long> SlabRows;
+        for(int PieceIterator = 0;
+            PieceIterator < Layout.NumberOfPieces;
+            PieceIterator++)
+        {
+            int PieceExtent[6] = {PieceIterator,PieceIterator,0,0,0,0};
+            SlabExtents.insert(SlabExtents.end(),PieceExtent,PieceExtent+6);
+        }
+
+        if(Layout.NumberOfPieces == 0 && Layout.Structured == true)
+        {
+            GetSlabExtents(Layout.RowExtents[AttributeIterator],
+                    Options.Stride,NumberOfSlabRows,SlabExtents);
+        }
+        else if(Layout.NumberOfPieces == 0)
+        {
+            // First row and number of rows of each slab, with one empty
+            // slab if there are no rows
+            for(unsigned long long FirstRow = 0;
+                FirstRow < NumberOfRows || FirstRow == 0;
+                FirstRow += NumberOfSlabRows)
+            {
+                SlabRows.push_back(FirstRow);
+                SlabRows.push_back(std::min(NumberOfSlabRows,
+                            NumberOfRows - FirstRow));
+            }
+        }
+        unsigned int NumberOfSlabs = SlabRows.empty() == true ?
+            SlabExtents.size() / 6 : SlabRows.size() / 2;
+
+        OutputFileStream OutputFile;
+        OutputMatrix Matrix;
+        ShardLayout Shards;
+        unsigned long long RowOffset = 0;
+
+        for(unsigned int SlabIterator = 0;
+            SlabIterator < NumberOfSlabs;
+            SlabIterator++)
+        {
+            const int *SlabExtent = SlabRows.empty() == true ?
+                &SlabExtents[6*SlabIterator] : NULL;
+            const unsigned long long *SlabRange = SlabRows.empty() == true ?
+                NULL : &SlabRows[2*SlabIterator];
+
+            // Read slab
+            std::vector<vtkDataArray*> SelectedArrays;
+            ImageGeometry Geometry;
+            ReadSlab(SlabReader,AttributeIterator,SlabExtent,SlabRange,
+                    SelectedArrays,Geometry);
+
+            if(SlabIterator == 0 && WriteBothAttributes == true &&
+               SelectedArrays.empty() == true &&
+               (AttributeIterator == 1 ||
+                Options.Coordinates == COORDINATES_NONE))
+            {
+                Messages << "No " << AttributeNames[AttributeIterator];
+                Messages << " data arrays to write." << std::endl;
+                break;
+            }
+
+            // Rows of the slab
+            ConversionOptions SlabOptions = AttributeOptions;
+            if(Layout.Structured == true)
+            {
+                SlabOptions.ExtractExtent = true;
+                for(unsigned int i = 0; i < 6; i++)
+                {
+                    SlabOptions.Extent[i] = SlabExtent[i];
+                }
+            }
+
+            BuildOutputMatrix(
+                    SelectedArrays,
+                    Layout.Structured == true ? &Geometry : NULL,
+                    SlabOptions,
+                    Matrix);
+
+            if(SlabIterator == 0)
+            {
+                PrintOutputMatrix(Matrix);
+                if(Layout.NumberOfPieces > 0)
+                {
+                    Messages << "Pieces: " << NumberOfSlabs << std::endl;
+                }
+                else
+                {
+                    Messages << "Slabs: " << NumberOfSlabs;
+                    Messages << ", Rows per slab: ";
+                    Messages << std::min(NumberOfSlabRows,NumberOfRows);
+                    Messages << std::endl;
+                }
+
+                // The shared memory is sized to the rows of all slabs
+                if(Options.SharedMemoryOutput == true)
+                {
+                    CreateMatrixSharedMemory(
+                            OutputFilenames[AttributeIterator].c_str(),
+                            Matrix,
+                            NumberOfRows);
+                    OutputFile.OpenSharedMemory(
+                            OutputFilenames[AttributeIterator].c_str());
+                }
+                else if(IsShardedOutput(Options) == true)
+                {
+                    // Slabs fill the shards in order
+                    GetShardLayout(OutputFilenames[AttributeIterator].c_str(),
+                            NumberOfRows,Matrix.NumberOfColumns,Options,
+                            Shards);
+                    CreateShards(Shards);
+                    OpenShards(Shards,OutputFile);
+                }
+                else if(AttributeOptions.RegionOutput == true)
+                {
+                    OpenFileRegion(OutputFilenames[AttributeIterator].c_str(),
+                            NumberOfRows,Matrix.NumberOfColumns,
+                            AttributeOptions,OutputFile);
+                }
+                else
+                {
+                    OpenFile(OutputFilenames[AttributeIterator].c_str(),
+                            Options.BinaryOutputFile,OutputFile);
+                }
+            }
+
+            // Append slab
+            if(Options.BinaryOutputFile == false)
+            {
+                WriteArraysToASCIIFile(OutputFile,Matrix,RowOffset);
+            }
+            else
+            {
+                WriteArraysToBinaryFile(OutputFile,Matrix,RowOffset);
+            }
+
+            RowOffset += Matrix.NumberOfRows;
+        }
+
+        if(OutputFile.is_open() == true)
+        {
+            Messages << Matrix.Arrays.size();
+            Messages << " arrays in column-wise order as above were ";
+            Messages << "written to: " << OutputFilenames[AttributeIterator];
+            Messages << "." << std::endl;
+            Messages << "Rows: " << RowOffset << ", Columns: ";
+            Messages << Matrix.NumberOfColumns << "." << std::endl;
+
+            OutputFile.close();
+
+            if(Options.SharedMemoryOutput == true)
+            {
+                PublishSharedMemory(
+                        OutputFilenames[AttributeIterator].c_str(),RowOffset);
+            }
+            else if(IsShardedOutput(Options) == true)
+            {
+                PublishShards(Shards,
+                        OutputFilenames[AttributeIterator].c_str(),Options,
+                        NULL);
+            }
+        }
+    }
+}
+
+// ===============
+// Read Piece Slab
+// ===============
+
+// Description:
+// Slab reader of the native readers. Each array of the slab is read by
+// seeking to its rows in the file.
+
+struct PieceSlabReader
+{
+    std::istream *InputFile;
+    const char *InputFilename;
+    const FileHeader *Header;
+    const PieceHeader *Piece;
+    const ImageGeometry *Geometry;       // Whole image, or NULL
+    const ConversionOptions *Options;
+    int DataExtents[2][6];               // Point and cell tuples of image
+                                         // data in the file
+    vtkSmartPointer<vtkDataSetAttributes> InputData;
+    vtkSmartPointer<vtkDataArray> InputPoints;
+};
+
+void ReadPieceSlab(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry)                      // Output
+{
+    PieceSlabReader *Reader = static_cast<PieceSlabReader*>(SlabReader);
+    const ConversionOptions &Options = *Reader->Options;
+    bool Structured = (Reader->Geometry != NULL);
+    int NoStride[3] = {1,1,1};
+
+    // Points of the slab, which are read before the arrays, since the
+    // points of a legacy file are before its point data
+    if(Attribute == 0 && Options.WritePoints == true)
+    {
+        const ArrayHeader &Points = Reader->Piece->Points;
+        Reader->InputPoints = vtkSmartPointer<vtkDataArray>::Take(
+                vtkDataArray::CreateDataArray(Points.DataType));
+
+        bool Status = false;
+        if(Structured == true)
+        {
+            Status = ReadArrayExtent(*Reader->InputFile,Points,
+                    Points.Offset,Reader->Header->BigEndian,
+                    Reader->DataExtents[0],SlabExtent,NoStride,
+                    Reader->InputPoints);
+        }
+        else
+        {
+            Status = ReadArrayRows(*Reader->InputFile,Points,Points.Offset,
+                    Reader->Header->BigEndian,SlabRows[0],SlabRows[1],
+                    Reader->InputPoints);
+        }
+
+        if(Status == false)
+        {
+            std::cerr << "Can not read points from: ";
+            std::cerr << Reader->InputFilename << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    // Arrays of the slab
+    if(Attribute == 0)
+    {
+        Reader->InputData = vtkSmartPointer<vtkPointData>::New();
+    }
+    else
+    {
+        Reader->InputData = vtkSmartPointer<vtkCellData>::New();
+    }
+
+    ReadAttributeArrays(
+            *Reader->InputFile,
+            Reader->InputFilename,
+            *Reader->Header,
+            Attribute == 0 ? Reader->Piece->PointArrays :
+                             Reader->Piece->CellArrays,
+            Structured == true ? Reader->DataExtents[Attribute] : NULL,
+            SlabExtent,
+            SlabRows,
+            Options.Stride,
+            Options,
+            Reader->InputData);
+
+    SelectArrays(Reader->InputData,Options,SelectedArrays);
+
+    if(Attribute == 0 && Options.WritePoints == true)
+    {
+        SelectedArrays.push_back(Reader->InputPoints);
+    }
+
+    // Geometry of the slab
+    if(Reader->Geometry != NULL)
+    {
+        Geometry = *Reader->Geometry;
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Geometry.Extent[i] = SlabExtent[i];
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Geometry.Stride[i] = Options.Stride[i];
+        }
+    }
+}
+
+// ============================
+// Stream Piece To Output Files
+// ============================
+
+// Description:
+// Out-of-core conversion of one piece by the native readers. Geometry is
+// the whole image of image data, or NULL for unstructured data.
+
+void StreamPieceToOutputFiles(
+        std::istream &InputFile,
+        const char *InputFilename,
+        const FileHeader &Header,
+        const PieceHeader &Piece,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    SlabLayout Layout;
+    GetSlabLayout(Piece,Geometry,Options,Layout);
+
+    PieceSlabReader Reader;
+    Reader.InputFile = &InputFile;
+    Reader.InputFilename = InputFilename;
+    Reader.Header = &Header;
+    Reader.Piece = &Piece;
+    Reader.Geometry = Geometry;
+    Reader.Options = &Options;
+
+    // Extents of the point and cell tuples of image data in the file
+    if(Geometry != NULL)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Reader.DataExtents[0][i] = Geometry->Extent[i];
+        }
+        GetCellExtent(Reader.DataExtents[0],Reader.DataExtents[0],
+                Reader.DataExtents[1]);
+    }
+
+    StreamAttributesToOutputFiles(
+            ReadPieceSlab,
+            &Reader,
+            Layout,
+            OutputFilename,
+            Options);
+}
+
+// ====================
+// Read Image Data Slab
+// ====================
+
+// Description:
+// Slab reader of image data read by a VTK XML reader. The slab is requested
+// as the update extent of the reader. For a slab of cells, the update
+// extent is the extent of the points around the cells.
+
+struct ImageDataSlabReader
+{
+    vtkAlgorithm *Reader;
+    int WholeExtent[6];
+    const ConversionOptions *Options;
+};
+
+void ReadImageDataSlab(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry)                      // Output
+{
+    ImageDataSlabReader *Reader = \
+        static_cast<ImageDataSlabReader*>(SlabReader);
+
+    int UpdateExtent[6];
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        UpdateExtent[2*Dimension] = SlabExtent[2*Dimension];
+        UpdateExtent[2*Dimension+1] = SlabExtent[2*Dimension+1];
+        if(Attribute == 1)
+        {
+            UpdateExtent[2*Dimension+1] = std::min(
+                    SlabExtent[2*Dimension+1] + 1,
+                    Reader->WholeExtent[2*Dimension+1]);
+        }
+    }
+
+    Reader->Reader->UpdateExtent(UpdateExtent);
+    vtkImageData *InputImageData = vtkImageData::SafeDownCast(
+            Reader->Reader->GetOutputDataObject(0));
+
+    InputImageData->GetExtent(Geometry.Extent);
+    InputImageData->GetOrigin(Geometry.Origin);
+    InputImageData->GetSpacing(Geometry.Spacing);
+    if(Attribute == 1)
+    {
+        GetCellExtent(Geometry.Extent,Geometry.Extent,Geometry.Extent);
+    }
+
+    SelectArrays(
+            Attribute == 0 ?
+                static_cast<vtkDataSetAttributes*>(
+                    InputImageData->GetPointData()) :
+                static_cast<vtkDataSetAttributes*>(
+                    InputImageData->GetCellData()),
+            *Reader->Options,
+            SelectedArrays);
+}
+
+// =================================
+// Stream Image Data To Output Files
+// =================================
+
+// Description:
+// Out-of-core conversion of image data by a VTK XML reader whose
+// information has been updated. The header gives the arrays of the file,
+// from which the memory of a row is estimated.
+
+void StreamImageDataToOutputFiles(
+        vtkAlgorithm *ImageDataReader,
+        const FileHeader &Header,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    ImageDataSlabReader Reader;
+    Reader.Reader = ImageDataReader;
+    Reader.Options = &Options;
+    ImageDataReader->GetOutputInformation(0)->Get(
+            vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(),
+            Reader.WholeExtent);
+
+    ImageGeometry Geometry;
+    for(unsigned int i = 0; i < 6; i++)
+    {
+        Geometry.Extent[i] = Reader.WholeExtent[i];
+    }
+
+    SlabLayout Layout;
+    PieceHeader Piece;
+    GetSlabLayout(
+            Header.Pieces.empty() == true ? Piece : Header.Pieces[0],
+            &Geometry,
+            Options,
+            Layout);
+
+    StreamAttributesToOutputFiles(
+            ReadImageDataSlab,
+            &Reader,
+            Layout,
+            OutputFilename,
+            Options);
+}
+
+// ==================
+// Read DataSet Piece
+// ==================
+
+// Description:
+// Slab reader of unstructured data read by a VTK XML reader, piece by
+// piece. The extent of a slab is the index of the piece, which is requested
+// from the reader as one of the pieces of the file. The XML readers then
+// read only the elements of this piece, so the memory holds one piece at a
+// time. The piece is read again only if the cell data asks for another
+// piece than the point data.
+
+struct DataSetPieceReader
+{
+    vtkAlgorithm *Reader;
+    int NumberOfPieces;
+    int CurrentPiece;                    // -1 before the first piece
+    const ConversionOptions *Options;
+};
+
+void ReadDataSetPiece(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry)                      // Output
+{
+    DataSetPieceReader *Reader = static_cast<DataSetPieceReader*>(SlabReader);
+    const ConversionOptions &Options = *Reader->Options;
+
+    if(Reader->CurrentPiece != SlabExtent[0])
+    {
+        Reader->Reader->UpdatePiece(SlabExtent[0],Reader->NumberOfPieces,0);
+        Reader->CurrentPiece = SlabExtent[0];
+    }
+
+    vtkDataSet *InputDataSet = vtkDataSet::SafeDownCast(
+            Reader->Reader->GetOutputDataObject(0));
+    if(InputDataSet == NULL)
+    {
+        std::cerr << "Can not read piece " << SlabExtent[0] << "." << std::endl;
+        throw ConversionError();
+    }
+
+    SelectArrays(
+            Attribute == 0 ?
+                static_cast<vtkDataSetAttributes*>(
+                    InputDataSet->GetPointData()) :
+                static_cast<vtkDataSetAttributes*>(
+                    InputDataSet->GetCellData()),
+            Options,
+            SelectedArrays);
+
+    // Point coordinates
+    if(Attribute == 0 && Options.WritePoints == true)
+    {
+        vtkPointSet *InputPointSet = vtkPointSet::SafeDownCast(InputDataSet);
+        if(InputPointSet == NULL || InputPointSet->GetPoints() == NULL)
+        {
+            std::cerr << "DataSet has no explicit point coordinates.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        SelectedArrays.push_back(InputPointSet->GetPoints()->GetData());
+    }
+}
+
+// =====================================
+// Stream DataSet Pieces To Output Files
+// =====================================
+
+// Description:
+// Out-of-core conversion of a file with several pieces by a VTK XML reader.
+// Each piece is read, written and released before the next one, so the
+// memory is bounded by the largest piece rather than by the whole file. The
+// rows of the pieces are written in the order of the pieces, which is the
+// order of the merged dataset.
+
+void StreamDataSetPiecesToOutputFiles(
+        vtkAlgorithm *DataSetReader,
+        const FileHeader &Header,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    DataSetPieceReader Reader;
+    Reader.Reader = DataSetReader;
+    Reader.NumberOfPieces = static_cast<int>(Header.Pieces.size());
+    Reader.CurrentPiece = -1;
+    Reader.Options = &Options;
+
+    SlabLayout Layout;
+    GetSlabLayout(Header.Pieces[0],NULL,Options,Layout);
+    Layout.NumberOfPieces = Reader.NumberOfPieces;
+
+    // Rows of all pieces
+    unsigned long long NumberOfRows[2] = {0,0};
+    for(unsigned int PieceIterator = 0;
+        PieceIterator < Header.Pieces.size();
+        PieceIterator++)
+    {
+        NumberOfRows[0] += Header.Pieces[PieceIterator].NumberOfPoints;
+        NumberOfRows[1] += Header.Pieces[PieceIterator].NumberOfCells;
+    }
+    Layout.NumberOfRows[0] = NumberOfRows[0];
+    Layout.NumberOfRows[1] = NumberOfRows[1];
+
+    StreamAttributesToOutputFiles(
+            ReadDataSetPiece,
+            &Reader,
+            Layout,
+            OutputFilename,
+            Options);
+}
+
+// ============================
+// Write Pieces To Output Files
+// ============================
+
+// Description:
+// Converts the pieces of a dataset on a pool of threads into binary output
+// files. The rows of each piece are known from the header, so the offset of
+// each piece in the output file is computed before any piece is read, and
+// each thread writes the rows of its pieces directly at their offsets.
+//
+// For unstructured data, the rows of the pieces follow each other in the
+// order of the pieces. For image data, the pieces are placed into the rows
+// of the whole (sub-)volume, which are the same rows as written for the
+// merged image. Pieces that are outside of the --extent are not read.
+
+struct PieceConversion
+{
+    const char *InputFilename;           // Pieces without a Source
+    const FileHeader *Header;
+    const std::vector<FileHeader> *SourceHeaders; // Headers of the files
+    const std::vector<unsigned int> *PieceSources; // of the pieces, and the
+                                         // index of the file of each piece
+    const ImageGeometry *Geometry;       // Whole image, or NULL
+    ConversionOptions Options;           // Options of the attribute
+    unsigned int Attribute;              // 0: point data, 1: cell data
+    int RowExtent[6];                    // Image data: rows of the whole
+    std::vector<unsigned long long> RowOffsets; // Unstructured: first row of
+                                         // each piece
+    unsigned int NumberOfColumns;
+    std::string OutputFilename;
+    ShardLayout Shards;                  // Shards of the output, if any
+    std::streambuf *MessageBuffer;       // Messages of the caller
+    std::atomic<unsigned int> NextPiece;
+    std::atomic<unsigned long long> NumberOfWrittenRows; // By all threads
+    std::atomic<bool> Failed;            // A thread has thrown an error
+};
+
+void WritePiecesToOutputFiles(
+        const char *InputFilename,
+        const FileHeader &Header,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    bool WriteAttribute[2] = {Options.WritePointData,Options.WriteCellData};
+    const char *AttributeNames[2] = {"point","cell"};
+    unsigned int NumberOfPieces = Header.Pieces.size();
+    unsigned int NumberOfThreads = GetNumberOfThreads(Options,NumberOfPieces);
+
+    // Output files
+    bool WriteBothAttributes = (WriteAttribute[0] && WriteAttribute[1]);
+    std::string OutputFilenames[2] = {OutputFilename,OutputFilename};
+    if(WriteBothAttributes == true)
+    {
+        OutputFilenames[1] = MakeDerivedFilename(OutputFilename,"cell");
+    }
+
+    // Selected arrays are checked over both attributes
+    SlabLayout Layout;
+    GetSlabLayout(Header.Pieces[0],Geometry,Options,Layout);
+
+    // Headers of the piece files, each scanned once for all its pieces
+    std::vector<FileHeader> SourceHeaders;
+    std::vector<unsigned int> PieceSources;
+    ScanPieceSources(InputFilename,Header,SourceHeaders,PieceSources);
+
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        if(WriteAttribute[AttributeIterator] == false)
+        {
+            continue;
+        }
+
+        PieceConversion Conversion;
+        Conversion.InputFilename = InputFilename;
+        Conversion.Header = &Header;
+        Conversion.SourceHeaders = &SourceHeaders;
+        Conversion.PieceSources = &PieceSources;
+        Conversion.Geometry = Geometry;
+        Conversion.Options = Options;
+        Conversion.Attribute = AttributeIterator;
+        Conversion.OutputFilename = OutputFilenames[AttributeIterator];
+        Conversion.MessageBuffer = Messages.rdbuf();
+        Conversion.NextPiece = 0;
+        Conversion.NumberOfWrittenRows = 0;
+        Conversion.Failed = false;
+
+        // Implicit coordinates are only for points
+        if(AttributeIterator == 1 && WriteBothAttributes == true)
+        {
+            Conversion.Options.Coordinates = COORDINATES_NONE;
+            SelectCellRegion(Conversion.Options);
+        }
+        else if(AttributeIterator == 1 &&
+                Conversion.Options.Coordinates != COORDINATES_NONE)
+        {
+            std::cerr << "Implicit coordinates are only available for ";
+            std::cerr << "point data of image data and structured points.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        // Columns of the selected arrays
+        std::vector<ArrayHeader> SelectedArrays;
+        GetSelectedArrayHeaders(
+                AttributeIterator == 0 ? Header.Pieces[0].PointArrays :
+                                         Header.Pieces[0].CellArrays,
+                Conversion.Options,
+                SelectedArrays);
+
+        Conversion.NumberOfColumns = 0;
+        for(unsigned int ArrayIterator = 0;
+            ArrayIterator < SelectedArrays.size();
+            ArrayIterator++)
+        {
+            Conversion.NumberOfColumns += \
+                SelectedArrays[ArrayIterator].NumberOfComponents;
+        }
+
+        unsigned int NumberOfArrays = SelectedArrays.size();
+        if(AttributeIterator == 0 && Options.WritePoints == true)
+        {
+            Conversion.NumberOfColumns += 3;
+            NumberOfArrays++;
+        }
+
+        if(WriteBothAttributes == true && NumberOfArrays == 0 &&
+           Conversion.Options.Coordinates == COORDINATES_NONE)
+        {
+            Messages << "No " << AttributeNames[AttributeIterator];
+            Messages << " data arrays to write." << std::endl;
+            continue;
+        }
+
+        if(Conversion.Options.Coordinates != COORDINATES_NONE)
+        {
+            Conversion.NumberOfColumns += 3;
+        }
+
+        // Rows of the pieces
+        unsigned long long NumberOfRows = 0;
+        if(Geometry != NULL)
+        {
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                Conversion.RowExtent[i] = \
+                    Layout.RowExtents[AttributeIterator][i];
+            }
+            NumberOfRows = GetNumberOfExtentTuples(Conversion.RowExtent,
+                    Options.Stride);
+        }
+        else
+        {
+            for(unsigned int PieceIterator = 0;
+                PieceIterator < NumberOfPieces;
+                PieceIterator++)
+            {
+                const PieceHeader &Piece = Header.Pieces[PieceIterator];
+                Conversion.RowOffsets.push_back(NumberOfRows);
+                NumberOfRows += (AttributeIterator == 0 ?
+                        Piece.NumberOfPoints : Piece.NumberOfCells);
+            }
+        }
+
+        // The threads write their pieces to the region of the output
+        if(Conversion.Options.RegionOutput == true)
+        {
+            CheckFileRegionSize(Conversion.OutputFilename.c_str(),
+                    NumberOfRows,Conversion.NumberOfColumns,
+                    Conversion.Options);
+        }
+
+        // Print info
+        for(unsigned int ArrayIterator = 0;
+            ArrayIterator < SelectedArrays.size();
+            ArrayIterator++)
+        {
+            Messages << "Array: " << ArrayIterator << ", NumberOfComponents: ";
+            Messages << SelectedArrays[ArrayIterator].NumberOfComponents;
+            Messages << ", NumberOfTuples: " << NumberOfRows;
+            Messages << ", ArrayName: ";
+            Messages << SelectedArrays[ArrayIterator].Name << std::endl;
+        }
+        Messages << "Pieces: " << NumberOfPieces << ", Threads: ";
+        Messages << NumberOfThreads << std::endl;
+
+        // Create the output file, or the shared memory sized to all rows,
+        // which the threads open again to write
+        if(Options.SharedMemoryOutput == true)
+        {
+            std::vector<std::string> ArrayNames;
+            std::vector<unsigned int> NumberOfComponents;
+            for(unsigned int ArrayIterator = 0;
+                ArrayIterator < SelectedArrays.size();
+                ArrayIterator++)
+            {
+                ArrayNames.push_back(SelectedArrays[ArrayIterator].Name);
+                NumberOfComponents.push_back(
+                        SelectedArrays[ArrayIterator].NumberOfComponents);
+            }
+            if(AttributeIterator == 0 && Options.WritePoints == true)
+            {
+                ArrayNames.push_back("Points");
+                NumberOfComponents.push_back(3);
+            }
+
+            CreateSharedMemory(Conversion.OutputFilename.c_str(),ArrayNames,
+                    NumberOfComponents,Conversion.Options.Coordinates,
+                    NumberOfRows,Conversion.NumberOfColumns);
+        }
+        else if(IsShardedOutput(Options) == true)
+        {
+            GetShardLayout(Conversion.OutputFilename.c_str(),NumberOfRows,
+                    Conversion.NumberOfColumns,Options,Conversion.Shards);
+            CreateShards(Conversion.Shards);
+        }
+        else if(Options.RegionOutput == false)
+        {
+            OutputFileStream OutputFile;
+            OpenFile(Conversion.OutputFilename.c_str(),true,OutputFile);
+            OutputFile.close();
+        }
+
+        // Pool of threads
+        std::vector<std::thread> Threads;
+        for(unsigned int ThreadIterator = 0;
+            ThreadIterator < NumberOfThreads;
+            ThreadIterator++)
+        {
+            Threads.push_back(std::thread(ConvertPiecesOnThread,&Conversion));
+        }
+
+        for(unsigned int ThreadIterator = 0;
+            ThreadIterator < NumberOfThreads;
+            ThreadIterator++)
+        {
+            Threads[ThreadIterator].join();
+        }
+
+        // The error of a piece was printed by its thread
+        if(Conversion.Failed == true)
+        {
+            throw ConversionError();
+        }
+
+        if(Options.SharedMemoryOutput == true)
+        {
+            PublishSharedMemory(Conversion.OutputFilename.c_str(),
+                    Conversion.NumberOfWrittenRows);
+        }
+        else if(IsShardedOutput(Options) == true)
+        {
+            PublishShards(Conversion.Shards,Conversion.OutputFilename.c_str(),
+                    Options,NULL);
+        }
+
+        Messages << NumberOfArrays << " arrays in column-wise order as ";
+        Messages << "above were written to: " << Conversion.OutputFilename;
+        Messages << "." << std::endl;
+        Messages << "Rows: " << NumberOfRows << ", Columns: ";
+        Messages << Conversion.NumberOfColumns << "." << std::endl;
+    }
+}
+
+// ==================
+// Scan Piece Sources
+// ==================
+
+// Description:
+// Headers of the files of the pieces, which the threads read the pieces
+// with. Pieces without a Source are in the input file, whose header is
+// already scanned, and the piece files of a partitioned file were scanned
+// with it. Other piece files are scanned once, however many pieces they
+// have, so that a file with inline data is not read once per piece.
+
+void ScanPieceSources(
+        const char *InputFilename,
+        const FileHeader &Header,
+        std::vector<FileHeader> &SourceHeaders,       // Output
+        std::vector<unsigned int> &PieceSources)      // Output
+{
+    std::map<std::string,unsigned int> SourceIndices;
+
+    SourceHeaders.clear();
+    PieceSources.clear();
+
+    for(unsigned int PieceIterator = 0;
+        PieceIterator < Header.Pieces.size();
+        PieceIterator++)
+    {
+        const PieceHeader &Piece = Header.Pieces[PieceIterator];
+        std::map<std::string,unsigned int>::iterator Source = \
+            SourceIndices.find(Piece.Source);
+
+        if(Source == SourceIndices.end())
+        {
+            SourceHeaders.push_back(FileHeader());
+            FileHeader &SourceHeader = SourceHeaders.back();
+
+            // Header of the piece file, which the pieces of the file name
+            bool Scanned = false;
+            for(unsigned int SourceIterator = 0;
+                SourceIterator < Header.SourceHeaders.size() &&
+                Scanned == false;
+                SourceIterator++)
+            {
+                const FileHeader &ScannedHeader = \
+                    Header.SourceHeaders[SourceIterator];
+                if(ScannedHeader.Pieces[0].Source == Piece.Source)
+                {
+                    SourceHeader = ScannedHeader;
+                    Scanned = true;
+                }
+            }
+
+            if(Piece.Source.empty() == true)
+            {
+                SourceHeader = Header;
+            }
+            else if(Scanned == false &&
+                    ScanXMLFileHeader(Piece.Source.c_str(),
+                        SourceHeader) == false)
+            {
+                std::cerr << "Can not read piece file: " << Piece.Source;
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+            SourceHeader.FileType = Header.FileType;
+
+            Source = SourceIndices.insert(std::make_pair(Piece.Source,
+                        SourceHeaders.size()-1)).first;
+        }
+
+        if(Piece.SourcePiece >= SourceHeaders[Source->second].Pieces.size())
+        {
+            std::cerr << "Can not read piece file: ";
+            std::cerr << (Piece.Source.empty() == true ?
+                    std::string(InputFilename) : Piece.Source) << std::endl;
+            throw ConversionError();
+        }
+
+        PieceSources.push_back(Source->second);
+    }
+}
+
+// ========================
+// Convert Pieces On Thread
+// ========================
+
+// Description:
+// One thread of the pool. Each thread takes the next piece that is not yet
+// converted, until all pieces are converted, and writes with its own output
+// stream. After an error, the threads take no more pieces.
+
+void ConvertPiecesOnThread(PieceConversion *Conversion)
+{
+    std::ostream Messages(Conversion->MessageBuffer);
+    SetMessageStream(&Messages);
+
+    try
+    {
+        OutputFileStream OutputFile;
+        if(Conversion->Options.SharedMemoryOutput == true)
+        {
+            OutputFile.OpenSharedMemory(Conversion->OutputFilename.c_str());
+        }
+        else if(IsShardedOutput(Conversion->Options) == true)
+        {
+            OpenShards(Conversion->Shards,OutputFile);
+        }
+        else if(Conversion->Options.RegionOutput == true)
+        {
+            OutputFile.OpenRegion(Conversion->OutputFilename.c_str(),
+                    Conversion->Options.RegionOffset,
+                    Conversion->Options.RegionSize);
+        }
+        else
+        {
+            OutputFile.open(Conversion->OutputFilename.c_str(),
+                    std::ios::in | std::ios::out | std::ios::binary);
+        }
+
+        if(OutputFile.is_open() != true)
+        {
+            std::cerr << "Can not open output file: ";
+            std::cerr << Conversion->OutputFilename << std::endl;
+            throw ConversionError();
+        }
+
+        // Each thread writes only its pieces, at their rows, so a region is not
+        // full when one thread closes it
+        OutputFile.seekp(0);
+
+        unsigned int NumberOfPieces = Conversion->Header->Pieces.size();
+        for(unsigned int PieceIndex = Conversion->NextPiece++;
+            PieceIndex < NumberOfPieces && Conversion->Failed == false;
+            PieceIndex = Conversion->NextPiece++)
+        {
+            Conversion->NumberOfWrittenRows += ConvertPiece(*Conversion,
+                    PieceIndex,OutputFile);
+        }
+
+        OutputFile.close();
+    }
+    catch(const ConversionError &)
+    {
+        Conversion->Failed = true;
+    }
+}
+
+// =============
+// Convert Piece
+// =============
+
+// Description:
+// Reads the selected arrays of one piece and writes its rows at their
+// offsets in the output file. Piece files with raw appended data are read
+// natively, by seeking to the rows of the piece that are written. Other
+// piece files are read by a VTK XML reader of this thread.
+//
+// The rows of an image piece are written in runs that are contiguous in the
+// output: the whole piece, planes, or rows of i, depending on which
+// directions of the piece span the whole (sub-)volume. Returns the number
+// of rows that are written.
+
+unsigned long long ConvertPiece(
+        const PieceConversion &Conversion,
+        unsigned int PieceIndex,
+        std::ostream &OutputFile)
+{
+    const PieceHeader &Piece = Conversion.Header->Pieces[PieceIndex];
+    const ConversionOptions &Options = Conversion.Options;
+    unsigned int Attribute = Conversion.Attribute;
+
+    // Rows of the piece. Neighbouring pieces share the points of their
+    // common plane, which are written by the upper piece only, so that the
+    // piece owns its points up to but not including its upper bound, except
+    // at the upper bound of the whole image.
+    int PieceExtent[6];
+    int OwnedExtent[6];
+    int PieceRowExtent[6];
+    if(Conversion.Geometry != NULL)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            PieceExtent[i] = Piece.Extent[i];
+        }
+        if(Attribute == 1)
+        {
+            GetCellExtent(Piece.Extent,Piece.Extent,PieceExtent);
+        }
+
+        std::copy(PieceExtent,PieceExtent+6,OwnedExtent);
+        for(unsigned int Dimension = 0;
+            Attribute == 0 && Dimension < 3;
+            Dimension++)
+        {
+            if(OwnedExtent[2*Dimension+1] < \
+                    Conversion.Geometry->Extent[2*Dimension+1])
+            {
+                OwnedExtent[2*Dimension+1]--;
+            }
+        }
+
+        if(GetPieceRowExtent(OwnedExtent,Conversion.RowExtent,
+                    Options.Stride,PieceRowExtent) == false)
+        {
+            return 0;
+        }
+    }
+    else if((Attribute == 0 ? Piece.NumberOfPoints : Piece.NumberOfCells) == 0)
+    {
+        return 0;
+    }
+
+    // Header of the piece file
+    std::string SourceFilename = Piece.Source.empty() == true ?
+        Conversion.InputFilename : Piece.Source;
+    const FileHeader &SourceHeader = \
+        (*Conversion.SourceHeaders)[(*Conversion.PieceSources)[PieceIndex]];
+
+    // Read piece
+    std::vector<vtkDataArray*> SelectedArrays;
+    ImageGeometry Geometry;
+    vtkSmartPointer<vtkDataSetAttributes> InputData;
+    vtkSmartPointer<vtkXMLReader> XMLReader;
+    std::string InputString;
+
+    if(CanReadAppendedData(SourceHeader,Options) == true)
+    {
+        InputFileStream InputFile(SourceFilename.c_str());
+        if(InputFile.is_open() != true)
+        {
+            std::cerr << "Can not open input file: " << SourceFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        if(Attribute == 0)
+        {
+            InputData = vtkSmartPointer<vtkPointData>::New();
+        }
+        else
+        {
+            InputData = vtkSmartPointer<vtkCellData>::New();
+        }
+
+        const PieceHeader &SourcePiece = \
+            SourceHeader.Pieces[Piece.SourcePiece];
+        bool Structured = (Conversion.Geometry != NULL);
+        ReadAttributeArrays(
+                InputFile,
+                SourceFilename.c_str(),
+                SourceHeader,
+                Attribute == 0 ? SourcePiece.PointArrays :
+                                 SourcePiece.CellArrays,
+                Structured == true ? PieceExtent : NULL,
+                Structured == true ? PieceRowExtent : NULL,
+                NULL,
+                Options.Stride,
+                Options,
+                InputData);
+
+        SelectArrays(InputData,Options,SelectedArrays);
+
+        if(Structured == true)
+        {
+            Geometry = *Conversion.Geometry;
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                Geometry.Extent[i] = PieceRowExtent[i];
+            }
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                Geometry.Stride[i] = Options.Stride[i];
+            }
+        }
+    }
+    else
+    {
+        XMLReader = vtkSmartPointer<vtkXMLReader>::Take(
+                NewXMLPieceReader(Conversion.Header->FileType));
+        SetXMLReaderInput(XMLReader,SourceFilename.c_str(),InputString);
+        SelectReaderArrays(
+                XMLReader->GetPointDataArraySelection(),
+                XMLReader->GetCellDataArraySelection(),
+                Options);
+        XMLReader->UpdatePiece(Piece.SourcePiece,Piece.NumberOfSourcePieces,0);
+
+        vtkDataSet *InputDataSet = vtkDataSet::SafeDownCast(
+                XMLReader->GetOutputDataObject(0));
+        if(InputDataSet == NULL)
+        {
+            std::cerr << "Can not read piece file: " << SourceFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        SelectArrays(
+                Attribute == 0 ?
+                    static_cast<vtkDataSetAttributes*>(
+                        InputDataSet->GetPointData()) :
+                    static_cast<vtkDataSetAttributes*>(
+                        InputDataSet->GetCellData()),
+                Options,
+                SelectedArrays);
+
+        if(Attribute == 0 && Options.WritePoints == true)
+        {
+            vtkPointSet *InputPointSet = \
+                vtkPointSet::SafeDownCast(InputDataSet);
+            if(InputPointSet == NULL || InputPointSet->GetPoints() == NULL)
+            {
+                std::cerr << "DataSet has no explicit point coordinates.";
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+
+            SelectedArrays.push_back(InputPointSet->GetPoints()->GetData());
+        }
+
+        vtkImageData *InputImageData = vtkImageData::SafeDownCast(
+                InputDataSet);
+        if(InputImageData != NULL)
+        {
+            InputImageData->GetExtent(Geometry.Extent);
+            InputImageData->GetOrigin(Geometry.Origin);
+            InputImageData->GetSpacing(Geometry.Spacing);
+            if(Attribute == 1)
+            {
+                GetCellExtent(Geometry.Extent,Geometry.Extent,
+                        Geometry.Extent);
+            }
+        }
+    }
+
+    // Runs of rows that are contiguous in the output
+    std::vector<int> RunExtents;
+    unsigned long long NumberOfRunRows = 0;
+    if(Conversion.Geometry != NULL)
+    {
+        NumberOfRunRows = 1;
+        bool WholeRows = true;
+        for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+        {
+            if(WholeRows == true)
+            {
+                NumberOfRunRows *= (PieceRowExtent[2*Dimension+1] -
+                        PieceRowExtent[2*Dimension]) /
+                        Options.Stride[Dimension] + 1;
+            }
+
+            WholeRows = WholeRows &&
+                PieceRowExtent[2*Dimension] == \
+                    Conversion.RowExtent[2*Dimension] &&
+                PieceRowExtent[2*Dimension+1] == \
+                    Conversion.RowExtent[2*Dimension+1];
+        }
+
+        GetSlabExtents(PieceRowExtent,Options.Stride,NumberOfRunRows,
+                RunExtents);
+    }
+    else
+    {
+        RunExtents.assign(6,0);
+    }
+
+    unsigned long long NumberOfWrittenRows = 0;
+    for(unsigned int RunIterator = 0;
+        RunIterator < RunExtents.size() / 6;
+        RunIterator++)
+    {
+        const int *RunExtent = &RunExtents[6*RunIterator];
+
+        OutputMatrix Matrix;
+        unsigned long long RowId = 0;
+        if(Conversion.Geometry != NULL)
+        {
+            ConversionOptions RunOptions = Options;
+            RunOptions.ExtractExtent = true;
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                RunOptions.Extent[i] = RunExtent[i];
+            }
+
+            int FirstIndex[3] = {RunExtent[0],RunExtent[2],RunExtent[4]};
+            RowId = GetExtentRowId(Conversion.RowExtent,Options.Stride,
+                    FirstIndex);
+            BuildOutputMatrix(SelectedArrays,&Geometry,RunOptions,Matrix);
+        }
+        else
+        {
+            RowId = Conversion.RowOffsets[PieceIndex];
+            BuildOutputMatrix(SelectedArrays,NULL,Options,Matrix);
+        }
+
+        if(Matrix.NumberOfColumns != Conversion.NumberOfColumns)
+        {
+            std::cerr << "Inconsistent pieces: piece " << PieceIndex;
+            std::cerr << " has " << Matrix.NumberOfColumns << " instead of ";
+            std::cerr << Conversion.NumberOfColumns << " columns.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        OutputFile.seekp(RowId * Matrix.NumberOfColumns * sizeof(double));
+        WriteArraysToBinaryFile(OutputFile,Matrix,RowId);
+        NumberOfWrittenRows += Matrix.NumberOfRows;
+    }
+
+    return NumberOfWrittenRows;
+}
+
+// ==========================
+// Get Selected Array Headers
+// ==========================
+
+// Description:
+// The headers of the selected arrays, in the same order as SelectArrays
+// selects the arrays that are read.
+
+void GetSelectedArrayHeaders(
+        const std::vector<ArrayHeader> &Arrays,
+        const ConversionOptions &Options,
+        std::vector<ArrayHeader> &SelectedArrays)  // Output
+{
+    SelectedArrays.clear();
+
+    if(Options.ArrayNames.empty() == true)
+    {
+        SelectedArrays = Arrays;
+        return;
+    }
+
+    for(unsigned int NameIterator = 0;
+        NameIterator < Options.ArrayNames.size();
+        NameIterator++)
+    {
+        bool Found = false;
+        for(unsigned int ArrayIterator = 0;
+            Found == false && ArrayIterator < Arrays.size();
+            ArrayIterator++)
+        {
+            if(Arrays[ArrayIterator].Name == Options.ArrayNames[NameIterator])
+            {
+                SelectedArrays.push_back(Arrays[ArrayIterator]);
+                Found = true;
+            }
+        }
+
+        if(Found == false &&
+           (Options.WritePointData == false ||
+            Options.WriteCellData == false))
+        {
+            std::cerr << "Array not found: ";
+            std::cerr << Options.ArrayNames[NameIterator] << std::endl;
+            throw ConversionError();
+        }
+    }
+}
+
+// ====================
+// Get Piece Row Extent
+// ====================
+
+// Description:
+// The rows of the whole RowExtent at the Stride that are in the extent of a
+// piece. The first index is moved up to the first index of the whole rows
+// at the stride. Returns false if the piece has no such rows.
+
+bool GetPieceRowExtent(
+        const int PieceExtent[6],
+        const int RowExtent[6],
+        const int Stride[3],
+        int PieceRowExtent[6])                // Output
+{
+    if(IntersectExtents(PieceExtent,RowExtent,PieceRowExtent) == false)
+    {
+        return false;
+    }
+
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        int Offset = PieceRowExtent[2*Dimension] - RowExtent[2*Dimension];
+        int Steps = (Offset + Stride[Dimension] - 1) / Stride[Dimension];
+        PieceRowExtent[2*Dimension] = RowExtent[2*Dimension] + \
+                                      Steps * Stride[Dimension];
+
+        if(PieceRowExtent[2*Dimension] > PieceRowExtent[2*Dimension+1])
+        {
+            return false;
+        }
+    }
+
+    AlignExtentToStride(PieceRowExtent,Stride);
+    return true;
+}
+
+// =================
+// Get Extent Row Id
+// =================
+
+// Description:
+// Row of the point at Index among the rows of RowExtent at the Stride, with
+// i varying fastest.
+
+unsigned long long GetExtentRowId(
+        const int RowExtent[6],
+        const int Stride[3],
+        const int Index[3])
+{
+    unsigned long long RowId = 0;
+    for(int Dimension = 2; Dimension >= 0; Dimension--)
+    {
+        unsigned long long Size = (RowExtent[2*Dimension+1] -
+                RowExtent[2*Dimension]) / Stride[Dimension] + 1;
+        RowId = RowId * Size + (Index[Dimension] - RowExtent[2*Dimension]) / \
+                Stride[Dimension];
+    }
+
+    return RowId;
+}
+
+// =====================
+// Get Number Of Threads
+// =====================
+
+// Description:
+// The --threads option, or the number of cores, but not more than the
+// number of tasks.
+
+unsigned int GetNumberOfThreads(
+        const ConversionOptions &Options,
+        unsigned int NumberOfTasks)
+{
+    unsigned int NumberOfThreads = Options.NumberOfThreads;
+    if(NumberOfThreads == 0)
+    {
+        NumberOfThreads = std::max(1U,std::thread::hardware_concurrency());
+    }
+
+    return std::max(1U,std::min(NumberOfThreads,NumberOfTasks));
+}
+
+// =======================
+// Get Number Of Slab Rows
+// =======================
+
+// Description:
+// Number of rows of a slab, such that the arrays of a slab and the buffer
+// of the conversion fit in the memory limit. A slab has at least one row.
+
+unsigned long long GetNumberOfSlabRows(
+        unsigned long long RowBytes,
+        const ConversionOptions &Options)
+{
+    unsigned long long AvailableBytes = Options.MemoryLimit / 2;
+    if(Options.MemoryLimit > 2 * BUFFER_SIZE)
+    {
+        AvailableBytes = Options.MemoryLimit - BUFFER_SIZE;
+    }
+
+    return std::max(1ULL,AvailableBytes / std::max(1ULL,RowBytes));
+}
+
+// ================
+// Get Slab Extents
+// ================
+
+// Description:
+// Divides the rows of an extent at a stride into slabs of at most
+// NumberOfSlabRows rows, in the order of the rows. Slabs are sets of whole
+// k planes if a plane fits, otherwise sets of whole rows of one plane if a
+// row fits, otherwise parts of one row.
+
+void GetSlabExtents(
+        const int RowExtent[6],
+        const int Stride[3],
+        unsigned long long NumberOfSlabRows,
+        std::vector<int> &SlabExtents)        // Output, 6 per slab
+{
+    SlabExtents.clear();
+
+    long long Size[3];
+    for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+    {
+        Size[Dimension] = (RowExtent[2*Dimension+1] -
+                           RowExtent[2*Dimension]) / Stride[Dimension] + 1;
+    }
+
+    // Whole extent in one slab
+    if(GetNumberOfExtentTuples(RowExtent,Stride) <= NumberOfSlabRows ||
+       Size[0] <= 0)
+    {
+        SlabExtents.assign(RowExtent,RowExtent+6);
+        return;
+    }
+
+    // Number of planes, rows and points of a slab, in the slab direction
+    unsigned int Direction = 2;
+    long long Step = NumberOfSlabRows / (Size[0] * Size[1]);
+    if(Step == 0)
+    {
+        Direction = 1;
+        Step = NumberOfSlabRows / Size[0];
+    }
+    if(Step == 0)
+    {
+        Direction = 0;
+        Step = NumberOfSlabRows;
+    }
+
+    // Iterate over the rows (j,k) or planes (k) outside of the slab
+    // direction, and divide the slab direction into steps
+    long long NumberOfOuter = 1;
+    for(unsigned int Dimension = Direction + 1; Dimension < 3; Dimension++)
+    {
+        NumberOfOuter *= Size[Dimension];
+    }
+
+    for(long long Outer = 0; Outer < NumberOfOuter; Outer++)
+    {
+        for(long long First = 0; First < Size[Direction]; First += Step)
+        {
+            int Slab[6];
+            long long Remainder = Outer;
+            for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+            {
+                const int *Range = RowExtent + 2*Dimension;
+                if(Dimension < Direction)
+                {
+                    Slab[2*Dimension] = Range[0];
+                    Slab[2*Dimension+1] = Range[1];
+                }
+                else if(Dimension == Direction)
+                {
+                    long long Last = std::min(First + Step,Size[Dimension]) - 1;
+                    Slab[2*Dimension] = Range[0] + First * Stride[Dimension];
+                    Slab[2*Dimension+1] = Range[0] + Last * Stride[Dimension];
+                }
+                else
+                {
+                    long long Index = Remainder % Size[Dimension];
+                    Remainder /= Size[Dimension];
+                    Slab[2*Dimension] = Range[0] + Index * Stride[Dimension];
+                    Slab[2*Dimension+1] = Slab[2*Dimension];
+                }
+            }
+
+            SlabExtents.insert(SlabExtents.end(),Slab,Slab+6);
+        }
+    }
+}
+
+// ==============================
+// Write Topology To Output Files
+// ==============================
+
+// Description:
+// Writes the cells of an unstructured grid or polydata as separate raw
+// files, directly from the contiguous buffers of vtkCellArray:
+//
+//    OutputFile.offsets.raw        Offsets of cells into connectivity, the
+//                                  last offset is the connectivity size.
+//    OutputFile.connectivity.raw   Point ids of all cells.
+//    OutputFile.types.raw          VTK cell type of each cell (unstructured
+//                                  grid only).
+//
+// For polydata, the verts, lines, polys and strips cell arrays are written
+// with their name in the file name, such as OutputFile.polys.offsets.raw,
+// and only if they are not empty.
+//
+// The files are written in the binary form of the array types, such as
+// Int64 for offsets and UInt8 for cell types, and are not converted to
+// double. The type of each file is printed.
+
+void WriteTopologyToOutputFiles(
+        vtkDataSet *InputDataSet,
+        const char *OutputFilename)
+{
+    vtkUnstructuredGrid *InputUnstructuredGrid = \
+        vtkUnstructuredGrid::SafeDownCast(InputDataSet);
+    vtkPolyData *InputPolyData = vtkPolyData::SafeDownCast(InputDataSet);
+
+    if(InputUnstructuredGrid != NULL)
+    {
+        vtkCellArray *Cells = InputUnstructuredGrid->GetCells();
+        WriteArrayBufferToBinaryFile(
+                Cells->GetOffsetsArray(),
+                MakeDerivedFilename(OutputFilename,"offsets").c_str());
+        WriteArrayBufferToBinaryFile(
+                Cells->GetConnectivityArray(),
+                MakeDerivedFilename(OutputFilename,"connectivity").c_str());
+        WriteArrayBufferToBinaryFile(
+                InputUnstructuredGrid->GetCellTypesArray(),
+                MakeDerivedFilename(OutputFilename,"types").c_str());
+    }
+    else if(InputPolyData != NULL)
+    {
+        vtkCellArray *Cells[4] = {
+            InputPolyData->GetVerts(),
+            InputPolyData->GetLines(),
+            InputPolyData->GetPolys(),
+            InputPolyData->GetStrips()};
+        const char *CellsNames[4] = {"verts","lines","polys","strips"};
+
+        for(unsigned int CellsIterator = 0;
+            CellsIterator < 4;
+            CellsIterator++)
+        {
+            if(Cells[CellsIterator] == NULL ||
+               Cells[CellsIterator]->GetNumberOfCells() == 0)
+            {
+                continue;
+            }
+
+            std::string CellsName(CellsNames[CellsIterator]);
+            WriteArrayBufferToBinaryFile(
+                    Cells[CellsIterator]->GetOffsetsArray(),
+                    MakeDerivedFilename(OutputFilename,
+                        CellsName+".offsets").c_str());
+            WriteArrayBufferToBinaryFile(
+                    Cells[CellsIterator]->GetConnectivityArray(),
+                    MakeDerivedFilename(OutputFilename,
+                        CellsName+".connectivity").c_str());
+        }
+    }
+    else
+    {
+        std::cerr << "DataSet has no explicit cells. Topology is written ";
+        std::cerr << "only for unstructured grid and polydata." << std::endl;
+        throw ConversionError();
+    }
+}
+
+// =================================
+// Write Array Buffer To Binary File
+// =================================
+
+// Description:
+// Writes the memory of an array as it is, in one write.
+
+void WriteArrayBufferToBinaryFile(
+        vtkDataArray *InputDataArray,
+        const char *OutputFilename)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    OutputFileStream OutputFile;
+    OpenFile(OutputFilename,true,OutputFile);
+
+    unsigned long long NumberOfBytes = \
+        static_cast<unsigned long long>(InputDataArray->GetNumberOfValues()) *
+        InputDataArray->GetDataTypeSize();
+    if(NumberOfBytes > 0)
+    {
+        OutputFile.write(
+                static_cast<const char*>(InputDataArray->GetVoidPointer(0)),
+                NumberOfBytes);
+    }
+
+    if(OutputFile.good() != true)
+    {
+        std::cerr << "Can not write output file: " << OutputFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    OutputFile.close();
+
+    Messages << InputDataArray->GetNumberOfValues() << " values of type ";
+    Messages << GetDataTypeName(InputDataArray->GetDataType());
+    Messages << " were written to: " << OutputFilename << "." << std::endl;
+}
+
+// ===========================
+// Write Arrays To Output File
+// ===========================
+
+// Description:
+// This method writes the arrays selected from the PointData (or CellData) of
+// the DataSet.
+// - Each array may have different number of components.
+// - But all arrays should have the same number of tuples.
+//
+// The output is written to OutputFile as following:
+// The output array is an array of size:
+//     "Number of total components of all arrays" x "number of tuples".
+//
+//  where, the "Number of total components of all arrays" is the sum of number
+//  of components of all arrays. If we have found three Arrays:
+//
+//  Array A: size a * m
+//  Array B: size b * m
+//  Array C: size c * m
+//
+//  Then the output array is of size (a+b+c) * m, and is written as follow
+//
+//              Column 1         Column 2         Column 3
+//
+//  First row:    A11 A12 A13 ...  B11 B12 B13 ...  C11 C12 C13 ...
+//  Second row:   A21 A22 A23 ...  B21 B22 B23 ...  C21 C22 C23 ...
+//                <-- a times -->  <-- b times -->  <-- c times -->
+//                ...
+//                ...
+//  m-th row:     Am1 Am2 Am3 ...  Bm1 Bm2 Bm3 ...  Cm1 Cm2 Cm3 ...
+
+void WriteArraysToOutputFile(
+        const std::vector<vtkDataArray*> &SelectedArrays,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    bool BinaryOutputFile = Options.BinaryOutputFile;
+
+    // Columns and rows of the output
+    OutputMatrix Matrix;
+    BuildOutputMatrix(SelectedArrays,Geometry,Options,Matrix);
+    PrintOutputMatrix(Matrix);
+
+    // Open output file, or the shared memory sized to the matrix
+    OutputFileStream OutputFile;
+    ShardLayout Shards;
+    std::vector<unsigned long> ShardChecksums;
+    if(Options.SharedMemoryOutput == true)
+    {
+        CreateMatrixSharedMemory(OutputFilename,Matrix,Matrix.NumberOfRows);
+        OutputFile.OpenSharedMemory(OutputFilename);
+    }
+    else if(IsShardedOutput(Options) == true)
+    {
+        GetShardLayout(OutputFilename,Matrix.NumberOfRows,
+                Matrix.NumberOfColumns,Options,Shards);
+        CreateShards(Shards);
+    }
+    else if(Options.RegionOutput == true)
+    {
+        OpenFileRegion(OutputFilename,Matrix.NumberOfRows,
+                Matrix.NumberOfColumns,Options,OutputFile);
+    }
+    else
+    {
+        OpenFile(OutputFilename,BinaryOutputFile,OutputFile);
+    }
+
+    // Write to ASCII or Binary
+    if(BinaryOutputFile == false)
+    {
+        // Write to ASCII file
+        WriteArraysToASCIIFile(OutputFile,Matrix,0);
+    }
+    else if(IsShardedOutput(Options) == true)
+    {
+        // Write shards concurrently
+        WriteArraysToShards(Matrix,Shards,Options,ShardChecksums);
+    }
+    else
+    {
+        // Write to Binary file
+        WriteArraysToBinaryFile(OutputFile,Matrix,0);
+    }
+
+    Messages << Matrix.Arrays.size();
+    Messages << " arrays in column-wise order as above were written to: ";
+    Messages << OutputFilename << "." << std::endl;
+    Messages << "Rows: " << Matrix.NumberOfRows << ", Columns: ";
+    Messages << Matrix.NumberOfColumns << "." << std::endl;
+
+    // Rows written to the shared memory, which are written in order
+    unsigned long long NumberOfWrittenRows = Matrix.NumberOfRows;
+    unsigned long long RowBytes = Matrix.NumberOfColumns * sizeof(double);
+    if(Options.SharedMemoryOutput == true && RowBytes > 0)
+    {
+        NumberOfWrittenRows = static_cast<unsigned long long>(
+                OutputFile.tellp()) / RowBytes;
+    }
+
+    // Close file
+    OutputFile.close();
+
+    if(Options.SharedMemoryOutput == true)
+    {
+        PublishSharedMemory(OutputFilename,NumberOfWrittenRows);
+    }
+    else if(IsShardedOutput(Options) == true)
+    {
+        PublishShards(Shards,OutputFilename,Options,&ShardChecksums);
+    }
+}
+
+// ===================
+// Print Output Matrix
+// ===================
+
+// Description:
+// Prints the arrays of the columns, and the shape of image data rows.
+
+void PrintOutputMatrix(const OutputMatrix &Matrix)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    unsigned int NumberOfArrays = Matrix.Arrays.size();
+
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < NumberOfArrays;
+        ArrayIterator++)
+    {
+        Messages << "Array: " << ArrayIterator << ", NumberOfComponents: ";
+        Messages << Matrix.NumberOfComponents[ArrayIterator];
+        Messages << ", NumberOfTuples: ";
+        Messages << Matrix.Arrays[ArrayIterator]->GetNumberOfTuples();
+        Messages << ", ArrayName: ";
+        const char *ArrayName = Matrix.Arrays[ArrayIterator]->GetName();
+        Messages << (ArrayName != NULL ? ArrayName : "");
+        Messages << std::endl;
+    }
+
+    if(Matrix.Structured == true)
+    {
+        // Shape of the (sub-)volume or plane, i varies fastest
+        Messages << "Points: ";
+        for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+        {
+            Messages << (Dimension > 0 ? " x " : "");
+            Messages << (Matrix.RowExtent[2*Dimension+1] -
+                          Matrix.RowExtent[2*Dimension]) /
+                         Matrix.RowStride[Dimension] + 1;
+        }
+        Messages << ", Extent:";
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Messages << " " << Matrix.RowExtent[i];
+        }
+        Messages << std::endl;
+    }
+
+    if(Matrix.Coordinates != COORDINATES_NONE)
+    {
+        Messages << "Coordinates: ";
+        Messages << (Matrix.Coordinates == COORDINATES_XYZ ?
+                "x, y, z" : "i, j, k");
+        Messages << std::endl;
+    }
+}
+
+// ===================
+// Build Output Matrix
+// ===================
+
+// Description:
+// Describes the output matrix: the arrays of its columns, followed by the
+// implicit coordinate columns if requested, and its rows.
+//
+// Rows are the tuples of the arrays. For image data (Geometry is not NULL),
+// the arrays hold the tuples of the extent of the geometry at its stride,
+// and row r is the tuple with structured index (i,j,k) in the row extent at
+// the row stride, where i varies fastest. The row extent is the extent of
+// the geometry, or the part of it in the sub-volume of the --extent option,
+// and the row stride is the --stride option. If a reader has already read
+// only these tuples, the geometry has the same extent and stride, and all
+// its tuples are written. The coordinates of a point are computed from its
+// index as origin + index * spacing.
+
+void BuildOutputMatrix(
+        const std::vector<vtkDataArray*> &SelectedArrays,
+        const ImageGeometry *Geometry,
+        const ConversionOptions &Options,
+        OutputMatrix &Matrix)                 // Output
+{
+    Matrix.Arrays = SelectedArrays;
+    Matrix.NumberOfComponents.resize(SelectedArrays.size());
+    Matrix.NumberOfColumns = 0;
+    Matrix.NumberOfRows = 0;
+    Matrix.Coordinates = Options.Coordinates;
+
+    // Implicit coordinates need the image geometry
+    if(Matrix.Coordinates != COORDINATES_NONE && Geometry == NULL)
+    {
+        std::cerr << "Implicit coordinates are only available for point ";
+        std::cerr << "data of image data and structured points." << std::endl;
+        throw ConversionError();
+    }
+
+    // So do a sub-volume and a stride
+    bool Strided = (Options.Stride[0] > 1 || Options.Stride[1] > 1 ||
+                    Options.Stride[2] > 1);
+    if((Options.ExtractExtent == true || Strided == true) && Geometry == NULL)
+    {
+        std::cerr << "Options --extent, --slice and --stride are only ";
+        std::cerr << "available for image data and structured points.";
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // Check for empty arrays
+    if(Matrix.Arrays.empty() == true &&
+       Matrix.Coordinates == COORDINATES_NONE)
+    {
+        std::cerr << "DataSet has no array." << std::endl;
+        throw ConversionError();
+    }
+
+    // Structured rows
+    unsigned long long NumberOfGeometryTuples = 0;
+    Matrix.Structured = (Geometry != NULL);
+    if(Matrix.Structured == true)
+    {
+        Matrix.Geometry = *Geometry;
+        GetExtractExtent(Geometry->Extent,Options,Matrix.RowExtent);
+
+        for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+        {
+            Matrix.RowStride[Dimension] = Options.Stride[Dimension];
+        }
+
+        NumberOfGeometryTuples = GetNumberOfExtentTuples(
+                Geometry->Extent,Geometry->Stride);
+        Matrix.NumberOfRows = GetNumberOfExtentTuples(
+                Matrix.RowExtent,Matrix.RowStride);
+    }
+
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Matrix.Arrays.size();
+        ArrayIterator++)
+    {
+        // Check array
+        if(Matrix.Arrays[ArrayIterator] == NULL)
+        {
+            std::cerr << "Array " << ArrayIterator << " is NULL." << std::endl;
+            throw ConversionError();
+        }
+
+        // Get number of components
+        Matrix.NumberOfComponents[ArrayIterator] = \
+            Matrix.Arrays[ArrayIterator]->GetNumberOfComponents();
+        unsigned long long NumberOfTuples = \
+            Matrix.Arrays[ArrayIterator]->GetNumberOfTuples();
+
+        // Check tuples
+        if(ArrayIterator == 0 && Matrix.Structured == false)
+        {
+            Matrix.NumberOfRows = NumberOfTuples;
+        }
+        else if(NumberOfTuples != (Matrix.Structured == true ?
+                    NumberOfGeometryTuples : Matrix.NumberOfRows))
+        {
+            std::cerr << "Inconsistent file: ";
+            std::cerr << "number of tuples in arrays are not the same.";
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+
+        // Update total number of columns
+        Matrix.NumberOfColumns += Matrix.NumberOfComponents[ArrayIterator];
+    }
+
+    if(Matrix.Coordinates != COORDINATES_NONE)
+    {
+        Matrix.NumberOfColumns += 3;
+    }
+}
+
+// ===================
+// Convert Matrix Rows
+// ===================
+
+// Description:
+// Converts a block of consecutive rows of the output matrix to doubles in
+// row-major order. Any block of rows can be converted independently.
+//
+// The tuple id (and the structured index for image data) of each row is
+// computed first. For image data, rows run over the row extent, and tuple
+// ids over the extent of the geometry. Then each array is converted with a
+// loop specialized to its value type, reading directly from the array
+// memory. Implicit coordinates are computed from the structured index of
+// each row, so that the coordinates are never stored as a vtkPoints array.
+
+void ConvertMatrixRows(
+        const OutputMatrix &Matrix,
+        unsigned long long FirstRow,
+        unsigned long long NumberOfRows,
+        std::vector<vtkIdType> &TupleIds,     // Work space
+        std::vector<int> &Indices,            // Work space
+        double *Buffer)                       // Output
+{
+    // Tuple ids of rows
+    TupleIds.resize(NumberOfRows);
+
+    if(Matrix.Structured == false)
+    {
+        for(unsigned long long RowIterator = 0;
+            RowIterator < NumberOfRows;
+            RowIterator++)
+        {
+            TupleIds[RowIterator] = FirstRow + RowIterator;
+        }
+    }
+    else
+    {
+        const int *Extent = Matrix.Geometry.Extent;
+        const int *Stride = Matrix.Geometry.Stride;
+        const int *RowExtent = Matrix.RowExtent;
+        const int *RowStride = Matrix.RowStride;
+        long long Size[2] = {
+            (Extent[1] - Extent[0]) / Stride[0] + 1,
+            (Extent[3] - Extent[2]) / Stride[1] + 1};
+        long long RowSize[2] = {
+            (RowExtent[1] - RowExtent[0]) / RowStride[0] + 1,
+            (RowExtent[3] - RowExtent[2]) / RowStride[1] + 1};
+
+        Indices.resize(3*NumberOfRows);
+        for(unsigned long long RowIterator = 0;
+            RowIterator < NumberOfRows;
+            RowIterator++)
+        {
+            // Structured index of the row
+            unsigned long long Row = FirstRow + RowIterator;
+            int *Index = &Indices[3*RowIterator];
+            Index[0] = RowExtent[0] + (Row % RowSize[0]) * RowStride[0];
+            Index[1] = RowExtent[2] + \
+                       ((Row / RowSize[0]) % RowSize[1]) * RowStride[1];
+            Index[2] = RowExtent[4] + \
+                       (Row / (RowSize[0] * RowSize[1])) * RowStride[2];
+
+            // Tuple of the index in the geometry
+            long long I = (Index[0] - Extent[0]) / Stride[0];
+            long long J = (Index[1] - Extent[2]) / Stride[1];
+            long long K = (Index[2] - Extent[4]) / Stride[2];
+            TupleIds[RowIterator] = I + Size[0] * (J + Size[1] * K);
+        }
+    }
+
+    // Arrays
+    unsigned int ColumnOffset = 0;
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Matrix.Arrays.size();
+        ArrayIterator++)
+    {
+        vtkDataArray *InputDataArray = Matrix.Arrays[ArrayIterator];
+        unsigned int NumberOfComponents = \
+            Matrix.NumberOfComponents[ArrayIterator];
+
+        if(InputDataArray->HasStandardMemoryLayout() == true)
+        {
+            void *Values = InputDataArray->GetVoidPointer(0);
+            switch(InputDataArray->GetDataType())
+            {
+                vtkTemplateMacro(
+                        ConvertArrayRows(
+                            static_cast<const VTK_TT*>(Values),
+                            NumberOfComponents,
+                            &TupleIds[0],
+                            NumberOfRows,
+                            Matrix.NumberOfColumns,
+                            ColumnOffset,
+                            Buffer));
+                default:
+                    std::cerr << "Unsupported data type: ";
+                    std::cerr << GetDataTypeName(
+                            InputDataArray->GetDataType()) << std::endl;
+                    throw ConversionError();
+            }
+        }
+        else
+        {
+            // Arrays that are not stored as contiguous tuples
+            for(unsigned long long RowIterator = 0;
+                RowIterator < NumberOfRows;
+                RowIterator++)
+            {
+                double *Row = Buffer + RowIterator * Matrix.NumberOfColumns;
+                for(unsigned int ComponentIterator = 0;
+                    ComponentIterator < NumberOfComponents;
+                    ComponentIterator++)
+                {
+                    Row[ColumnOffset+ComponentIterator] = \
+                        InputDataArray->GetComponent(
+                                TupleIds[RowIterator],ComponentIterator);
+                }
+            }
+        }
+
+        ColumnOffset += NumberOfComponents;
+    }
+
+    // Implicit coordinates
+    if(Matrix.Coordinates != COORDINATES_NONE)
+    {
+        double Origin[3] = {0.0,0.0,0.0};
+        double Spacing[3] = {1.0,1.0,1.0};
+        if(Matrix.Coordinates == COORDINATES_XYZ)
+        {
+            for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+            {
+                Origin[Dimension] = Matrix.Geometry.Origin[Dimension];
+                Spacing[Dimension] = Matrix.Geometry.Spacing[Dimension];
+            }
+        }
+
+        for(unsigned long long RowIterator = 0;
+            RowIterator < NumberOfRows;
+            RowIterator++)
+        {
+            double *Row = Buffer + RowIterator * Matrix.NumberOfColumns + \
+                          ColumnOffset;
+            const int *Index = &Indices[3*RowIterator];
+            Row[0] = Origin[0] + Index[0] * Spacing[0];
+            Row[1] = Origin[1] + Index[1] * Spacing[1];
+            Row[2] = Origin[2] + Index[2] * Spacing[2];
+        }
+    }
+}
+
+// ==================
+// Convert Array Rows
+// ==================
+
+// Description:
+// Copies the components of the given tuples of one array into their columns
+// of the row-major buffer, converting them to double.
+
+template <class ValueType>
+void ConvertArrayRows(
+        const ValueType *Values,
+        unsigned int NumberOfComponents,
+        const vtkIdType *TupleIds,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        unsigned int ColumnOffset,
+        double *Buffer)                       // Output
+{
+    for(unsigned long long RowIterator = 0;
+        RowIterator < NumberOfRows;
+        RowIterator++)
+    {
+        const ValueType *Tuple = \
+            Values + TupleIds[RowIterator] * NumberOfComponents;
+        double *Row = Buffer + RowIterator * NumberOfColumns + ColumnOffset;
+
+        for(unsigned int ComponentIterator = 0;
+            ComponentIterator < NumberOfComponents;
+            ComponentIterator++)
+        {
+            Row[ComponentIterator] = static_cast<double>(
+                    Tuple[ComponentIterator]);
+        }
+    }
+}
+
+// ========================
+// Get Number Of Block Rows
+// ========================
+
+// Description:
+// Number of rows that are converted at once, such that a block of rows has
+// about BUFFER_SIZE bytes.
+
+unsigned long long GetNumberOfBlockRows(const OutputMatrix &Matrix)
+{
+    unsigned long long RowSize = \
+        std::max(1U,Matrix.NumberOfColumns) * sizeof(double);
+    return std::max(1ULL,BUFFER_SIZE / RowSize);
+}
+
+// =============
+// Select Arrays
+// =============
+
+// Description:
+// Returns all data arrays of the point or cell data, or only the arrays
+// named in the options, in the order they are given. When both point and
+// cell data are written, names that are not found are skipped, since they
+// may belong to the other attribute.
+
+void SelectArrays(
+        vtkDataSetAttributes *InputData,
+        const ConversionOptions &Options,
+        std::vector<vtkDataArray*> &SelectedArrays)  // Output
+{
+    SelectedArrays.clear();
+
+    if(Options.ArrayNames.empty() == true)
+    {
+        for(int ArrayIterator = 0;
+            ArrayIterator < InputData->GetNumberOfArrays();
+            ArrayIterator++)
+        {
+            SelectedArrays.push_back(InputData->GetArray(ArrayIterator));
+        }
+
+        return;
+    }
+
+    for(unsigned int NameIterator = 0;
+        NameIterator < Options.ArrayNames.size();
+        NameIterator++)
+    {
+        vtkDataArray *SelectedArray = InputData->GetArray(
+                Options.ArrayNames[NameIterator].c_str());
+
+        if(SelectedArray == NULL &&
+           Options.WritePointData == true &&
+           Options.WriteCellData == true)
+        {
+            continue;
+        }
+        else if(SelectedArray == NULL)
+        {
+            std::cerr << "Array not found: ";
+            std::cerr << Options.ArrayNames[NameIterator] << std::endl;
+            throw ConversionError();
+        }
+
+        SelectedArrays.push_back(SelectedArray);
+    }
+}
+
+// =====================
+// Make Derived Filename
+// =====================
+
+// Description:
+// Inserts a suffix before the extension of a file name, such that
+// "Output.raw" with suffix "cell" becomes "Output.cell.raw". If the file
+// name has no extension, the suffix is appended.
+
+std::string MakeDerivedFilename(
+        const std::string &Filename,
+        const std::string &Suffix)
+{
+    std::size_t LastSlash = Filename.find_last_of("/");
+    std::size_t LastDot = Filename.find_last_of(".");
+
+    if(LastDot == std::string::npos ||
+       (LastSlash != std::string::npos && LastDot < LastSlash) ||
+       LastDot == 0 || LastDot == LastSlash + 1)
+    {
+        return Filename + "." + Suffix;
+    }
+
+    return Filename.substr(0,LastDot) + "." + Suffix + \
+        Filename.substr(LastDot);
+}
+
+// ===================
+// Make Table Filename
+// ===================
+
+// Description:
+// The name of a tab separated table that describes an output file, in
+// which the extension of the output file is replaced by the suffix and
+// .txt, such that "Output.raw" with suffix "blocks" becomes
+// "Output.blocks.txt".
+
+std::string MakeTableFilename(
+        const std::string &OutputFilename,
+        const std::string &Suffix)
+{
+    std::string TableFilename = MakeDerivedFilename(OutputFilename,Suffix);
+    std::size_t Extension = TableFilename.rfind("." + Suffix) + \
+        Suffix.size() + 1;
+
+    return TableFilename.substr(0,Extension) + ".txt";
+}
+
+// =================
+// Is Array Selected
+// =================
+
+bool IsArraySelected(
+        const std::string &Name,
+        const ConversionOptions &Options)
+{
+    if(Options.ArrayNames.empty() == true)
+    {
+        return true;
+    }
+
+    return std::find(Options.ArrayNames.begin(),Options.ArrayNames.end(),
+            Name) != Options.ArrayNames.end();
+}
+
+// =========
+// Open File
+// =========
+
+void OpenFile(
+        const char *OutputFilename,
+        bool BinaryOutputFile,
+        OutputFileStream &OutputFile)
+{
+    // The standard output is written through its file descriptor, which is
+    // neither truncated nor opened again, so that it may also be a socket
+    if(strcmp(OutputFilename,STANDARD_OUTPUT) == 0)
+    {
+        OutputFile.OpenStandardOutput();
+    }
+    else if(BinaryOutputFile == false)
+    {
+        // Open ASCII file
+        OutputFile.open(OutputFilename);
+    }
+    else
+    {
+        // Open Binary file
+        OutputFile.open(OutputFilename,std::ios::binary);
+    }
+
+    // Check file is open
+    if(OutputFile.is_open() != true)
+    {
+        std::cerr << "Can not open output file: ";
+        std::cerr << OutputFilename << std::endl;
+        throw ConversionError();
+    }
+
+    OutputFile << std::setprecision(DECIMAL_PRECISION);
+}
+
+// ================
+// Open File Region
+// ================
+
+// Description:
+// Opens the region of an output file that is given by the options, such as
+// the frame of one time step of a stacked output, to write NumberOfRows
+// rows of NumberOfColumns. The file is created and sized beforehand, by the
+// caller that sets the region.
+
+void OpenFileRegion(
+        const char *OutputFilename,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        const ConversionOptions &Options,
+        OutputFileStream &OutputFile)
+{
+    CheckFileRegionSize(OutputFilename,NumberOfRows,NumberOfColumns,Options);
+
+    OutputFile.OpenRegion(OutputFilename,Options.RegionOffset,
+            Options.RegionSize);
+
+    if(OutputFile.is_open() != true)
+    {
+        std::cerr << "Can not open output file: ";
+        std::cerr << OutputFilename << std::endl;
+        throw ConversionError();
+    }
+
+    OutputFile << std::setprecision(DECIMAL_PRECISION);
+}
+
+// ======================
+// Check File Region Size
+// ======================
+
+// Description:
+// The rows that are written to a region must fill it exactly. The regions
+// of a concatenated or stacked output are laid out from the headers of the
+// files before they are read, so a file whose rows differ from its header
+// is an error before anything is written, instead of rows of the output
+// that are left unwritten, or a write past the region that fails half way.
+
+void CheckFileRegionSize(
+        const char *OutputFilename,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        const ConversionOptions &Options)
+{
+    if(NumberOfRows * NumberOfColumns * sizeof(double) != Options.RegionSize)
+    {
+        std::cerr << NumberOfRows << " rows of " << NumberOfColumns;
+        std::cerr << " columns do not fill the " << Options.RegionSize;
+        std::cerr << " bytes that were laid out for them in: ";
+        std::cerr << OutputFilename << std::endl;
+        throw ConversionError();
+    }
+}
+
+// =========================
+// Is Sequential Output File
+// =========================
+
+// Description:
+// True if the output is the standard output ("-"), or a named pipe or a
+// device, which can only be written in order, without seeking. Pieces are
+// then not written at their offsets by a pool of threads.
+
+bool IsSequentialOutputFile(const char *OutputFilename)
+{
+    if(strcmp(OutputFilename,STANDARD_OUTPUT) == 0)
+    {
+        return true;
+    }
+
+    struct stat Status;
+    if(stat(OutputFilename,&Status) != 0)
+    {
+        return false;
+    }
+
+    return S_ISFIFO(Status.st_mode) || S_ISCHR(Status.st_mode) ||
+           S_ISSOCK(Status.st_mode);
+}
+
+// =====================
+// Is Shared Memory Name
+// =====================
+
+// Description:
+// A portable POSIX shared memory name is "/" followed by a name without
+// any other "/", such as /vtk2raw.
+
+bool IsSharedMemoryName(const char *Name)
+{
+    return Name[0] == '/' && Name[1] != '\0' && strchr(Name+1,'/') == NULL;
+}
+
+// ====================
+// Create Shared Memory
+// ====================
+
+// Description:
+// Creates the shared memory segment of an output matrix of NumberOfRows x
+// NumberOfColumns doubles, with its header, whose Ready flag is 0 until
+// PublishSharedMemory. The header is followed by a JSON description of the
+// columns, such as
+//
+//   {"shape":[1000,4],"dtype":"float64","arrays":[{"name":"u",
+//   "components":3},{"name":"p","components":1}],"coordinates":"none"}
+//
+// The matrix starts at the next page, so a consumer can map it as an array
+// without copying it. The memory of the segment is allocated here, so that
+// a full /dev/shm is reported before any row is converted.
+//
+// An existing segment of the same name is unlinked first, such that a
+// consumer that still maps it keeps its data. A segment that is not
+// published, because the conversion failed, is removed at exit.
+
+static std::string UnpublishedSharedMemory;
+
+void CreateSharedMemory(
+        const char *Name,
+        const std::vector<std::string> &ArrayNames,
+        const std::vector<unsigned int> &NumberOfComponents,
+        CoordinatesType Coordinates,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    // Description of the columns
+    std::ostringstream Description;
+    Description << "{\"shape\":[" << NumberOfRows << "," << NumberOfColumns;
+    Description << "],\"dtype\":\"float64\",\"arrays\":[";
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < ArrayNames.size();
+        ArrayIterator++)
+    {
+        Description << (ArrayIterator > 0 ? "," : "");
+        Description << "{\"name\":\"";
+        Description << EscapeJSONString(ArrayNames[ArrayIterator]);
+        Description << "\",\"components\":";
+        Description << NumberOfComponents[ArrayIterator] << "}";
+    }
+    Description << "],\"coordinates\":\"";
+    Description << (Coordinates == COORDINATES_XYZ ? "xyz" :
+                    Coordinates == COORDINATES_IJK ? "ijk" : "none");
+    Description << "\"}";
+    std::string DescriptionString = Description.str();
+
+    // Header, description and matrix
+    unsigned long long PageSize = sysconf(_SC_PAGESIZE);
+    unsigned long long DataOffset = sizeof(SharedMemoryHeader) +
+        DescriptionString.size() + 1;
+    DataOffset = (DataOffset + PageSize - 1) / PageSize * PageSize;
+    unsigned long long SegmentSize = DataOffset +
+        NumberOfRows * NumberOfColumns * sizeof(double);
+
+    // Create segment
+    shm_unlink(Name);
+    int FileDescriptor = shm_open(Name,O_CREAT | O_EXCL | O_RDWR,0600);
+    if(FileDescriptor < 0)
+    {
+        std::cerr << "Can not create shared memory: " << Name << std::endl;
+        throw ConversionError();
+    }
+
+    static bool RemoveAtExit = (atexit(RemoveUnpublishedSharedMemory) == 0);
+    UnpublishedSharedMemory = (RemoveAtExit == true ? Name : "");
+
+    int Status = ftruncate(FileDescriptor,SegmentSize);
+    if(Status == 0)
+    {
+        // Not all systems can allocate shared memory in advance
+        Status = posix_fallocate(FileDescriptor,0,SegmentSize);
+        Status = (Status == EINVAL || Status == EOPNOTSUPP ? 0 : Status);
+    }
+
+    void *Mapping = MAP_FAILED;
+    if(Status == 0)
+    {
+        Mapping = mmap(NULL,DataOffset,PROT_READ | PROT_WRITE,MAP_SHARED,
+                FileDescriptor,0);
+    }
+    close(FileDescriptor);
+
+    if(Mapping == MAP_FAILED)
+    {
+        std::cerr << "Can not allocate " << SegmentSize << " bytes of ";
+        std::cerr << "shared memory: " << Name << std::endl;
+        throw ConversionError();
+    }
+
+    // Header
+    SharedMemoryHeader *Header = static_cast<SharedMemoryHeader*>(Mapping);
+    memset(Header,0,sizeof(SharedMemoryHeader));
+    strncpy(Header->Magic,SHARED_MEMORY_MAGIC,sizeof(Header->Magic));
+    Header->Version = SHARED_MEMORY_VERSION;
+    Header->Ready = 0;
+    Header->NumberOfRows = NumberOfRows;
+    Header->NumberOfColumns = NumberOfColumns;
+    Header->DataOffset = DataOffset;
+    strncpy(Header->DataType,"float64",sizeof(Header->DataType));
+    memcpy(static_cast<char*>(Mapping) + sizeof(SharedMemoryHeader),
+            DescriptionString.c_str(),DescriptionString.size() + 1);
+
+    munmap(Mapping,DataOffset);
+
+    Messages << "Shared memory: " << Name << ", Bytes: " << SegmentSize;
+    Messages << ", Data offset: " << DataOffset << std::endl;
+}
+
+// ===========================
+// Create Matrix Shared Memory
+// ===========================
+
+// Description:
+// Creates the shared memory of the columns of an output matrix, of which
+// NumberOfRows rows are written in total, in one or several slabs.
+
+void CreateMatrixSharedMemory(
+        const char *Name,
+        const OutputMatrix &Matrix,
+        unsigned long long NumberOfRows)
+{
+    std::vector<std::string> ArrayNames;
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Matrix.Arrays.size();
+        ArrayIterator++)
+    {
+        const char *ArrayName = Matrix.Arrays[ArrayIterator]->GetName();
+        ArrayNames.push_back(ArrayName != NULL ? ArrayName : "");
+    }
+
+    CreateSharedMemory(Name,ArrayNames,Matrix.NumberOfComponents,
+            Matrix.Coordinates,NumberOfRows,Matrix.NumberOfColumns);
+}
+
+// =====================
+// Publish Shared Memory
+// =====================
+
+// Description:
+// Sets the Ready flag of the header after all rows are written, which is
+// checked against the rows the segment was created for. A consumer polls
+// the flag before it reads the matrix.
+
+void PublishSharedMemory(
+        const char *Name,
+        unsigned long long NumberOfRows)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    int FileDescriptor = shm_open(Name,O_RDWR,0);
+    void *Mapping = MAP_FAILED;
+    if(FileDescriptor >= 0)
+    {
+        Mapping = mmap(NULL,sizeof(SharedMemoryHeader),
+                PROT_READ | PROT_WRITE,MAP_SHARED,FileDescriptor,0);
+        close(FileDescriptor);
+    }
+
+    if(Mapping == MAP_FAILED)
+    {
+        std::cerr << "Can not open shared memory: " << Name << std::endl;
+        throw ConversionError();
+    }
+
+    SharedMemoryHeader *Header = static_cast<SharedMemoryHeader*>(Mapping);
+    if(Header->NumberOfRows != NumberOfRows)
+    {
+        std::cerr << "Inconsistent file: " << NumberOfRows << " rows were ";
+        std::cerr << "written instead of " << Header->NumberOfRows << ".";
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+
+    // The rows are visible to the consumer before the flag
+    __atomic_store_n(&Header->Ready,1U,__ATOMIC_RELEASE);
+    munmap(Mapping,sizeof(SharedMemoryHeader));
+
+    UnpublishedSharedMemory.clear();
+    Messages << "Shared memory is ready: " << Name << std::endl;
+}
+
+// ================================
+// Remove Unpublished Shared Memory
+// ================================
+
+void RemoveUnpublishedSharedMemory()
+{
+    if(UnpublishedSharedMemory.empty() == false)
+    {
+        shm_unlink(UnpublishedSharedMemory.c_str());
+    }
+}
+
+// =================
+// Is Sharded Output
+// =================
+
+bool IsShardedOutput(const ConversionOptions &Options)
+{
+    return Options.NumberOfShards > 0 || Options.ShardSize > 0;
+}
+
+// ================
+// Get Shard Layout
+// ================
+
+// Description:
+// Splits the rows of an output into the shard files of the --shards or
+// --shard-size option, named such as "Output.shard0.raw". With
+// --shard-size, each shard has as many rows as fit in the size, and at
+// least one row. There are no more shards than rows, and at least one.
+
+void GetShardLayout(
+        const char *OutputFilename,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        const ConversionOptions &Options,
+        ShardLayout &Layout)                  // Output
+{
+    unsigned long long RowSize = \
+        std::max(1U,NumberOfColumns) * sizeof(double);
+
+    Layout.NumberOfRows = NumberOfRows;
+    Layout.NumberOfColumns = NumberOfColumns;
+    if(Options.ShardSize > 0)
+    {
+        Layout.NumberOfShardRows = std::max(1ULL,Options.ShardSize / RowSize);
+    }
+    else
+    {
+        Layout.NumberOfShardRows = \
+            (NumberOfRows + Options.NumberOfShards - 1) /
+            std::max(1U,Options.NumberOfShards);
+    }
+    Layout.NumberOfShardRows = std::max(1ULL,Layout.NumberOfShardRows);
+
+    unsigned long long NumberOfShards = std::max(1ULL,
+            (NumberOfRows + Layout.NumberOfShardRows - 1) /
+            Layout.NumberOfShardRows);
+
+    Layout.Filenames.clear();
+    for(unsigned long long ShardIterator = 0;
+        ShardIterator < NumberOfShards;
+        ShardIterator++)
+    {
+        std::ostringstream Suffix;
+        Suffix << "shard" << ShardIterator;
+        Layout.Filenames.push_back(
+                MakeDerivedFilename(OutputFilename,Suffix.str()));
+    }
+}
+
+// ===================
+// Get Shard First Row
+// ===================
+
+unsigned long long GetShardFirstRow(
+        const ShardLayout &Layout,
+        unsigned int ShardIndex)
+{
+    return std::min(Layout.NumberOfRows,
+            ShardIndex * Layout.NumberOfShardRows);
+}
+
+// ========================
+// Get Number Of Shard Rows
+// ========================
+
+unsigned long long GetNumberOfShardRows(
+        const ShardLayout &Layout,
+        unsigned int ShardIndex)
+{
+    return std::min(Layout.NumberOfRows,
+                    (ShardIndex + 1) * Layout.NumberOfShardRows) -
+           GetShardFirstRow(Layout,ShardIndex);
+}
+
+// =============
+// Create Shards
+// =============
+
+// Description:
+// Creates the shard files, each sized to its rows, which the writers open
+// again to write the rows at their offsets.
+
+void CreateShards(const ShardLayout &Layout)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    unsigned long long RowSize = Layout.NumberOfColumns * sizeof(double);
+
+    for(unsigned int ShardIterator = 0;
+        ShardIterator < Layout.Filenames.size();
+        ShardIterator++)
+    {
+        const char *ShardFilename = Layout.Filenames[ShardIterator].c_str();
+
+        OutputFileStream ShardFile;
+        OpenFile(ShardFilename,true,ShardFile);
+        ShardFile.close();
+
+        if(truncate(ShardFilename,
+                    GetNumberOfShardRows(Layout,ShardIterator) * RowSize) != 0)
+        {
+            std::cerr << "Can not allocate output file: " << ShardFilename;
+            std::cerr << std::endl;
+            throw ConversionError();
+        }
+    }
+
+    Messages << "Shards: " << Layout.Filenames.size();
+    Messages << ", Rows per shard: " << Layout.NumberOfShardRows;
+    Messages << std::endl;
+}
+
+// ===========
+// Open Shards
+// ===========
+
+// Description:
+// Opens all shard files as one stream of the rows of the output, in which
+// a writer seeks to its rows as in a single output file.
+
+void OpenShards(
+        const ShardLayout &Layout,
+        OutputFileStream &OutputFile)         // Output
+{
+    unsigned long long RowSize = Layout.NumberOfColumns * sizeof(double);
+    OutputFile.OpenShards(Layout.Filenames,
+            std::max(1ULL,Layout.NumberOfShardRows * RowSize),
+            Layout.NumberOfRows * RowSize);
+
+    if(OutputFile.is_open() != true)
+    {
+        std::cerr << "Can not open output file: " << Layout.Filenames[0];
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+}
+
+// ======================
+// Write Arrays To Shards
+// ======================
+
+// Description:
+// Writes the rows of the matrix to the shard files with a pool of threads.
+// Each thread takes the next shard that is not yet written, and converts
+// and writes its rows block by block, as WriteArraysToBinaryFile does for
+// one file. The CRC-32 of each shard is computed from its blocks as they
+// are written, so the shards need not be read back to publish them.
+
+struct ShardConversion
+{
+    const OutputMatrix *Matrix;          // Rows to write, or NULL to
+                                         // checksum the shards
+    const ShardLayout *Layout;
+    std::vector<unsigned long> Checksums;
+    std::atomic<unsigned int> NextShard;
+    std::atomic<bool> Failed;            // A thread has thrown an error
+};
+
+void WriteArraysToShards(
+        const OutputMatrix &Matrix,
+        const ShardLayout &Layout,
+        const ConversionOptions &Options,
+        std::vector<unsigned long> &Checksums)    // Output
+{
+    std::ostream &Messages = GetMessageStream();
+
+    Messages << "Write to binary file." << std::endl;
+
+    ShardConversion Conversion;
+    Conversion.Matrix = &Matrix;
+    Conversion.Layout = &Layout;
+    Conversion.Checksums.resize(Layout.Filenames.size(),0);
+    Conversion.NextShard = 0;
+    Conversion.Failed = false;
+
+    unsigned int NumberOfThreads = GetNumberOfThreads(Options,
+            Layout.Filenames.size());
+
+    // Pool of threads
+    std::vector<std::thread> Threads;
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < NumberOfThreads;
+        ThreadIterator++)
+    {
+        Threads.push_back(std::thread(WriteShardsOnThread,&Conversion));
+    }
+
+    for(unsigned int ThreadIterator = 0;
+        ThreadIterator < NumberOfThreads;
+        ThreadIterator++)
+    {
+        Threads[ThreadIterator].join();
+    }
+
+    if(Conversion.Failed == true)
+    {
+        throw ConversionError();
+    }
+
+    Checksums.swap(Conversion.Checksums);
+}
+
+// ======================
+// Write Shards On Thread
+// ======================
+
+void WriteShardsOnThread(ShardConversion *Conversion)
+{
+    try
+    {
+        const OutputMatrix &Matrix = *Conversion->Matrix;
+        const ShardLayout &Layout = *Conversion->Layout;
+        unsigned long long RowSize = Matrix.NumberOfColumns * sizeof(double);
+
+        // Buffer of a block of rows
+        unsigned long long NumberOfBlockRows = GetNumberOfBlockRows(Matrix);
+        std::vector<double> Buffer(NumberOfBlockRows * Matrix.NumberOfColumns);
+        std::vector<vtkIdType> TupleIds;
+        std::vector<int> Indices;
+
+        unsigned int NumberOfShards = Layout.Filenames.size();
+        for(unsigned int ShardIndex = Conversion->NextShard++;
+            ShardIndex < NumberOfShards && Conversion->Failed == false;
+            ShardIndex = Conversion->NextShard++)
+        {
+            unsigned long long ShardFirstRow = GetShardFirstRow(Layout,
+                    ShardIndex);
+            unsigned long long NumberOfShardRows = \
+                GetNumberOfShardRows(Layout,ShardIndex);
+            const char *ShardFilename = Layout.Filenames[ShardIndex].c_str();
+
+            OutputFileStream ShardFile;
+            ShardFile.OpenRegion(ShardFilename,0,NumberOfShardRows * RowSize);
+            if(ShardFile.is_open() != true)
+            {
+                std::cerr << "Can not open output file: " << ShardFilename;
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+
+            // Iterate over blocks of rows of the shard
+            uLong Checksum = crc32(0L,Z_NULL,0);
+            for(unsigned long long FirstRow = 0;
+                FirstRow < NumberOfShardRows;
+                FirstRow += NumberOfBlockRows)
+            {
+                unsigned long long NumberOfRows = std::min(
+                        NumberOfBlockRows,NumberOfShardRows-FirstRow);
+
+                ConvertMatrixRows(Matrix,ShardFirstRow+FirstRow,NumberOfRows,
+                        TupleIds,Indices,&Buffer[0]);
+
+                ShardFile.write(reinterpret_cast<const char*>(&Buffer[0]),
+                        NumberOfRows * RowSize);
+                Checksum = crc32(Checksum,
+                        reinterpret_cast<const Bytef*>(&Buffer[0]),
+                        NumberOfRows * RowSize);
+            }
+
+            if(ShardFile.good() != true)
+            {
+                std::cerr << "Can not write to output file." << std::endl;
+                throw ConversionError();
+            }
+
+            ShardFile.close();
+            Conversion->Checksums[ShardIndex] = Checksum;
+        }
+    }
+    catch(const ConversionError &)
+    {
+        Conversion->Failed = true;
+    }
+}
+
+// ==============
+// Publish Shards
+// ==============
+
+// Description:
+// Writes the index of the shards of an output, OutputFile.shards.txt, which
+// has the rows, the size and the CRC-32 of each shard file, so that a
+// consumer can read and verify each shard on its own. The Checksums of
+// shards that were written in order are given by their writers. Otherwise,
+// such as for the rows of pieces, which are written in any order, Checksums
+// is NULL, and the shards are read back to compute their checksums, by a
+// pool of threads, once all writers have finished.
+
+void PublishShards(
+        const ShardLayout &Layout,
+        const char *OutputFilename,
+        const ConversionOptions &Options,
+        const std::vector<unsigned long> *Checksums)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    unsigned int NumberOfShards = Layout.Filenames.size();
+    unsigned long long RowSize = Layout.NumberOfColumns * sizeof(double);
+
+    ShardConversion Conversion;
+    Conversion.Matrix = NULL;
+    Conversion.Layout = &Layout;
+    Conversion.Checksums.resize(NumberOfShards,0);
+    Conversion.NextShard = 0;
+    Conversion.Failed = false;
+
+    if(Checksums != NULL)
+    {
+        Conversion.Checksums = *Checksums;
+    }
+    else
+    {
+        // Pool of threads
+        unsigned int NumberOfThreads = GetNumberOfThreads(Options,
+                NumberOfShards);
+        std::vector<std::thread> Threads;
+        for(unsigned int ThreadIterator = 0;
+            ThreadIterator < NumberOfThreads;
+            ThreadIterator++)
+        {
+            Threads.push_back(std::thread(ChecksumShardsOnThread,
+                        &Conversion));
+        }
+
+        for(unsigned int ThreadIterator = 0;
+            ThreadIterator < NumberOfThreads;
+            ThreadIterator++)
+        {
+            Threads[ThreadIterator].join();
+        }
+
+        if(Conversion.Failed == true)
+        {
+            throw ConversionError();
+        }
+    }
+
+    // Table of shards
+    std::string IndexFilename = MakeTableFilename(OutputFilename,"shards");
+
+    OutputFileStream IndexFile;
+    OpenFile(IndexFilename.c_str(),false,IndexFile);
+
+    IndexFile << "Shard\tFirstRow\tNumberOfRows\tBytes\tCRC32\tFile\n";
+    for(unsigned int ShardIterator = 0;
+        ShardIterator < NumberOfShards;
+        ShardIterator++)
+    {
+        unsigned long long NumberOfShardRows = \
+            GetNumberOfShardRows(Layout,ShardIterator);
+
+        IndexFile << ShardIterator << "\t";
+        IndexFile << GetShardFirstRow(Layout,ShardIterator) << "\t";
+        IndexFile << NumberOfShardRows << "\t";
+        IndexFile << NumberOfShardRows * RowSize << "\t";
+        IndexFile << std::hex << std::setw(8) << std::setfill('0');
+        IndexFile << Conversion.Checksums[ShardIterator];
+        IndexFile << std::dec << std::setfill(' ') << "\t";
+        IndexFile << Layout.Filenames[ShardIterator] << "\n";
+    }
+
+    if(IndexFile.good() != true)
+    {
+        std::cerr << "Can not write to output file: " << IndexFilename;
+        std::cerr << std::endl;
+        throw ConversionError();
+    }
+    IndexFile.close();
+
+    Messages << "Table of shards was written to: " << IndexFilename << ".";
+    Messages << std::endl;
+}
+
+// =========================
+// Checksum Shards On Thread
+// =========================
+
+void ChecksumShardsOnThread(ShardConversion *Conversion)
+{
+    try
+    {
+        const ShardLayout &Layout = *Conversion->Layout;
+        std::vector<char> Buffer(BUFFER_SIZE);
+
+        unsigned int NumberOfShards = Layout.Filenames.size();
+        for(unsigned int ShardIndex = Conversion->NextShard++;
+            ShardIndex < NumberOfShards && Conversion->Failed == false;
+            ShardIndex = Conversion->NextShard++)
+        {
+            const char *ShardFilename = Layout.Filenames[ShardIndex].c_str();
+            std::ifstream ShardFile(ShardFilename,std::ios::binary);
+            if(ShardFile.is_open() != true)
+            {
+                std::cerr << "Can not read output file: " << ShardFilename;
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+
+            uLong Checksum = crc32(0L,Z_NULL,0);
+            while(ShardFile.good() == true)
+            {
+                ShardFile.read(&Buffer[0],Buffer.size());
+                Checksum = crc32(Checksum,
+                        reinterpret_cast<const Bytef*>(&Buffer[0]),
+                        ShardFile.gcount());
+            }
+
+            if(ShardFile.bad() == true)
+            {
+                std::cerr << "Can not read output file: " << ShardFilename;
+                std::cerr << std::endl;
+                throw ConversionError();
+            }
+
+            Conversion->Checksums[ShardIndex] = Checksum;
+        }
+    }
+    catch(const ConversionError &)
+    {
+        Conversion->Failed = true;
+    }
+}
+
+// ==========================
+// Write Arrays To ASCII File
+// ==========================
+
+// Description:
+// In ASCII mode, columns are separated by a delimiter, such as a tab.
+// The rows are separated by new line.
+//
+// RowOffset is the number of rows that are already written to the file, if
+// the matrix is written in several slabs. Each block of rows is formatted in
+// memory, and written at once, so that a pipe is written in large writes.
+
+void WriteArraysToASCIIFile(
+        std::ostream &OutputFile,    // Output
+        const OutputMatrix &Matrix,
+        unsigned long long RowOffset)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    if(RowOffset == 0)
+    {
+        Messages << "Write to ASCII file." << std::endl;
+    }
+
+    std::string Delimiter("\t");
+
+    // Buffer of a block of rows
+    unsigned long long NumberOfBlockRows = GetNumberOfBlockRows(Matrix);
+    std::vector<double> Buffer(NumberOfBlockRows * Matrix.NumberOfColumns);
+    std::vector<vtkIdType> TupleIds;
+    std::vector<int> Indices;
+    std::ostringstream BlockStream;
+    BlockStream.precision(OutputFile.precision());
+
+    // Iterate over blocks of rows
+    for(unsigned long long FirstRow = 0;
+        FirstRow < Matrix.NumberOfRows;
+        FirstRow += NumberOfBlockRows)
+    {
+        unsigned long long NumberOfRows = std::min(
+                NumberOfBlockRows,Matrix.NumberOfRows-FirstRow);
+        ConvertMatrixRows(Matrix,FirstRow,NumberOfRows,TupleIds,Indices,
+                &Buffer[0]);
+        BlockStream.str("");
+
+        // Iterate over rows
+        for(unsigned long long RowIterator = 0;
+            RowIterator < NumberOfRows;
+            RowIterator++)
+        {
+            const double *Row = &Buffer[RowIterator*Matrix.NumberOfColumns];
+
+            // Insert new line between rows
+            if(RowOffset + FirstRow + RowIterator > 0)
+            {
+                BlockStream << "\n";
+            }
+
+            // Iterate over columns
+            for(unsigned int ColumnIterator = 0;
+                ColumnIterator < Matrix.NumberOfColumns;
+                ColumnIterator++)
+            {
+                // Write to ASCII file
+                BlockStream << Row[ColumnIterator];
+
+                // Insert delimiter between columns
+                if(ColumnIterator < Matrix.NumberOfColumns-1)
+                {
+                    BlockStream << Delimiter;
+                }
+            }
+        }
+
+        const std::string &Block = BlockStream.str();
+        OutputFile.write(Block.data(),Block.size());
+    }
+
+    if(OutputFile.good() != true)
+    {
+        std::cerr << "Can not write to output file." << std::endl;
+        throw ConversionError();
+    }
+}
+
+// ===========================
+// Write Arrays To Binary File
+// ===========================
+
+// Description:
+// 
+// In Binary mode, there is no delimiter or new line netween rows and columns.
+// Indeed there is no columsn and rows. All data are stored consequently on the
+// memory. The application code that reads the output file should be aware of
+// how to read the chunk of bytes.
+//
+// Data are stored as double. The number of components (columns) for each array
+// is printed afterward to the screen. 
+//
+// To view the binary file in terminal in ASCII mode, use
+//
+//    $ hexdump -v -e '7/8 "%f "' -e '"\n"' OutputFile.raw
+//
+// In above, 8 is for double precision. FOr float, replace 8 with 4.
+// In above, the file is printed in 7 columns. Change 7 to the number of
+// columns.
+//
+// Rows are converted in blocks of about BUFFER_SIZE bytes, and each block is
+// written at once. RowOffset is the number of rows that are already written
+// to the file, if the matrix is written in several slabs. The rows of a
+// shared memory output are converted directly into the segment.
+
+void WriteArraysToBinaryFile(
+        std::ostream &OutputFile,    // Output
+        const OutputMatrix &Matrix,
+        unsigned long long RowOffset)
+{
+    std::ostream &Messages = GetMessageStream();
+
+    if(RowOffset == 0)
+    {
+        Messages << "Write to binary file." << std::endl;
+    }
+
+    SharedMemoryStreamBuffer *SharedMemory = \
+        dynamic_cast<SharedMemoryStreamBuffer*>(OutputFile.rdbuf());
+
+    // Buffer of a block of rows
+    unsigned long long NumberOfBlockRows = GetNumberOfBlockRows(Matrix);
+    std::vector<double> Buffer(SharedMemory == NULL ?
+            NumberOfBlockRows * Matrix.NumberOfColumns : 0);
+    std::vector<vtkIdType> TupleIds;
+    std::vector<int> Indices;
+
+    // Iterate over blocks of rows
+    for(unsigned long long FirstRow = 0;
+        FirstRow < Matrix.NumberOfRows;
+        FirstRow += NumberOfBlockRows)
+    {
+        unsigned long long NumberOfRows = std::min(
+                NumberOfBlockRows,Matrix.NumberOfRows-FirstRow);
+        unsigned long long NumberOfBytes = \
+            NumberOfRows * Matrix.NumberOfColumns * sizeof(double);
+
+        if(SharedMemory != NULL)
+        {
+            double *Block = reinterpret_cast<double*>(
+                    SharedMemory->Reserve(NumberOfBytes));
+            if(Block == NULL)
+            {
+                OutputFile.setstate(std::ios::badbit);
+                break;
+            }
+
+            ConvertMatrixRows(Matrix,FirstRow,NumberOfRows,TupleIds,Indices,
+                    Block);
+            continue;
+        }
+
+        ConvertMatrixRows(Matrix,FirstRow,NumberOfRows,TupleIds,Indices,
+                &Buffer[0]);
+
+        OutputFile.write(
+                reinterpret_cast<const char*>(&Buffer[0]),NumberOfBytes);
+    }
+
+    if(OutputFile.good() != true)
+    {
+        std::cerr << "Can not write to output file." << std::endl;
+        throw ConversionError();
+    }
+}
+
+// ================
+// Probe Input File
+// ================
+
+// Description:
+// Probe mode reads only the headers of the input file, that is, the legacy
+// keyword lines or the XML tags before the appended data. Data values are
+// skipped, either by seeking over binary data or by counting ASCII tokens.
+// The result is printed to the standard output as one JSON object per line,
+// so that thousands of files can be planned without reading their data.
+//
+// The predicted output size is for binary output, where each value is
+// written as a double.
+
+bool ProbeInputFile(const char *InputFilename)
+{
+    FileHeader Header;
+    std::string DataSetType;
+    InputFileType FileType = DetectInputFileType(InputFilename,DataSetType);
+
+    if(FileType == NUMBER_OF_INPUT_FILE_TYPES)
+    {
+        std::cerr << "Can not probe input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if(ScanFileHeader(InputFilename,FileType,Header) == false)
+    {
+        std::cerr << "Can not probe input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    // Each block of a multiblock file is probed as a file of its own
+    if(Header.Blocks.empty() == false)
+    {
+        bool Status = true;
+        for(unsigned int BlockIterator = 0;
+            BlockIterator < Header.Blocks.size();
+            BlockIterator++)
+        {
+            if(ProbeInputFile(
+                    Header.Blocks[BlockIterator].Filename.c_str()) == false)
+            {
+                Status = false;
+            }
+        }
+
+        return Status;
+    }
+
+    // So is each time step of a time series
+    if(Header.TimeSteps.empty() == false)
+    {
+        bool Status = true;
+        for(unsigned int StepIterator = 0;
+            StepIterator < Header.TimeSteps.size();
+            StepIterator++)
+        {
+            if(ProbeInputFile(
+                    Header.TimeSteps[StepIterator].Filename.c_str()) == false)
+            {
+                Status = false;
+            }
+        }
+
+        return Status;
+    }
+
+    return PrintProbeSummary(InputFilename,Header);
+}
+
+// ================
+// Scan File Header
+// ================
+
+// Description:
+// Scans the header with the first registered handler of the file type that
+// can probe headers.
+
+bool ScanFileHeader(
+        const char *InputFilename,
+        InputFileType FileType,
+        FileHeader &Header)                   // Output
+{
+    Header.FileType = FileType;
+
+    ConversionOptions ProbeOptions;
+    ProbeOptions.Probe = true;
+    const ReaderHandler *Handler = SelectReaderHandler(
+            InputFilename,ProbeOptions,Header);
+
+    if(Handler == NULL)
+    {
+        std::cerr << "No header probe for ";
+        std::cerr << GetInputFileTypeName(FileType) << " files." << std::endl;
+        return false;
+    }
+
+    // The header may have been scanned already to select the handler
+    if(Header.Pieces.empty() == false)
+    {
+        return true;
+    }
+
+    return Handler->ScanHeader(InputFilename,Header);
+}
+
+// =======================
+// Scan Legacy File Header
+// =======================
+
+// Description:
+// Walks through all sections of a legacy VTK file. Geometry and topology
+// sections (POINTS, CELLS, X_COORDINATES, etc) are skipped. For each
+// attribute in POINT_DATA and CELL_DATA, the name, type, number of components
+// and the file position of its data are recorded, then its data is skipped.
+//
+// Both the version 4 and version 5 layouts of CELLS and polygonal sections
+// are supported. In version 5, the section is followed by OFFSETS and
+// CONNECTIVITY arrays, and its first number is the number of offsets.
+
+bool ScanLegacyFileHeader(
+        const char *InputFilename,
+        FileHeader &Header)                   // Output
+{
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    // First line is the identifier, second line is the title
+    std::string Line;
+    std::getline(InputFile,Line);
+    if(Line.compare(0,14,"# vtk DataFile") != 0)
+    {
+        std::cerr << "Not a legacy VTK file: " << InputFilename << std::endl;
+        return false;
+    }
+    std::getline(InputFile,Line);
+
+    // Third line is ASCII or BINARY
+    ReadLegacyLine(InputFile,Line);
+    Header.BinaryData = (ToUpperCase(Line).compare(0,6,"BINARY") == 0);
+    Header.BigEndian = true;
+    Header.Pieces.resize(1);
+    PieceHeader &Piece = Header.Pieces[0];
+
+    // Arrays of the current attribute section, NULL before POINT_DATA
+    std::vector<ArrayHeader> *CurrentArrays = NULL;
+    unsigned long long CurrentNumberOfTuples = 0;
+
+    while(ReadLegacyLine(InputFile,Line))
+    {
+        std::istringstream LineStream(Line);
+        std::string Keyword;
+        LineStream >> Keyword;
+        Keyword = ToUpperCase(Keyword);
+
+        if(Keyword == "DATASET")
+        {
+            LineStream >> Header.DataSetType;
+            Header.DataSetType = ToUpperCase(Header.DataSetType);
+        }
+        else if(Keyword == "DIMENSIONS")
+        {
+            unsigned long long NumberOfPoints = 1;
+            unsigned long long NumberOfCells = 1;
+            for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+            {
+                int Size = 1;
+                LineStream >> Size;
+                Header.WholeExtent[2*Dimension] = 0;
+                Header.WholeExtent[2*Dimension+1] = Size - 1;
+                NumberOfPoints *= Size;
+                NumberOfCells *= (Size > 1 ? Size - 1 : 1);
+            }
+            Piece.NumberOfPoints = NumberOfPoints;
+            Piece.NumberOfCells = NumberOfCells;
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                Piece.Extent[i] = Header.WholeExtent[i];
+            }
+        }
+        else if(Keyword == "SPACING" || Keyword == "ASPECT_RATIO")
+        {
+            LineStream >> Header.Spacing[0] >> Header.Spacing[1];
+            LineStream >> Header.Spacing[2];
+        }
+        else if(Keyword == "ORIGIN")
+        {
+            LineStream >> Header.Origin[0] >> Header.Origin[1];
+            LineStream >> Header.Origin[2];
+        }
+        else if(Keyword == "POINTS")
+        {
+            unsigned long long NumberOfPoints = 0;
+            std::string TypeName;
+            LineStream >> NumberOfPoints >> TypeName;
+            Piece.NumberOfPoints = NumberOfPoints;
+
+            Piece.Points.Name = "Points";
+            Piece.Points.DataType = LookupLegacyDataType(TypeName);
+            Piece.Points.NumberOfComponents = 3;
+            Piece.Points.NumberOfTuples = NumberOfPoints;
+            Piece.Points.ValueSize = GetLegacyDataTypeSize(TypeName);
+            Piece.Points.BinaryData = Header.BinaryData;
+            Piece.Points.Format = Header.BinaryData ? "binary" : "ascii";
+            Piece.Points.Offset = static_cast<long long>(InputFile.tellg());
+
+            if(SkipLegacySection(InputFile,Header.BinaryData,TypeName,
+                        3*NumberOfPoints) == false)
+            {
+                return false;
+            }
+        }
+        else if(Keyword == "X_COORDINATES" ||
+                Keyword == "Y_COORDINATES" ||
+                Keyword == "Z_COORDINATES")
+        {
+            unsigned long long NumberOfValues = 0;
+            std::string TypeName;
+            LineStream >> NumberOfValues >> TypeName;
+            if(SkipLegacySection(InputFile,Header.BinaryData,TypeName,
+                        NumberOfValues) == false)
+            {
+                return false;
+            }
+        }
+        else if(Keyword == "CELLS" ||
+                Keyword == "VERTICES" ||
+                Keyword == "LINES" ||
+                Keyword == "POLYGONS" ||
+                Keyword == "TRIANGLE_STRIPS")
+        {
+            unsigned long long NumberOfCells = 0;
+            unsigned long long Size = 0;
+            LineStream >> NumberOfCells >> Size;
+
+            // Version 5 layout starts with an OFFSETS line
+            std::streampos Position = InputFile.tellg();
+            std::string NextLine;
+            ReadLegacyLine(InputFile,NextLine);
+            std::istringstream NextLineStream(NextLine);
+            std::string NextKeyword;
+            std::string TypeName;
+            NextLineStream >> NextKeyword >> TypeName;
+
+            if(ToUpperCase(NextKeyword) == "OFFSETS")
+            {
+                if(SkipLegacySection(InputFile,Header.BinaryData,TypeName,
+                            NumberOfCells) == false)
+                {
+                    return false;
+                }
+
+                ReadLegacyLine(InputFile,NextLine);
+                NextLineStream.clear();
+                NextLineStream.str(NextLine);
+                NextLineStream >> NextKeyword >> TypeName;
+                if(ToUpperCase(NextKeyword) != "CONNECTIVITY" ||
+                   SkipLegacySection(InputFile,Header.BinaryData,TypeName,
+                            Size) == false)
+                {
+                    std::cerr << "Invalid " << Keyword << " section.";
+                    std::cerr << std::endl;
+                    return false;
+                }
+
+                // Number of offsets is one more than the number of cells
+                NumberOfCells = (NumberOfCells > 0 ? NumberOfCells - 1 : 0);
+            }
+            else
+            {
+                InputFile.seekg(Position);
+                if(SkipLegacySection(InputFile,Header.BinaryData,"int",
+                            Size) == false)
+                {
+                    return false;
+                }
+            }
+
+            Piece.NumberOfCells = (Keyword == "CELLS" ? NumberOfCells :
+                    Piece.NumberOfCells + NumberOfCells);
+        }
+        else if(Keyword == "CELL_TYPES")
+        {
+            unsigned long long NumberOfCells = 0;
+            LineStream >> NumberOfCells;
+            if(SkipLegacySection(InputFile,Header.BinaryData,"int",
+                        NumberOfCells) == false)
+            {
+                return false;
+            }
+        }
+        else if(Keyword == "POINT_DATA")
+        {
+            LineStream >> CurrentNumberOfTuples;
+            CurrentArrays = &Piece.PointArrays;
+        }
+        else if(Keyword == "CELL_DATA")
+        {
+            LineStream >> CurrentNumberOfTuples;
+            CurrentArrays = &Piece.CellArrays;
+        }
+        else if(Keyword == "METADATA")
+        {
+            SkipLegacyMetaData(InputFile);
+        }
+        else if(Keyword == "LOOKUP_TABLE")
+        {
+            // A lookup table is not an array of the dataset
+            std::string Name;
+            unsigned long long Size = 0;
+            LineStream >> Name >> Size;
+            if(SkipLegacySection(InputFile,Header.BinaryData,
+                        Header.BinaryData ? "unsigned_char" : "float",
+                        4*Size) == false)
+            {
+                return false;
+            }
+        }
+        else if(Keyword == "FIELD")
+        {
+            std::string FieldName;
+            unsigned int NumberOfFieldArrays = 0;
+            LineStream >> FieldName >> NumberOfFieldArrays;
+
+            for(unsigned int FieldArrayIterator = 0;
+                FieldArrayIterator < NumberOfFieldArrays;
+                FieldArrayIterator++)
+            {
+                if(ReadLegacyLine(InputFile,Line) == false)
+                {
+                    std::cerr << "Unexpected end of FIELD section.";
+                    std::cerr << std::endl;
+                    return false;
+                }
+
+                // Meta data of the previous array
+                if(ToUpperCase(Line) == "METADATA")
+                {
+                    SkipLegacyMetaData(InputFile);
+                    FieldArrayIterator--;
+                    continue;
+                }
+
+                std::istringstream ArrayLineStream(Line);
+                std::string ArrayName;
+                std::string TypeName;
+                unsigned int NumberOfComponents = 0;
+                unsigned long long NumberOfTuples = 0;
+                ArrayLineStream >> ArrayName;
+                if(ArrayName == "NULL_ARRAY")
+                {
+                    continue;
+                }
+                ArrayLineStream >> NumberOfComponents >> NumberOfTuples;
+                ArrayLineStream >> TypeName;
+
+                ArrayHeader Array;
+                Array.Name = DecodeLegacyName(ArrayName);
+                Array.DataType = LookupLegacyDataType(TypeName);
+                Array.NumberOfComponents = NumberOfComponents;
+                Array.NumberOfTuples = NumberOfTuples;
+                Array.ValueSize = GetLegacyDataTypeSize(TypeName);
+                Array.BinaryData = Header.BinaryData;
+                Array.Format = Header.BinaryData ? "binary" : "ascii";
+                Array.Offset = static_cast<long long>(InputFile.tellg());
+
+                if(SkipLegacySection(InputFile,Header.BinaryData,TypeName,
+                            NumberOfComponents*NumberOfTuples) == false)
+                {
+                    return false;
+                }
+
+                // Field data of the dataset itself is not converted
+                if(CurrentArrays != NULL)
+                {
+                    CurrentArrays->push_back(Array);
+                }
+            }
+        }
+        else if(Keyword == "SCALARS" ||
+                Keyword == "COLOR_SCALARS" ||
+                Keyword == "VECTORS" ||
+                Keyword == "NORMALS" ||
+                Keyword == "TENSORS" ||
+                Keyword == "TENSORS6" ||
+                Keyword == "TEXTURE_COORDINATES" ||
+                Keyword == "GLOBAL_IDS" ||
+                Keyword == "PEDIGREE_IDS")
+        {
+            if(CurrentArrays == NULL)
+            {
+                std::cerr << Keyword << " found before POINT_DATA or ";
+                std::cerr << "CELL_DATA." << std::endl;
+                return false;
+            }
+
+            std::string ArrayName;
+            std::string TypeName;
+            unsigned int NumberOfComponents = 1;
+            LineStream >> ArrayName;
+
+            if(Keyword == "SCALARS")
+            {
+                LineStream >> TypeName;
+                if(!(LineStream >> NumberOfComponents))
+                {
+                    NumberOfComponents = 1;
+                }
+
+                // Optional lookup table line
+                std::streampos Position = InputFile.tellg();
+                std::string NextLine;
+                ReadLegacyLine(InputFile,NextLine);
+                if(ToUpperCase(NextLine).compare(0,12,"LOOKUP_TABLE") != 0)
+                {
+                    InputFile.seekg(Position);
+                }
+            }
+            else if(Keyword == "COLOR_SCALARS")
+            {
+                // ASCII values are floats, which are read as unsigned chars
+                LineStream >> NumberOfComponents;
+                TypeName = "unsigned_char";
+            }
+            else if(Keyword == "TEXTURE_COORDINATES")
+            {
+                LineStream >> NumberOfComponents >> TypeName;
+            }
+            else
+            {
+                LineStream >> TypeName;
+                if(Keyword == "VECTORS" || Keyword == "NORMALS")
+                {
+                    NumberOfComponents = 3;
+                }
+                else if(Keyword == "TENSORS")
+                {
+                    NumberOfComponents = 9;
+                }
+                else if(Keyword == "TENSORS6")
+                {
+                    NumberOfComponents = 6;
+                }
+            }
+
+            ArrayHeader Array;
+            Array.Name = DecodeLegacyName(ArrayName);
+            Array.DataType = LookupLegacyDataType(TypeName);
+            Array.NumberOfComponents = NumberOfComponents;
+            Array.NumberOfTuples = CurrentNumberOfTuples;
+            Array.ValueSize = GetLegacyDataTypeSize(TypeName);
+            Array.BinaryData = Header.BinaryData;
+            Array.Format = Header.BinaryData ? "binary" : "ascii";
+            Array.Offset = static_cast<long long>(InputFile.tellg());
+            Array.ColorScalars = (Keyword == "COLOR_SCALARS");
+
+            if(SkipLegacySection(InputFile,Header.BinaryData,TypeName,
+                        NumberOfComponents*CurrentNumberOfTuples) == false)
+            {
+                return false;
+            }
+
+            CurrentArrays->push_back(Array);
+        }
+        else
+        {
+            std::cerr << "Unknown keyword in legacy file: " << Keyword;
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ====================
+// Scan XML File Header
+// ====================
+
+// Description:
+// Reads the XML tags of a VTK XML file up to the AppendedData element. The
+// text between tags (inline ASCII or base64 data) is skipped without being
+// decoded. For each piece, the number of points and cells, and the type,
+// name, number of components, format and appended offset of each DataArray
+// in PointData and CellData are recorded.
+
+bool ScanXMLFileHeader(
+        const char *InputFilename,
+        FileHeader &Header)                   // Output
+{
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    std::string TagName;
+    std::vector<std::string> Names;
+    std::vector<std::string> Values;
+
+    // Arrays of the current PointData or CellData element
+    std::vector<ArrayHeader> *CurrentArrays = NULL;
+    unsigned long long CurrentNumberOfTuples = 0;
+    bool FoundVTKFile = false;
+    bool EmptyElement = false;
+
+    while(ReadXMLTag(InputFile,TagName,Names,Values,EmptyElement))
+    {
+        if(TagName == "VTKFile")
+        {
+            FoundVTKFile = true;
+            Header.DataSetType = GetXMLAttribute(Names,Values,"type");
+            Header.BigEndian = \
+                (GetXMLAttribute(Names,Values,"byte_order") == "BigEndian");
+            Header.HeaderTypeSize = \
+                (GetXMLAttribute(Names,Values,"header_type") == "UInt64" ?
+                 8 : 4);
+            Header.Compressor = GetXMLAttribute(Names,Values,"compressor");
+        }
+        else if(FoundVTKFile == false)
+        {
+            continue;
+        }
+        else if(TagName == Header.DataSetType)
+        {
+            std::istringstream ExtentStream(
+                    GetXMLAttribute(Names,Values,"WholeExtent"));
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                ExtentStream >> Header.WholeExtent[i];
+            }
+
+            std::istringstream OriginStream(
+                    GetXMLAttribute(Names,Values,"Origin"));
+            std::istringstream SpacingStream(
+                    GetXMLAttribute(Names,Values,"Spacing"));
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                OriginStream >> Header.Origin[i];
+                SpacingStream >> Header.Spacing[i];
+            }
+        }
+        else if(TagName == "Piece")
+        {
+            Header.Pieces.push_back(PieceHeader());
+            PieceHeader &Piece = Header.Pieces.back();
+            Piece.Source = GetXMLAttribute(Names,Values,"Source");
+
+            std::string Extent = GetXMLAttribute(Names,Values,"Extent");
+            if(Extent.empty() == false)
+            {
+                // Structured piece
+                std::istringstream ExtentStream(Extent);
+                Piece.NumberOfPoints = 1;
+                Piece.NumberOfCells = 1;
+                for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+                {
+                    ExtentStream >> Piece.Extent[2*Dimension];
+                    ExtentStream >> Piece.Extent[2*Dimension+1];
+                    long long Size = Piece.Extent[2*Dimension+1] - \
+                                     Piece.Extent[2*Dimension] + 1;
+                    Piece.NumberOfPoints *= Size;
+                    Piece.NumberOfCells *= (Size > 1 ? Size - 1 : 1);
+                }
+            }
+            else
+            {
+                // Unstructured piece
+                Piece.NumberOfPoints = strtoull(GetXMLAttribute(
+                            Names,Values,"NumberOfPoints").c_str(),NULL,10);
+                Piece.NumberOfCells = strtoull(GetXMLAttribute(
+                            Names,Values,"NumberOfCells").c_str(),NULL,10);
+
+                const char *PolyDataCells[4] = {
+                    "NumberOfVerts","NumberOfLines",
+                    "NumberOfStrips","NumberOfPolys"};
+                for(unsigned int i = 0; i < 4; i++)
+                {
+                    Piece.NumberOfCells += strtoull(GetXMLAttribute(
+                            Names,Values,PolyDataCells[i]).c_str(),NULL,10);
+                }
+            }
+        }
+        else if(TagName == "PointData" && Header.Pieces.empty() == false)
+        {
+            CurrentArrays = &Header.Pieces.back().PointArrays;
+            CurrentNumberOfTuples = Header.Pieces.back().NumberOfPoints;
+        }
+        else if(TagName == "CellData" && Header.Pieces.empty() == false)
+        {
+            CurrentArrays = &Header.Pieces.back().CellArrays;
+            CurrentNumberOfTuples = Header.Pieces.back().NumberOfCells;
+        }
+        else if(TagName == "/PointData" || TagName == "/CellData")
+        {
+            CurrentArrays = NULL;
+        }
+        else if(TagName == "DataArray" && CurrentArrays != NULL)
+        {
+            ArrayHeader Array;
+            Array.Name = GetXMLAttribute(Names,Values,"Name");
+            Array.DataType = LookupXMLDataType(
+                    GetXMLAttribute(Names,Values,"type"));
+            Array.ValueSize = GetXMLDataTypeSize(
+                    GetXMLAttribute(Names,Values,"type"));
+            Array.Format = GetXMLAttribute(Names,Values,"format");
+            Array.BinaryData = (Array.Format != "ascii");
+
+            std::string NumberOfComponents = \
+                GetXMLAttribute(Names,Values,"NumberOfComponents");
+            if(NumberOfComponents.empty() == false)
+            {
+                Array.NumberOfComponents = atoi(NumberOfComponents.c_str());
+            }
+
+            std::string NumberOfTuples = \
+                GetXMLAttribute(Names,Values,"NumberOfTuples");
+            Array.NumberOfTuples = NumberOfTuples.empty() ?
+                CurrentNumberOfTuples :
+                strtoull(NumberOfTuples.c_str(),NULL,10);
+
+            std::string Offset = GetXMLAttribute(Names,Values,"offset");
+            if(Offset.empty() == false)
+            {
+                Array.Offset = strtoll(Offset.c_str(),NULL,10);
+            }
+
+            CurrentArrays->push_back(Array);
+        }
+        else if(TagName == "AppendedData")
+        {
+            Header.AppendedDataEncoding = \
+                GetXMLAttribute(Names,Values,"encoding");
+
+            // Raw data starts after the underscore
+            char Character = 0;
+            while(InputFile.get(Character) && Character != '_')
+            {
+            }
+            Header.AppendedDataOffset = \
+                static_cast<long long>(InputFile.tellg());
+            break;
+        }
+    }
+
+    if(FoundVTKFile == false)
+    {
+        std::cerr << "Not a VTK XML file: " << InputFilename << std::endl;
+        return false;
+    }
+
+    if(Header.Pieces.empty() == true)
+    {
+        std::cerr << "No piece found in: " << InputFilename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// =========================
+// Scan Parallel File Header
+// =========================
+
+// Description:
+// Reads the tags of a partitioned file, such as a PVTU file, and then the
+// header of each of its piece files, which are named by the Source
+// attribute of its Piece elements. The pieces of the header are the pieces
+// of all piece files in order, each with the piece file that it is in. Only
+// the headers of the piece files are read, so the rows of every piece, and
+// thus their offsets in the output, are known before any data is read.
+// The headers of the piece files are kept, so they are not scanned again
+// when the pieces are read.
+
+bool ScanParallelFileHeader(
+        const char *InputFilename,
+        FileHeader &Header)                   // Output
+{
+    if(ScanXMLFileHeader(InputFilename,Header) == false)
+    {
+        return false;
+    }
+
+    std::vector<PieceHeader> ParallelPieces;
+    ParallelPieces.swap(Header.Pieces);
+
+    for(unsigned int ParallelPieceIterator = 0;
+        ParallelPieceIterator < ParallelPieces.size();
+        ParallelPieceIterator++)
+    {
+        const PieceHeader &ParallelPiece = \
+            ParallelPieces[ParallelPieceIterator];
+        if(ParallelPiece.Source.empty() == true)
+        {
+            std::cerr << "Piece " << ParallelPieceIterator << " of ";
+            std::cerr << InputFilename << " has no Source." << std::endl;
+            return false;
+        }
+
+        std::string SourceFilename = GetSourceFilename(
+                InputFilename,ParallelPiece.Source);
+        FileHeader SourceHeader;
+        if(ScanXMLFileHeader(SourceFilename.c_str(),SourceHeader) == false)
+        {
+            return false;
+        }
+
+        for(unsigned int PieceIterator = 0;
+            PieceIterator < SourceHeader.Pieces.size();
+            PieceIterator++)
+        {
+            PieceHeader &Piece = SourceHeader.Pieces[PieceIterator];
+            Piece.Source = SourceFilename;
+            Piece.SourcePiece = PieceIterator;
+            Piece.NumberOfSourcePieces = SourceHeader.Pieces.size();
+            Header.Pieces.push_back(Piece);
+        }
+
+        Header.SourceHeaders.push_back(SourceHeader);
+    }
+
+    if(Header.Pieces.empty() == true)
+    {
+        std::cerr << "No piece found in: " << InputFilename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// ===================
+// Get Source Filename
+// ===================
+
+// Description:
+// Filename of a piece file. A relative Source is relative to the directory
+// of the partitioned file.
+
+std::string GetSourceFilename(
+        const char *InputFilename,
+        const std::string &Source)
+{
+    if(Source.empty() == true || Source[0] == '/')
+    {
+        return Source;
+    }
+
+    std::string InputFilenameString(InputFilename);
+    std::size_t FoundLastSlash = InputFilenameString.find_last_of("/");
+    if(FoundLastSlash == std::string::npos)
+    {
+        return Source;
+    }
+
+    return InputFilenameString.substr(0,FoundLastSlash+1) + Source;
+}
+
+// ============================
+// Scan Multi Block File Header
+// ============================
+
+// Description:
+// Reads the tags of a multiblock file (VTM), whose leaves are DataSet
+// elements that name the dataset file of each block. The blocks of the
+// header are the dataset files in the order of the file, with the names of
+// the blocks above them. Leaves that are multiblock files themselves are
+// replaced by their own blocks. Empty leaves, without a file, are skipped.
+
+bool ScanMultiBlockFileHeader(
+        const char *InputFilename,
+        FileHeader &Header)                   // Output
+{
+    Header.Blocks.clear();
+    if(ScanMultiBlockElements(InputFilename,"",0,Header.Blocks) == false)
+    {
+        return false;
+    }
+
+    if(Header.Blocks.empty() == true)
+    {
+        std::cerr << "No block found in: " << InputFilename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// =========================
+// Scan Multi Block Elements
+// =========================
+
+// Description:
+// Appends the dataset files of a multiblock file to Blocks. The name of a
+// block is the name attribute of its element, or its index if it has no
+// name, preceded by the names of the blocks above it and by the Prefix.
+
+bool ScanMultiBlockElements(
+        const char *InputFilename,
+        const std::string &Prefix,
+        unsigned int Depth,
+        std::vector<BlockHeader> &Blocks)     // Output
+{
+    if(Depth > MULTIBLOCK_DEPTH)
+    {
+        std::cerr << "Multiblock files are nested too deeply: ";
+        std::cerr << InputFilename << std::endl;
+        return false;
+    }
+
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    std::string TagName;
+    std::vector<std::string> Names;
+    std::vector<std::string> Values;
+    bool EmptyElement = false;
+    bool FoundVTKFile = false;
+
+    // Names of the open Block elements
+    std::vector<std::string> BlockNames;
+
+    while(ReadXMLTag(InputFile,TagName,Names,Values,EmptyElement))
+    {
+        if(TagName == "VTKFile")
+        {
+            FoundVTKFile = true;
+            continue;
+        }
+        else if(FoundVTKFile == false)
+        {
+            continue;
+        }
+
+        std::string Name = GetXMLAttribute(Names,Values,"name");
+        if(Name.empty() == true)
+        {
+            Name = GetXMLAttribute(Names,Values,"index");
+        }
+
+        if(TagName == "Block" || TagName == "Piece")
+        {
+            if(EmptyElement == false)
+            {
+                BlockNames.push_back(Name);
+            }
+        }
+        else if(TagName == "/Block" || TagName == "/Piece")
+        {
+            if(BlockNames.empty() == false)
+            {
+                BlockNames.pop_back();
+            }
+        }
+        else if(TagName == "DataSet")
+        {
+            std::string File = GetXMLAttribute(Names,Values,"file");
+            if(File.empty() == true)
+            {
+                continue;
+            }
+
+            BlockHeader Block;
+            Block.Filename = GetSourceFilename(InputFilename,File);
+            Block.Name = Prefix;
+            for(unsigned int NameIterator = 0;
+                NameIterator <= BlockNames.size();
+                NameIterator++)
+            {
+                const std::string &BlockName = \
+                    NameIterator < BlockNames.size() ?
+                    BlockNames[NameIterator] : Name;
+                if(BlockName.empty() == false)
+                {
+                    Block.Name += (Block.Name.empty() ? "" : "/") + BlockName;
+                }
+            }
+
+            // Blocks of a nested multiblock file
+            std::string DataSetType;
+            if(DetectInputFileType(Block.Filename.c_str(),DataSetType) == VTM)
+            {
+                if(ScanMultiBlockElements(Block.Filename.c_str(),Block.Name,
+                            Depth+1,Blocks) == false)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            Blocks.push_back(Block);
+        }
+    }
+
+    if(FoundVTKFile == false)
+    {
+        std::cerr << "No VTKFile element found in: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// ============================
+// Scan Time Series File Header
+// ============================
+
+// Description:
+// Reads the DataSet elements of a time series file (PVD), each of which
+// names the dataset file of one time step, or of one part of a time step,
+// in its timestep and part attributes. The time steps of the header are
+// sorted by time value, and keep the order of the file for the same time
+// value. Elements without a file are skipped.
+
+bool ScanTimeSeriesFileHeader(
+        const char *InputFilename,
+        FileHeader &Header)                   // Output
+{
+    Header.TimeSteps.clear();
+
+    InputFileStream InputFile(InputFilename);
+    if(InputFile.is_open() != true)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    std::string TagName;
+    std::vector<std::string> Names;
+    std::vector<std::string> Values;
+    bool EmptyElement = false;
+    bool FoundVTKFile = false;
+
+    // Steps with their index in the file, to sort them stably
+    std::vector<std::pair<double,unsigned int> > TimeValues;
+    std::vector<TimeStepHeader> TimeSteps;
+
+    while(ReadXMLTag(InputFile,TagName,Names,Values,EmptyElement))
+    {
+        if(TagName == "VTKFile")
+        {
+            FoundVTKFile = true;
+            continue;
+        }
+        else if(FoundVTKFile == false || TagName != "DataSet")
+        {
+            continue;
+        }
+
+        std::string File = GetXMLAttribute(Names,Values,"file");
+        if(File.empty() == true)
+        {
+            continue;
+        }
+
+        TimeStepHeader TimeStep;
+        TimeStep.Filename = GetSourceFilename(InputFilename,File);
+        TimeStep.Part = GetXMLAttribute(Names,Values,"part");
+
+        std::string TimeValue = GetXMLAttribute(Names,Values,"timestep");
+        char *End = NULL;
+        TimeStep.TimeValue = strtod(TimeValue.c_str(),&End);
+        if(TimeValue.empty() == false && *End != '\0')
+        {
+            std::cerr << "Invalid timestep in " << InputFilename << ": ";
+            std::cerr << TimeValue << std::endl;
+            return false;
+        }
+
+        TimeValues.push_back(std::make_pair(TimeStep.TimeValue,
+                    static_cast<unsigned int>(TimeSteps.size())));
+        TimeSteps.push_back(TimeStep);
+    }
+
+    if(FoundVTKFile == false)
+    {
+        std::cerr << "No VTKFile element found in: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if(TimeSteps.empty() == true)
+    {
+        std::cerr << "No time step found in: " << InputFilename << std::endl;
+        return false;
+    }
+
+    std::sort(TimeValues.begin(),TimeValues.end());
+    for(unsigned int StepIterator = 0;
+        StepIterator < TimeValues.size();
+        StepIterator++)
+    {
+        Header.TimeSteps.push_back(TimeSteps[TimeValues[StepIterator].second]);
+    }
+
+    return true;
+}
+
+// ====================
+// Scan HDF File Header
+// ====================
+
+// Description:
+// Reads the attributes of the VTKHDF group of an HDF5 file, and the names,
+// types and shapes of the datasets of its PointData and CellData groups,
+// without reading their values. The datasets of all pieces of unstructured
+// data are stored one after another, so the header has one piece with the
+// tuples of all pieces. Files with time steps are left to vtkHDFReader.
+
+bool ScanHDFFileHeader(
+        const char *InputFilename,
+        FileHeader &Header)                   // Output
+{
+    HDFLibraryLock Lock;
+    hid_t File = H5Fopen(InputFilename,H5F_ACC_RDONLY,H5P_DEFAULT);
+    if(File < 0)
+    {
+        std::cerr << "Can not open input file: " << InputFilename;
+        std::cerr << std::endl;
+        return false;
+    }
+
+    hid_t Group = H5Gopen(File,"/VTKHDF",H5P_DEFAULT);
+    if(Group < 0)
+    {
+        std::cerr << "Not a VTKHDF file: " << InputFilename << std::endl;
+        H5Fclose(File);
+        return false;
+    }
+
+    bool Status = ReadHDFStringAttribute(Group,"Type",Header.DataSetType);
+    Header.BinaryData = true;
+    Header.Pieces.push_back(PieceHeader());
+    PieceHeader &Piece = Header.Pieces.back();
+
+    if(Status == false)
+    {
+        std::cerr << "VTKHDF group has no Type: " << InputFilename;
+        std::cerr << std::endl;
+    }
+    else if(H5Lexists(Group,"Steps",H5P_DEFAULT) > 0)
+    {
+        // Time steps
+        Status = false;
+    }
+    else if(Header.DataSetType == "ImageData")
+    {
+        Status = ReadHDFAttribute(Group,"WholeExtent",H5T_NATIVE_INT,6,
+                    Header.WholeExtent) &&
+                 ReadHDFAttribute(Group,"Origin",H5T_NATIVE_DOUBLE,3,
+                    Header.Origin) &&
+                 ReadHDFAttribute(Group,"Spacing",H5T_NATIVE_DOUBLE,3,
+                    Header.Spacing);
+
+        Piece.NumberOfPoints = 1;
+        Piece.NumberOfCells = 1;
+        for(unsigned int Dimension = 0; Dimension < 3; Dimension++)
+        {
+            Piece.Extent[2*Dimension] = Header.WholeExtent[2*Dimension];
+            Piece.Extent[2*Dimension+1] = Header.WholeExtent[2*Dimension+1];
+            long long Size = Piece.Extent[2*Dimension+1] - \
+                             Piece.Extent[2*Dimension] + 1;
+            Piece.NumberOfPoints *= Size;
+            Piece.NumberOfCells *= (Size > 1 ? Size - 1 : 1);
+        }
+
+        if(Status == false)
+        {
+            std::cerr << "Can not read extent of image data: ";
+            std::cerr << InputFilename << std::endl;
+        }
+    }
+    else if(Header.DataSetType == "UnstructuredGrid" ||
+            Header.DataSetType == "PolyData")
+    {
+        Status = SumHDFDataset(Group,"NumberOfPoints",Piece.NumberOfPoints);
+
+        if(Header.DataSetType == "UnstructuredGrid")
+        {
+            Status = Status &&
+                SumHDFDataset(Group,"NumberOfCells",Piece.NumberOfCells);
+        }
+        else
+        {
+            const char *PolyDataCells[4] = {
+                "Vertices/NumberOfCells","Lines/NumberOfCells",
+                "Strips/NumberOfCells","Polygons/NumberOfCells"};
+            for(unsigned int i = 0; Status == true && i < 4; i++)
+            {
+                unsigned long long NumberOfCells = 0;
+                Status = SumHDFDataset(Group,PolyDataCells[i],NumberOfCells);
+                Piece.NumberOfCells += NumberOfCells;
+            }
+        }
+
+        if(Status == false)
+        {
+            std::cerr << "Can not read number of points and cells: ";
+            std::cerr << InputFilename << std::endl;
+        }
+        else
+        {
+            // Explicit points
+            std::vector<ArrayHeader> Points;
+            ScanHDFDatasets(Group,"",NULL,Piece.NumberOfPoints,Points);
+            for(unsigned int i = 0; i < Points.size(); i++)
+            {
+                if(Points[i].Name == "Points" &&
+                   Points[i].NumberOfComponents == 3)
+                {
+                    Piece.Points = Points[i];
+                }
+            }
+        }
+    }
+    else
+    {
+        std::cerr << "Unsupported VTKHDF dataset type: ";
+        std::cerr << Header.DataSetType << std::endl;
+        Status = false;
+    }
+
+    // Point and cell data arrays
+    if(Status == true)
+    {
+        bool Structured = (Header.DataSetType == "ImageData");
+        int CellExtent[6];
+        GetCellExtent(Header.WholeExtent,Header.WholeExtent,CellExtent);
+
+        ScanHDFDatasets(Group,"PointData",
+                Structured == true ? Header.WholeExtent : NULL,
+                Piece.NumberOfPoints,Piece.PointArrays);
+        ScanHDFDatasets(Group,"CellData",
+                Structured == true ? CellExtent : NULL,
+                Piece.NumberOfCells,Piece.CellArrays);
+    }
+
+    H5Gclose(Group);
+    H5Fclose(File);
+
+    return Status;
+}
+
+// =================
+// Scan HDF Datasets
+// =================
+
+// Description:
+// Appends a header for each dataset of a group, in the order the datasets
+// were created, or by name if the order is not tracked. The datasets of
+// image data have the k, j and i dimensions of the extent, followed by the
+// components, and those of unstructured data have the tuples, followed by
+// the components. Datasets of another shape or of a type that is not a
+// number have a VTK_VOID type, and are not read natively.
+
+void ScanHDFDatasets(
+        hid_t ParentGroup,
+        const char *GroupName,
+        const int *Extent,
+        unsigned long long NumberOfTuples,
+        std::vector<ArrayHeader> &Arrays)     // Output
+{
+    hid_t Group = H5Gopen(ParentGroup,
+            GroupName[0] == '\0' ? "." : GroupName,H5P_DEFAULT);
+    H5G_info_t GroupInfo;
+    if(Group < 0 || H5Gget_info(Group,&GroupInfo) < 0)
+    {
+        if(Group >= 0)
+        {
+            H5Gclose(Group);
+        }
+        return;
+    }
+
+    H5_index_t Index = H5_INDEX_CRT_ORDER;
+    char Name[1024];
+    if(H5Lget_name_by_idx(Group,".",Index,H5_ITER_INC,0,Name,sizeof(Name),
+                H5P_DEFAULT) < 0)
+    {
+        Index = H5_INDEX_NAME;
+    }
+
+    for(hsize_t LinkIterator = 0;
+        LinkIterator < GroupInfo.nlinks;
+        LinkIterator++)
+    {
+        if(H5Lget_name_by_idx(Group,".",Index,H5_ITER_INC,LinkIterator,Name,
+                    sizeof(Name),H5P_DEFAULT) < 0)
+        {
+            continue;
+        }
+
+        // Links to groups are skipped
+        hid_t Dataset = H5Dopen(Group,Name,H5P_DEFAULT);
+        if(Dataset < 0)
+        {
+            continue;
+        }
+
+        ArrayHeader Array;
+        Array.Name = Name;
+        Array.Format = "hdf5";
+        Array.BinaryData = true;
+        Array.NumberOfTuples = NumberOfTuples;
+
+        hid_t FileSpace = H5Dget_space(Dataset);
+        hid_t FileType = H5Dget_type(Dataset);
+
+        std::string TypeName = GetHDFDataTypeName(FileType);
+        Array.DataType = LookupXMLDataType(TypeName);
+        Array.ValueSize = GetXMLDataTypeSize(TypeName);
+
+        // Shape of the dataset
+        hsize_t Dimensions[4] = {0,0,0,0};
+        int Rank = H5Sget_simple_extent_ndims(FileSpace);
+        int TupleRank = (Extent != NULL ? 3 : 1);
+        bool Shape = (Rank == TupleRank || Rank == TupleRank + 1);
+        if(Shape == true)
+        {
+            H5Sget_simple_extent_dims(FileSpace,Dimensions,NULL);
+        }
+
+        for(int RankIterator = 0;
+            Shape == true && RankIterator < TupleRank;
+            RankIterator++)
+        {
+            int Dimension = TupleRank - 1 - RankIterator;
+            hsize_t Size = (Extent != NULL ?
+                    Extent[2*Dimension+1] - Extent[2*Dimension] + 1 :
+                    NumberOfTuples);
+            Shape = (Dimensions[RankIterator] == Size);
+        }
+
+        if(Shape == true && Rank > TupleRank)
+        {
+            Array.NumberOfComponents = Dimensions[TupleRank];
+        }
+        if(Shape == false || Array.NumberOfComponents == 0)
+        {
+            Array.DataType = VTK_VOID;
+            Array.ValueSize = 0;
+        }
+
+        H5Tclose(FileType);
+        H5Sclose(FileSpace);
+        H5Dclose(Dataset);
+
+        Arrays.push_back(Array);
+    }
+
+    H5Gclose(Group);
+}
+
+// ======================
+// Get HDF Data Type Name
+// ======================
+
+// Description:
+// The XML name of an HDF5 integer or floating point type of a file, such as
+// Int32 or Float64, or an empty string for other types.
+
+std::string GetHDFDataTypeName(hid_t FileType)
+{
+    H5T_class_t TypeClass = H5Tget_class(FileType);
+    unsigned int Bits = 8 * H5Tget_size(FileType);
+    std::ostringstream TypeName;
+
+    if(TypeClass == H5T_INTEGER)
+    {
+        TypeName << (H5Tget_sign(FileType) == H5T_SGN_NONE ? "UInt" : "Int");
+        TypeName << Bits;
+    }
+    else if(TypeClass == H5T_FLOAT)
+    {
+        TypeName << "Float" << Bits;
+    }
+
+    return TypeName.str();
+}
+
+// ==================
+// Read HDF Attribute
+// ==================
+
+// Description:
+// Reads a numeric attribute with the given number of values.
+
+bool ReadHDFAttribute(
+        hid_t Object,
+        const char *Name,
+        hid_t MemoryType,
+        unsigned int NumberOfValues,
+        void *Values)                         // Output
+{
+    hid_t Attribute = H5Aopen(Object,Name,H5P_DEFAULT);
+    if(Attribute < 0)
+    {
+        return false;
+    }
+
+    hid_t Space = H5Aget_space(Attribute);
+    bool Status = (H5Sget_simple_extent_npoints(Space) == NumberOfValues) &&
+                  (H5Aread(Attribute,MemoryType,Values) >= 0);
+
+    H5Sclose(Space);
+    H5Aclose(Attribute);
+
+    return Status;
+}
+
+// =========================
+// Read HDF String Attribute
+// =========================
+
+// Description:
+// Reads a string attribute of fixed or variable length.
+
+bool ReadHDFStringAttribute(
+        hid_t Object,
+        const char *Name,
+        std::string &Value)                   // Output
+{
+    hid_t Attribute = H5Aopen(Object,Name,H5P_DEFAULT);
+    if(Attribute < 0)
+    {
+        return false;
+    }
+
+    hid_t FileType = H5Aget_type(Attribute);
+    hid_t MemoryType = H5Tget_native_type(FileType,H5T_DIR_ASCEND);
+    bool Status = (H5Tget_class(FileType) == H5T_STRING);
+
+    if(Status == true && H5Tis_variable_str(FileType) > 0)
+    {
+        char *String = NULL;
+        Status = (H5Aread(Attribute,MemoryType,&String) >= 0);
+        if(Status == true && String != NULL)
+        {
+            Value = String;
+            H5free_memory(String);
+        }
+    }
+    else if(Status == true)
+    {
+        std::vector<char> String(H5Tget_size(FileType) + 1,'\0');
+        Status = (H5Aread(Attribute,MemoryType,&String[0]) >= 0);
+        Value = &String[0];
+    }
+
+    H5Tclose(MemoryType);
+    H5Tclose(FileType);
+    H5Aclose(Attribute);
+
+    return Status;
+}
+
+// ===============
+// Sum HDF Dataset
+// ===============
+
+// Description:
+// Sum of the values of an integer dataset, such as the number of points of
+// each piece of unstructured data.
+
+bool SumHDFDataset(
+        hid_t Group,
+        const char *Name,
+        unsigned long long &Sum)              // Output
+{
+    Sum = 0;
+    hid_t Dataset = H5Dopen(Group,Name,H5P_DEFAULT);
+    if(Dataset < 0)
+    {
+        return false;
+    }
+
+    hid_t Space = H5Dget_space(Dataset);
+    hssize_t NumberOfValues = H5Sget_simple_extent_npoints(Space);
+    std::vector<unsigned long long> Values(
+            NumberOfValues > 0 ? NumberOfValues : 0);
+    bool Status = NumberOfValues == 0 ||
+        (NumberOfValues > 0 && H5Dread(Dataset,H5T_NATIVE_ULLONG,H5S_ALL,
+            H5S_ALL,H5P_DEFAULT,&Values[0]) >= 0);
+
+    for(unsigned int i = 0; i < Values.size(); i++)
+    {
+        Sum += Values[i];
+    }
+
+    H5Sclose(Space);
+    H5Dclose(Dataset);
+
+    return Status;
+}
+
+// ===================
+// Print Probe Summary
+// ===================
+
+// Description:
+// Prints one line of JSON. Arrays of all pieces are merged by their order in
+// the first piece, and their tuples are summed. The predicted number of rows,
+// columns and output bytes refer to the point data arrays, which should all
+// have a tuple per point, as the conversion checks. Otherwise, no line is
+// printed and false is returned.
+
+bool PrintProbeSummary(
+        const char *InputFilename,
+        const FileHeader &Header)
+{
+    // Merge pieces
+    std::vector<ArrayHeader> Arrays[2];
+    unsigned long long NumberOfPoints = 0;
+    unsigned long long NumberOfCells = 0;
+
+    for(unsigned int PieceIterator = 0;
+        PieceIterator < Header.Pieces.size();
+        PieceIterator++)
+    {
+        const PieceHeader &Piece = Header.Pieces[PieceIterator];
+        NumberOfPoints += Piece.NumberOfPoints;
+        NumberOfCells += Piece.NumberOfCells;
+
+        const std::vector<ArrayHeader> *PieceArrays[2] = {
+            &Piece.PointArrays,&Piece.CellArrays};
+
+        for(unsigned int AttributeIterator = 0;
+            AttributeIterator < 2;
+            AttributeIterator++)
+        {
+            if(PieceIterator == 0)
+            {
+                Arrays[AttributeIterator] = *PieceArrays[AttributeIterator];
+                continue;
+            }
+
+            for(unsigned int ArrayIterator = 0;
+                ArrayIterator < Arrays[AttributeIterator].size() &&
+                ArrayIterator < PieceArrays[AttributeIterator]->size();
+                ArrayIterator++)
+            {
+                Arrays[AttributeIterator][ArrayIterator].NumberOfTuples += \
+                    (*PieceArrays[AttributeIterator])[ArrayIterator]. \
+                    NumberOfTuples;
+            }
+        }
+    }
+
+    // Output matrix
+    unsigned long long NumberOfRows = NumberOfPoints;
+    unsigned long long NumberOfColumns = 0;
+    for(unsigned int ArrayIterator = 0;
+        ArrayIterator < Arrays[0].size();
+        ArrayIterator++)
+    {
+        const ArrayHeader &Array = Arrays[0][ArrayIterator];
+        if(ArrayIterator == 0 && NumberOfPoints == 0)
+        {
+            NumberOfRows = Array.NumberOfTuples;
+        }
+        else if(Array.NumberOfTuples != NumberOfRows)
+        {
+            std::cerr << "Inconsistent file: " << InputFilename << ": ";
+            std::cerr << "number of tuples in arrays are not the same.";
+            std::cerr << std::endl;
+            return false;
+        }
+
+        NumberOfColumns += Array.NumberOfComponents;
+    }
+
+    std::ostringstream Summary;
+    Summary << "{\"file\":\"" << EscapeJSONString(InputFilename) << "\"";
+    Summary << ",\"format\":\"" << GetInputFileTypeName(Header.FileType);
+    Summary << "\",\"dataset\":\"" << EscapeJSONString(Header.DataSetType);
+    Summary << "\",\"pieces\":" << Header.Pieces.size();
+    Summary << ",\"points\":" << NumberOfPoints;
+    Summary << ",\"cells\":" << NumberOfCells;
+
+    const char *AttributeNames[2] = {"point_arrays","cell_arrays"};
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < 2;
+        AttributeIterator++)
+    {
+        Summary << ",\"" << AttributeNames[AttributeIterator] << "\":[";
+        for(unsigned int ArrayIterator = 0;
+            ArrayIterator < Arrays[AttributeIterator].size();
+            ArrayIterator++)
+        {
+            const ArrayHeader &Array = \
+                Arrays[AttributeIterator][ArrayIterator];
+            Summary << (ArrayIterator > 0 ? "," : "");
+            Summary << "{\"name\":\"" << EscapeJSONString(Array.Name);
+            Summary << "\",\"type\":\"" << GetDataTypeName(Array.DataType);
+            Summary << "\",\"components\":" << Array.NumberOfComponents;
+            Summary << ",\"tuples\":" << Array.NumberOfTuples << "}";
+        }
+        Summary << "]";
+    }
+
+    Summary << ",\"rows\":" << NumberOfRows;
+    Summary << ",\"columns\":" << NumberOfColumns;
+    Summary << ",\"output_bytes\":";
+    Summary << NumberOfRows * NumberOfColumns * sizeof(double) << "}";
+
+    std::cout << Summary.str() << std::endl;
+
+    return true;
+}
+
+// ================
+// Read Legacy Line
+// ================
+
+// Description:
+// Reads the next non-empty line of a legacy file, without the trailing
+// carriage return and surrounding white spaces.
+
+bool ReadLegacyLine(
+        std::istream &InputFile,
+        std::string &Line)                    // Output
+{
+    while(std::getline(InputFile,Line))
+    {
+        std::size_t First = Line.find_first_not_of(" \t\r\n");
+        if(First == std::string::npos)
+        {
+            continue;
+        }
+        std::size_t Last = Line.find_last_not_of(" \t\r\n");
+        Line = Line.substr(First,Last-First+1);
+        return true;
+    }
+
+    return false;
+}
+
+// =====================
+// Skip Legacy Meta Data
+// =====================
+
+// Description:
+// A METADATA block (INFORMATION and COMPONENT_NAMES) ends with an empty line.
+
+bool SkipLegacyMetaData(std::istream &InputFile)
+{
+    std::string Line;
+    while(std::getline(InputFile,Line))
+    {
+        if(Line.find_first_not_of(" \t\r\n") == std::string::npos)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ==================
+// Skip Legacy Values
+// ==================
+
+// Description:
+// Binary values are skipped by seeking over their bytes. ASCII values are
+// skipped by counting white space separated tokens.
+
+bool SkipLegacyValues(
+        std::istream &InputFile,
+        bool BinaryData,
+        const std::string &LegacyTypeName,
+        unsigned long long NumberOfValues)
+{
+    if(BinaryData == true)
+    {
+        int DataTypeSize = GetLegacyDataTypeSize(LegacyTypeName);
+        unsigned long long NumberOfBytes = 0;
+
+        if(LookupLegacyDataType(LegacyTypeName) == VTK_BIT)
+        {
+            NumberOfBytes = (NumberOfValues + 7) / 8;
+        }
+        else if(DataTypeSize > 0)
+        {
+            NumberOfBytes = NumberOfValues * DataTypeSize;
+        }
+        else
+        {
+            std::cerr << "Unsupported legacy data type: " << LegacyTypeName;
+            std::cerr << std::endl;
+            return false;
+        }
+
+        InputFile.seekg(NumberOfBytes,std::ios::cur);
+    }
+    else
+    {
+        std::streambuf *Buffer = InputFile.rdbuf();
+        for(unsigned long long ValueIterator = 0;
+            ValueIterator < NumberOfValues;
+            ValueIterator++)
+        {
+            // Leading white spaces
+            int Character = Buffer->sbumpc();
+            while(Character != EOF && isspace(Character))
+            {
+                Character = Buffer->sbumpc();
+            }
+
+            // Token
+            while(Character != EOF && !isspace(Character))
+            {
+                Character = Buffer->sbumpc();
+            }
+
+            if(Character == EOF && ValueIterator + 1 < NumberOfValues)
+            {
+                InputFile.setstate(std::ios::eofbit);
+                break;
+            }
+        }
+    }
+
+    if(InputFile.good() != true)
+    {
+        std::cerr << "Unexpected end of legacy file." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// =====================
+// Is Legacy Number Word
+// =====================
+
+// Description:
+// Whether an upper case word of an ASCII legacy file is a value rather than
+// a keyword.
+
+bool IsLegacyNumberWord(const std::string &Word)
+{
+    return Word == "NAN" || Word == "INF" || Word == "INFINITY";
+}
+
+// ===================
+// Skip Legacy Section
+// ===================
+
+// Description:
+// Skips the values of a section of a legacy file whose number of values is
+// given by its header line, and leaves the file at the next header line.
+// Binary values, and ASCII strings, are skipped as SkipLegacyValues does.
+// Other ASCII values are not counted: since every value is a number, the
+// section ends at the first line that starts with a word other than nan or
+// inf, which is found in large reads of the file.
+
+bool SkipLegacySection(
+        std::istream &InputFile,
+        bool BinaryData,
+        const std::string &LegacyTypeName,
+        unsigned long long NumberOfValues)
+{
+    if(BinaryData == true ||
+       LookupLegacyDataType(LegacyTypeName) == VTK_STRING)
+    {
+        return SkipLegacyValues(InputFile,BinaryData,LegacyTypeName,
+                NumberOfValues);
+    }
+
+    long long Position = static_cast<long long>(InputFile.tellg());
+    if(Position < 0)
+    {
+        std::cerr << "Unexpected end of legacy file." << std::endl;
+        return false;
+    }
+
+    // The section starts at the beginning of a line
+    long long LineStart = Position;
+    bool InValues = false;               // Past the first value of the line
+    bool Found = false;
+    std::string Word;                    // Leading letters of the line
+
+    std::vector<char> Block(65536);
+    while(Found == false &&
+          (InputFile.read(&Block[0],Block.size()) || InputFile.gcount() > 0))
+    {
+        long long Count = InputFile.gcount();
+        for(long long ByteIterator = 0;
+            ByteIterator < Count && Found == false;
+            ByteIterator++)
+        {
+            // Values up to the end of the line
+            if(InValues == true)
+            {
+                const void *NewLine = memchr(&Block[ByteIterator],'\n',
+                        Count - ByteIterator);
+                if(NewLine == NULL)
+                {
+                    break;
+                }
+                ByteIterator = static_cast<const char*>(NewLine) - &Block[0];
+            }
+
+            char Character = Block[ByteIterator];
+            bool Letter = isalpha(static_cast<unsigned char>(Character));
+
+            if(Word.empty() == false && Letter == false)
+            {
+                // A line that starts with nan, inf or infinity has values
+                Found = (IsLegacyNumberWord(Word) == false ||
+                         isspace(static_cast<unsigned char>(Character)) == 0);
+                Word.clear();
+                InValues = true;
+            }
+
+            if(Found == true)
+            {
+                break;
+            }
+            else if(Character == '\n')
+            {
+                InValues = false;
+                LineStart = Position + ByteIterator + 1;
+            }
+            else if(InValues == true || Character == ' ' ||
+                    Character == '\t' || Character == '\r')
+            {
+                continue;
+            }
+            else if(Letter == true)
+            {
+                Word += static_cast<char>(toupper(Character));
+                Found = (Word.size() > 8);
+            }
+            else
+            {
+                InValues = true;
+            }
+        }
 
-    if(FoundLastDot != std::string::npos)
-    {
-        std::string FileExtensionString = InputFilenameString.substr(
-                FoundLastDot+1,std::string::npos);
-        strcpy(FileExtension,FileExtensionString.c_str());
-    }
-    else
-    {
-        std::cerr << "No file extension found in the Input filename.";
-        std::cerr << std::endl;
-        exit(1);
+        Position += Count;
     }
 
-    // Compare file extension
-    if(strcmp(FileExtension,"vtk") == 0)
-    {
-        // VTK file
-        return VTK;
-    }
-    else if(strcmp(FileExtension,"vti") == 0)
-    {
-        // VTI file
-        return VTI;
-    }
-    else if(strcmp(FileExtension,"VTP"))
-    {
-        // VTP file
-        return VTP;
-    }
-    else if(strcmp(FileExtension,"VTU"))
+    // A header line on the last line of the file
+    if(Word.empty() == false && IsLegacyNumberWord(Word) == false)
     {
-        return VTU;
+        Found = true;
     }
-    else
+
+    // Next header line, or the end of the file
+    if(Found == true)
     {
-        std::cerr << "No valid input file extension found." << std::endl;
-        exit(1);
+        InputFile.clear();
+        InputFile.seekg(LineStart);
     }
+
+    return true;
 }
 
-// ========================================
-// Read VTK Input File Write To Output File
-// ========================================
+// ============
+// Read XML Tag
+// ============
 
 // Description:
-//
-// Note that VTK legacy file readers such as
-//    StructuredPointsReader,
-//    StructuredGridReader,
-//    UnstructuredGridReader,
-//    ImageDataReader,
-//    PolyDataReader
-// Do not read all Scalars and vectors and Tensors. They only read the first
-// scalar, the first vector, etc. To Read them all, we should add enable
-// methods ReadAll...On.
-//
-// Note: For XML data (see next functions), these options do not have to be
-// enabled, since XML readers will read all scalars, vectors, etc.
-//
-// This method assumes that the VTK legacy data file is StructuredPoints.
+// Reads the next XML tag and its attributes. Text between tags, comments and
+// processing instructions are skipped. The tag name of a closing tag starts
+// with "/". EmptyElement is true for a tag that closes itself, such as
+// <Block index="0"/>, which has no closing tag.
 
-void ReadVTKInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile)
+bool ReadXMLTag(
+        std::istream &InputFile,
+        std::string &TagName,                 // Output
+        std::vector<std::string> &AttributeNames,    // Output
+        std::vector<std::string> &AttributeValues,   // Output
+        bool &EmptyElement)                   // Output
 {
-    // Reader
-    vtkSmartPointer<vtkStructuredPointsReader> StructuredPointsReader = \
-            vtkSmartPointer<vtkStructuredPointsReader>::New();
-    StructuredPointsReader->SetFileName(InputFilename);
-    StructuredPointsReader->ReadAllScalarsOn();
-    StructuredPointsReader->ReadAllVectorsOn();
-    StructuredPointsReader->ReadAllNormalsOn();
-    StructuredPointsReader->ReadAllTensorsOn();
-    StructuredPointsReader->ReadAllFieldsOn();
-    StructuredPointsReader->Update();
-
-    // Get Point Data from loaded file
-    vtkPointData *InputPointData = \
-            StructuredPointsReader->GetOutput()->GetPointData();
-
-    // WriteArraysToOutputFile(OutputFilename,ArraysInFile);
-    WriteArraysToOutputFile(InputPointData,OutputFilename,BinaryOutputFile);
-}
+    std::streambuf *Buffer = InputFile.rdbuf();
+    std::string Tag;
 
-// ========================================
-// Read VTI Input File Write To Output File
-// ========================================
+    while(true)
+    {
+        // Skip text until the next tag
+        int Character = Buffer->sbumpc();
+        while(Character != EOF && Character != '<')
+        {
+            Character = Buffer->sbumpc();
+        }
+        if(Character == EOF)
+        {
+            return false;
+        }
 
-void ReadVTIInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile)
-{
-    // Reader
-    vtkSmartPointer<vtkXMLImageDataReader> ImageDataReader = \
-            vtkSmartPointer<vtkXMLImageDataReader>::New();
-    ImageDataReader->SetFileName(InputFilename);
-    ImageDataReader->Update();
+        // Read the tag up to the closing bracket outside of quotes
+        Tag.clear();
+        char Quote = 0;
+        Character = Buffer->sbumpc();
+        while(Character != EOF && (Character != '>' || Quote != 0))
+        {
+            if(Quote == 0 && (Character == '"' || Character == '\''))
+            {
+                Quote = static_cast<char>(Character);
+            }
+            else if(Character == Quote)
+            {
+                Quote = 0;
+            }
+            Tag.push_back(static_cast<char>(Character));
+            Character = Buffer->sbumpc();
+        }
+        if(Character == EOF)
+        {
+            return false;
+        }
 
-    // Get Point data from loaded file
-    vtkPointData *InputPointData = \
-            ImageDataReader->GetOutput()->GetPointData();
+        // Skip comments, declarations and processing instructions
+        if(Tag.empty() == false && (Tag[0] == '!' || Tag[0] == '?'))
+        {
+            continue;
+        }
 
-    // Write to output file
-    WriteArraysToOutputFile(InputPointData,OutputFilename,BinaryOutputFile);
-}
+        break;
+    }
 
-// ========================================
-// Read VTP Input File Write To Output File
-// ========================================
+    // Tag name
+    EmptyElement = (Tag.empty() == false && Tag[Tag.size()-1] == '/');
+    std::size_t Position = Tag.find_first_of(" \t\r\n/",1);
+    TagName = Tag.substr(0,Position);
+    AttributeNames.clear();
+    AttributeValues.clear();
 
-void ReadVTPInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile)
-{
-    // Reader
-    vtkSmartPointer<vtkXMLPolyDataReader> PolyDataReader = \
-            vtkSmartPointer<vtkXMLPolyDataReader>::New();
-    PolyDataReader->SetFileName(InputFilename);
-    PolyDataReader->Update();
+    // Attributes as name="value" pairs
+    while(Position != std::string::npos)
+    {
+        std::size_t NameStart = Tag.find_first_not_of(" \t\r\n/",Position);
+        if(NameStart == std::string::npos)
+        {
+            break;
+        }
+        std::size_t Equal = Tag.find('=',NameStart);
+        if(Equal == std::string::npos)
+        {
+            break;
+        }
+        std::size_t ValueStart = Tag.find_first_of("\"'",Equal);
+        if(ValueStart == std::string::npos)
+        {
+            break;
+        }
+        std::size_t ValueEnd = Tag.find(Tag[ValueStart],ValueStart+1);
+        if(ValueEnd == std::string::npos)
+        {
+            break;
+        }
 
-    // Get Point Data from loaded file
-    vtkPointData *InputPointData = \
-            PolyDataReader->GetOutput()->GetPointData();
+        std::string Name = Tag.substr(NameStart,Equal-NameStart);
+        Name = Name.substr(0,Name.find_last_not_of(" \t\r\n")+1);
+        AttributeNames.push_back(Name);
+        AttributeValues.push_back(
+                Tag.substr(ValueStart+1,ValueEnd-ValueStart-1));
+        Position = ValueEnd + 1;
+    }
 
-    // Write to output file
-    WriteArraysToOutputFile(InputPointData,OutputFilename,BinaryOutputFile);
+    return true;
 }
 
-// ========================================
-// Read VTU Input File Write To Output File
-// ========================================
+// =================
+// Get XML Attribute
+// =================
 
-void ReadVTUInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile)
-{
-    // Reader
-    vtkSmartPointer<vtkXMLUnstructuredGridReader> UnstructuredGridReader = \
-            vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-    UnstructuredGridReader->SetFileName(InputFilename);
-    UnstructuredGridReader->Update();
+// Description:
+// Returns the value of the attribute, or an empty string if not found.
 
-    // Get Point data from loaded file
-    vtkPointData *InputPointData = \
-            UnstructuredGridReader->GetOutput()->GetPointData();
+std::string GetXMLAttribute(
+        const std::vector<std::string> &AttributeNames,
+        const std::vector<std::string> &AttributeValues,
+        const char *Name)
+{
+    for(unsigned int AttributeIterator = 0;
+        AttributeIterator < AttributeNames.size();
+        AttributeIterator++)
+    {
+        if(AttributeNames[AttributeIterator] == Name)
+        {
+            return AttributeValues[AttributeIterator];
+        }
+    }
 
-    // Write to output file
-    WriteArraysToOutputFile(InputPointData,OutputFilename,BinaryOutputFile);
+    return std::string();
 }
 
-// ===========================
-// Write Arrays To Output File
-// ===========================
+// ==========
+// Data Types
+// ==========
 
 // Description:
-// This method finds the number of arrays in the PointData of the DataSet.
-// - Each array may have different number of components.
-// - But all arrays should have the same number of tuples.
-//
-// The output is written to OutputFile as following:
-// The output array is an array of size:
-//     "Number of total components of all arrays" x "number of tuples".
-//
-//  where, the "Number of total components of all arrays" is the sum of number
-//  of components of all arrays. If we have found three Arrays:
-//
-//  Array A: size a * m
-//  Array B: size b * m
-//  Array C: size c * m
-//
-//  Then the output array is of size (a+b+c) * m, and is written as follow
-//
-//              Column 1         Column 2         Column 3
-//
-//  First row:    A11 A12 A13 ...  B11 B12 B13 ...  C11 C12 C13 ...
-//  Second row:   A21 A22 A23 ...  B21 B22 B23 ...  C21 C22 C23 ...
-//                <-- a times -->  <-- b times -->  <-- c times -->
-//                ...
-//                ...
-//  m-th row:     Am1 Am2 Am3 ...  Bm1 Bm2 Bm3 ...  Cm1 Cm2 Cm3 ...
+// Names of data types in legacy files and in XML files. The size is the
+// number of bytes of one value in the file. Note that the legacy writer
+// stores vtkIdType values as 4-byte integers.
 
-void WriteArraysToOutputFile(
-        vtkPointData *InputPointData,
-        char *OutputFilename,
-        bool BinaryOutputFile)
+struct DataTypeEntry
 {
-    // Find number of arrays and their components
-    int NumberOfArrays = InputPointData->GetNumberOfArrays();
+    const char *LegacyName;
+    const char *XMLName;
+    int DataType;
+    int Size;
+};
 
-    // Check for empty arrays
-    if(NumberOfArrays < 1)
-    {
-        std::cerr << "DataSet has no array." << std::endl;
-        exit(1);
-    }
+static const DataTypeEntry DataTypeTable[] = {
+    {"unsigned_char",  "UInt8",   VTK_UNSIGNED_CHAR,      1},
+    {"char",           "Int8",    VTK_CHAR,               1},
+    {"signed_char",    "Int8",    VTK_SIGNED_CHAR,        1},
+    {"unsigned_short", "UInt16",  VTK_UNSIGNED_SHORT,     2},
+    {"short",          "Int16",   VTK_SHORT,              2},
+    {"unsigned_int",   "UInt32",  VTK_UNSIGNED_INT,       4},
+    {"int",            "Int32",   VTK_INT,                4},
+    {"vtktypeuint64",  "UInt64",  VTK_UNSIGNED_LONG_LONG, 8},
+    {"vtktypeint64",   "Int64",   VTK_LONG_LONG,          8},
+    {"unsigned_long",  "UInt64",  VTK_UNSIGNED_LONG,      8},
+    {"long",           "Int64",   VTK_LONG,               8},
+    {"vtkidtype",      "Int64",   VTK_ID_TYPE,            4},
+    {"float",          "Float32", VTK_FLOAT,              4},
+    {"double",         "Float64", VTK_DOUBLE,             8},
+    {"bit",            "Bit",     VTK_BIT,                0},
+    {"string",         "String",  VTK_STRING,             0}
+};
 
-    // Number of components of each of the arrays
-    unsigned int NumberOfComponentsInEachArray[NumberOfArrays];
-    unsigned int NumberOfTuplesInEachArray[NumberOfArrays];
-    unsigned int ColumnCounter = 0;
+static const unsigned int NumberOfDataTypes = \
+    sizeof(DataTypeTable) / sizeof(DataTypeEntry);
 
-    // Create Array for pointing to the each of the data arrays
-    vtkDataArray *InputDataArrays[NumberOfArrays];
-    for(unsigned int ArrayIterator = 0;
-        ArrayIterator < NumberOfArrays;
-        ArrayIterator++)
-    {
-        // Get point to array
-        InputDataArrays[ArrayIterator] = \
-                InputPointData->GetArray(ArrayIterator);
+// =======================
+// Lookup Legacy Data Type
+// =======================
 
-        // Check array
-        if(InputDataArrays[ArrayIterator] == NULL)
+int LookupLegacyDataType(const std::string &LegacyTypeName)
+{
+    for(unsigned int TypeIterator = 0;
+        TypeIterator < NumberOfDataTypes;
+        TypeIterator++)
+    {
+        if(strcasecmp(LegacyTypeName.c_str(),
+                    DataTypeTable[TypeIterator].LegacyName) == 0)
         {
-            std::cerr << "Array " << ArrayIterator << " is NULL." << std::endl;
+            return DataTypeTable[TypeIterator].DataType;
         }
+    }
 
-        // Get number of components
-        NumberOfComponentsInEachArray[ArrayIterator] = \
-                InputDataArrays[ArrayIterator]->GetNumberOfComponents();
-        NumberOfTuplesInEachArray[ArrayIterator] = \
-                InputDataArrays[ArrayIterator]->GetNumberOfTuples();
+    return VTK_VOID;
+}
 
-        // Check tuples
-        if(ArrayIterator > 0)
+// ====================
+// Lookup XML Data Type
+// ====================
+
+int LookupXMLDataType(const std::string &XMLTypeName)
+{
+    for(unsigned int TypeIterator = 0;
+        TypeIterator < NumberOfDataTypes;
+        TypeIterator++)
+    {
+        if(XMLTypeName == DataTypeTable[TypeIterator].XMLName)
         {
-            if(NumberOfTuplesInEachArray[ArrayIterator] != \
-                NumberOfTuplesInEachArray[0])
-            {
-                std::cerr << "Inconsistent file: ";
-                std::cerr << "number of tuples in arrays are not the same.";
-                std::cerr << std::endl;
-                exit(1);
-            }
+            return DataTypeTable[TypeIterator].DataType;
         }
-
-        // Update total number of columns
-        ColumnCounter += NumberOfComponentsInEachArray[ArrayIterator];
-
-        std::cout << "Array: " << ArrayIterator << ", NumberOfComponents: ";
-        std::cout << NumberOfComponentsInEachArray[ArrayIterator];
-        std::cout << ", NumberOfTuples: ";
-        std::cout << NumberOfTuplesInEachArray[ArrayIterator];
-        std::cout << ", ArrayName: ";
-        std::cout << InputDataArrays[ArrayIterator]->GetName();
-        std::cout << std::endl;
     }
 
-    // Open output file
-    std::ofstream OutputFile;
-    OpenFile(OutputFilename,BinaryOutputFile,OutputFile);
+    return VTK_VOID;
+}
 
-    // Write to ASCII or Binary
-    if(BinaryOutputFile == false)
+// =========================
+// Get Legacy Data Type Size
+// =========================
+
+int GetLegacyDataTypeSize(const std::string &LegacyTypeName)
+{
+    for(unsigned int TypeIterator = 0;
+        TypeIterator < NumberOfDataTypes;
+        TypeIterator++)
     {
-        // Write to ASCII file
-        WriteArraysToASCIIFile(
-                OutputFile,   // Output
-                InputDataArrays,
-                NumberOfArrays,
-                NumberOfComponentsInEachArray);
+        if(strcasecmp(LegacyTypeName.c_str(),
+                    DataTypeTable[TypeIterator].LegacyName) == 0)
+        {
+            return DataTypeTable[TypeIterator].Size;
+        }
     }
-    else
+
+    return 0;
+}
+
+// ======================
+// Get XML Data Type Size
+// ======================
+
+int GetXMLDataTypeSize(const std::string &XMLTypeName)
+{
+    for(unsigned int TypeIterator = 0;
+        TypeIterator < NumberOfDataTypes;
+        TypeIterator++)
     {
-        // Write to Binary file
-        WriteArraysToBinaryFile(
-                OutputFile,   // Output
-                InputDataArrays,
-                NumberOfArrays,
-                NumberOfComponentsInEachArray);
+        if(XMLTypeName == DataTypeTable[TypeIterator].XMLName)
+        {
+            return DataTypeTable[TypeIterator].Size;
+        }
     }
 
-    std::cout << NumberOfArrays;
-    std::cout << " arrays in column-wise order as above were written to: ";
-    std::cout << OutputFilename << "." << std::endl;
-    std::cout << "Rows: " << NumberOfTuplesInEachArray[0] << ", Columns: ";
-    std::cout << ColumnCounter << "." << std::endl;
-
-    // Close file
-    OutputFile.close();
+    return 0;
 }
 
-// =========
-// Open File
-// =========
+// ==================
+// Get Data Type Name
+// ==================
 
-void OpenFile(
-        char *OutputFilename,
-        bool BinaryOutputFile,
-        std::ofstream &OutputFile)
+const char *GetDataTypeName(int DataType)
 {
-    // Open ascii or binary
-    if(BinaryOutputFile == false)
+    for(unsigned int TypeIterator = 0;
+        TypeIterator < NumberOfDataTypes;
+        TypeIterator++)
     {
-        // Open ASCII file
-        OutputFile.open(OutputFilename);
+        if(DataType == DataTypeTable[TypeIterator].DataType)
+        {
+            return DataTypeTable[TypeIterator].XMLName;
+        }
     }
-    else
+
+    return "Unknown";
+}
+
+// ========================
+// Get Input File Type Name
+// ========================
+
+const char *GetInputFileTypeName(InputFileType FileType)
+{
+    for(unsigned int HandlerIterator = 0;
+        HandlerIterator < NumberOfReaderHandlers;
+        HandlerIterator++)
     {
-        // Open Binary file
-        OutputFile.open(OutputFilename,std::ios::binary);
+        if(ReaderRegistry[HandlerIterator].FileType == FileType)
+        {
+            return ReaderRegistry[HandlerIterator].Name;
+        }
     }
 
-    // Check file is open
-    if(OutputFile.is_open() != true)
+    return "Unknown";
+}
+
+// =============
+// To Upper Case
+// =============
+
+std::string ToUpperCase(const std::string &String)
+{
+    std::string UpperCaseString(String);
+    for(unsigned int CharacterIterator = 0;
+        CharacterIterator < UpperCaseString.size();
+        CharacterIterator++)
     {
-        std::cerr << "Can not open output file: ";
-        std::cerr << OutputFilename << std::endl;
-        exit(1);
+        UpperCaseString[CharacterIterator] = static_cast<char>(
+                toupper(UpperCaseString[CharacterIterator]));
     }
 
-    OutputFile << std::setprecision(DECIMAL_PRECISION);
+    return UpperCaseString;
 }
 
-// ==========================
-// Write Arrays To ASCII File
-// ==========================
+// ==================
+// Decode Legacy Name
+// ==================
 
 // Description:
-// In ASCII mode, columns are separated by a delimiter, such as a tab.
-// The rows are separated by new line.
+// The legacy writer encodes white spaces and special characters in names
+// as %XX, where XX is the hexadecimal code of the character.
 
-void WriteArraysToASCIIFile(
-        std::ofstream &OutputFile,   // Output
-        vtkDataArray **InputDataArrays,
-        unsigned int NumberOfArrays,
-        unsigned int *NumberOfComponentsInEachArray)
+std::string DecodeLegacyName(const std::string &Name)
 {
-    std::cout << "Write to binary file." << std::endl;
-
-    std::string Delimiter("\t");
-
-    // Number of Tuples
-    unsigned long long int NumberOfTuples = \
-            InputDataArrays[0]->GetNumberOfTuples();
-
-    // Iterate over tuples
-    for(unsigned long long int TupleIterator = 0;
-        TupleIterator < NumberOfTuples;
-        TupleIterator++)
+    std::string DecodedName;
+    for(unsigned int CharacterIterator = 0;
+        CharacterIterator < Name.size();
+        CharacterIterator++)
     {
-        // Iterate over arrays
-        for(unsigned int ArrayIterator = 0;
-            ArrayIterator < NumberOfArrays;
-            ArrayIterator++)
+        if(Name[CharacterIterator] == '%' &&
+           CharacterIterator + 2 < Name.size())
         {
-            // Iterate over components of each array
-            for(unsigned int ComponentIterator = 0;
-                ComponentIterator < \
-                    NumberOfComponentsInEachArray[ArrayIterator];
-                ComponentIterator++)
-            {
-                // Write to ASCII file
-                OutputFile << InputDataArrays[ArrayIterator]->GetComponent(
-                        TupleIterator,ComponentIterator);
-
-                // Insert delimiter berween components
-                if(ComponentIterator < \
-                        NumberOfComponentsInEachArray[ArrayIterator]-1)
-                {
-                    OutputFile << Delimiter;
-                }
-            }
-
-            // Insert delimiter between arrays
-            if(ArrayIterator < NumberOfArrays-1)
-            {
-                OutputFile << Delimiter;
-            }
+            std::string Code = Name.substr(CharacterIterator+1,2);
+            DecodedName.push_back(static_cast<char>(
+                        strtol(Code.c_str(),NULL,16)));
+            CharacterIterator += 2;
         }
-
-        // Insert new line
-        if(TupleIterator < NumberOfTuples -1)
+        else
         {
-            OutputFile << std::endl;
+            DecodedName.push_back(Name[CharacterIterator]);
         }
     }
-}
 
-// ===========================
-// Write Arrays To Binary File
-// ===========================
+    return DecodedName;
+}
 
-// Description:
-// 
-// In Binary mode, there is no delimiter or new line netween rows and columns.
-// Indeed there is no columsn and rows. All data are stored consequently on the
-// memory. The application code that reads the output file should be aware of
-// how to read the chunk of bytes.
-//
-// Data are stored as double. The number of components (columns) for each array
-// is printed afterward to the screen. 
-//
-// To view the binary file in terminal in ASCII mode, use
-//
-//    $ hexdump -v -e '7/8 "%f "' -e '"\n"' OutputFile.raw
-//
-// In above, 8 is for double precision. FOr float, replace 8 with 4.
-// In above, the file is printed in 7 columns. Change 7 to the number of
-// columns.
+// ==================
+// Escape JSON String
+// ==================
 
-void WriteArraysToBinaryFile(
-        std::ofstream &OutputFile,   // Output
-        vtkDataArray **InputDataArrays,
-        unsigned int NumberOfArrays,
-        unsigned int *NumberOfComponentsInEachArray)
+std::string EscapeJSONString(const std::string &String)
 {
-    std::cout << "Write to binary file." << std::endl;
-
-    // Number of Tuples
-    unsigned long long int NumberOfTuples = \
-            InputDataArrays[0]->GetNumberOfTuples();
-
-    // Iterate over tuples
-    for(unsigned long long int TupleIterator = 0;
-        TupleIterator < NumberOfTuples;
-        TupleIterator++)
+    std::string EscapedString;
+    for(unsigned int CharacterIterator = 0;
+        CharacterIterator < String.size();
+        CharacterIterator++)
     {
-        // Iterate over arrays
-        for(unsigned int ArrayIterator = 0;
-            ArrayIterator < NumberOfArrays;
-            ArrayIterator++)
+        char Character = String[CharacterIterator];
+        if(Character == '"' || Character == '\\')
         {
-            // Iterate over components of each array
-            for(unsigned int ComponentIterator = 0;
-                ComponentIterator < \
-                    NumberOfComponentsInEachArray[ArrayIterator];
-                ComponentIterator++)
-            {
-                // Write to ASCII file
-                double Value = InputDataArrays[ArrayIterator]->GetComponent(
-                        TupleIterator,ComponentIterator);
-                OutputFile.write(
-                        reinterpret_cast<char*>(&Value),sizeof(Value));
-            }
+            EscapedString.push_back('\\');
+            EscapedString.push_back(Character);
+        }
+        else if(static_cast<unsigned char>(Character) < 0x20)
+        {
+            char Code[8];
+            snprintf(Code,sizeof(Code),"\\u%04x",Character);
+            EscapedString += Code;
+        }
+        else
+        {
+            EscapedString.push_back(Character);
         }
     }
+
+    return EscapedString;
 }
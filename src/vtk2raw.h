@@ -25,11 +25,29 @@
 
 // Incomplete Declarations
 class vtkPointData;
+class vtkDataSetAttributes;
+class vtkDataSet;
 class vtkDataArray;
+class vtkAlgorithm;
+class vtkXMLReader;
+class vtkDataArraySelection;
 // class fstream;
 
 // Complete declarations
 #include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstdio>         // FILE
+#include <sys/types.h>    // pid_t
+#include <vtkType.h>      // vtkIdType
+#include <vtk_hdf5.h>     // hid_t
+#include <vtk_zlib.h>     // z_stream
 
 // =====
 // Types
@@ -41,62 +59,1390 @@ enum InputFileType
     VTI,
     VTP,
     VTU,
+    PVTI,                                // Partitioned, with piece files
+    PVTP,
+    PVTU,
+    VTM,                                 // Multiblock, with block files
+    PVD,                                 // Time series, with a dataset
+                                         // file per time step
+    VTKHDF,                              // HDF5 file with a VTKHDF group
     NUMBER_OF_INPUT_FILE_TYPES
 };
 
+// Capabilities of a reader handler
+enum ReaderCapability
+{
+    READER_HEADER_PROBE     = 1 << 0,    // Header can be scanned without data
+    READER_ARRAY_SELECTION  = 1 << 1,    // Reads only the selected arrays
+    READER_PIECE_STREAMING  = 1 << 2,    // Reads one piece at a time
+    READER_EXTENT_STREAMING = 1 << 3     // Reads only a sub-extent
+};
+
+// Implicit coordinate columns of image data
+enum CoordinatesType
+{
+    COORDINATES_NONE = 0,
+    COORDINATES_XYZ,                     // origin + index * spacing
+    COORDINATES_IJK                      // structured index
+};
+
+// Command line options
+struct ConversionOptions
+{
+    bool BinaryOutputFile;
+    bool SequentialOutputFile;               // Pipe or standard output, which
+                                             // can only be written in order
+    bool SharedMemoryOutput;                 // Output is a POSIX shared
+                                             // memory segment
+    bool Probe;
+    bool Batch;                              // Convert many input files
+    std::string Manifest;                    // Batch: file with one input
+                                             // file per line
+    bool ConcatenateFiles;                   // Batch: rows of all input
+                                             // files in one output file
+    bool WritePointData;
+    bool WriteCellData;
+    bool WritePoints;                        // Append x, y, z columns
+    bool WriteTopology;                      // Write cells to separate files
+    CoordinatesType Coordinates;             // Implicit image coordinates
+    std::vector<std::string> ArrayNames;     // Empty for all arrays
+    bool ExtractExtent;                      // Convert only a sub-volume
+    int Extent[6];                           // i0 i1 j0 j1 k0 k1
+    int Stride[3];                           // Every n-th point of images
+    int SliceAxis;                           // 0, 1, 2 for i, j, k, or -1
+    int SliceIndex;
+    unsigned long long MemoryLimit;          // Bytes, 0 to read all at once
+    unsigned int NumberOfThreads;            // 0 for the number of cores
+    bool ConcatenateBlocks;                  // One output for all blocks
+    unsigned int NumberOfPrefetchedSteps;    // Time steps read ahead of the
+                                             // time step that is written
+    bool StackTimeSteps;                     // One time-major output file
+    bool RegionOutput;                       // Output is the bytes Offset
+    unsigned long long RegionOffset;         // to Offset + Size of a file
+    unsigned long long RegionSize;           // that exists
+    unsigned long long CellRegionOffset;     // Region of the cell data of
+    unsigned long long CellRegionSize;       // --point-and-cell-data
+    unsigned int NumberOfShards;             // Rows split into shard files,
+    unsigned long long ShardSize;            // or into shards of this size
+    std::string ServerSocket;                // Serve jobs on this Unix
+                                             // domain socket
+
+    ConversionOptions():
+        BinaryOutputFile(false),
+        SequentialOutputFile(false),
+        SharedMemoryOutput(false),
+        Probe(false),
+        Batch(false),
+        ConcatenateFiles(false),
+        WritePointData(true),
+        WriteCellData(false),
+        WritePoints(false),
+        WriteTopology(false),
+        Coordinates(COORDINATES_NONE),
+        ExtractExtent(false),
+        SliceAxis(-1),
+        SliceIndex(0),
+        MemoryLimit(0),
+        NumberOfThreads(0),
+        ConcatenateBlocks(false),
+        NumberOfPrefetchedSteps(1),
+        StackTimeSteps(false),
+        RegionOutput(false),
+        RegionOffset(0),
+        RegionSize(0),
+        CellRegionOffset(0),
+        CellRegionSize(0),
+        NumberOfShards(0),
+        ShardSize(0)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Extent[i] = 0;
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Stride[i] = 1;
+        }
+    }
+};
+
+// Header of one data array, as found in the input file without reading data
+struct ArrayHeader
+{
+    std::string Name;
+    int DataType;                        // VTK type id, such as VTK_FLOAT
+    unsigned int NumberOfComponents;
+    unsigned long long NumberOfTuples;
+    unsigned int ValueSize;              // Bytes of one value in the file
+    bool BinaryData;                     // Legacy: BINARY, XML: not ascii
+    std::string Format;                  // XML: ascii, binary or appended,
+                                         // VTKHDF: hdf5
+    long long Offset;                    // Legacy: file position of data,
+                                         // XML: offset in appended data
+    bool ColorScalars;                   // Legacy: COLOR_SCALARS, whose
+                                         // ASCII values are in [0,1]
+
+    ArrayHeader():
+        DataType(0),
+        NumberOfComponents(1),
+        NumberOfTuples(0),
+        ValueSize(0),
+        BinaryData(false),
+        Offset(-1),
+        ColorScalars(false) {}
+};
+
+// One piece of the dataset. Legacy files have exactly one piece.
+struct PieceHeader
+{
+    unsigned long long NumberOfPoints;
+    unsigned long long NumberOfCells;
+    int Extent[6];
+    ArrayHeader Points;                  // Legacy: explicit POINTS section,
+                                         // VTKHDF: Points dataset
+    std::vector<ArrayHeader> PointArrays;
+    std::vector<ArrayHeader> CellArrays;
+    std::string Source;                  // File of the piece, if not the
+                                         // input file itself
+    unsigned int SourcePiece;            // Index of the piece in Source,
+    unsigned int NumberOfSourcePieces;   // out of the pieces of Source
+
+    PieceHeader():
+        NumberOfPoints(0),
+        NumberOfCells(0),
+        SourcePiece(0),
+        NumberOfSourcePieces(1)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            Extent[i] = 0;
+        }
+    }
+};
+
+// One dataset file of a multiblock file
+struct BlockHeader
+{
+    std::string Name;                    // Names or indices of the blocks
+                                         // above it, separated by "/"
+    std::string Filename;
+};
+
+// One dataset file of a time series file
+struct TimeStepHeader
+{
+    double TimeValue;                    // timestep attribute
+    std::string Part;                    // part attribute, if any
+    std::string Filename;
+
+    TimeStepHeader():
+        TimeValue(0.0) {}
+};
+
+// Everything that can be learned from the headers of an input file
+struct FileHeader
+{
+    InputFileType FileType;
+    std::string DataSetType;             // Such as STRUCTURED_POINTS or ImageData
+    bool BinaryData;                     // Legacy: BINARY keyword
+    bool BigEndian;                      // XML: byte_order attribute,
+                                         // legacy: always big endian
+    unsigned int HeaderTypeSize;         // XML: header_type of binary blocks
+    std::string Compressor;              // XML: compressor attribute
+    std::string AppendedDataEncoding;    // XML: raw or base64
+    long long AppendedDataOffset;        // XML: file position after "_"
+    int WholeExtent[6];
+    double Origin[3];
+    double Spacing[3];
+    std::vector<PieceHeader> Pieces;
+    std::vector<BlockHeader> Blocks;     // VTM: dataset files of the leaves
+    std::vector<TimeStepHeader> TimeSteps;   // PVD: dataset files in the
+                                         // order of their time values
+    std::vector<FileHeader> SourceHeaders;   // Partitioned files: headers
+                                         // of the piece files
+
+    FileHeader():
+        FileType(NUMBER_OF_INPUT_FILE_TYPES),
+        BinaryData(false),
+        BigEndian(false),
+        HeaderTypeSize(4),
+        AppendedDataOffset(-1)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            WholeExtent[i] = 0;
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Origin[i] = 0.0;
+            Spacing[i] = 1.0;
+        }
+    }
+};
+
+// Extent, origin and spacing of image data
+struct ImageGeometry
+{
+    int Extent[6];                       // Extent of the tuples of arrays
+    int Stride[3];                       // Tuples are at every Stride-th
+                                         // index of the extent
+    double Origin[3];
+    double Spacing[3];
+
+    ImageGeometry()
+    {
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            Extent[2*i] = 0;
+            Extent[2*i+1] = 0;
+            Stride[i] = 1;
+            Origin[i] = 0.0;
+            Spacing[i] = 1.0;
+        }
+    }
+};
+
+// Columns and rows of an output matrix
+struct OutputMatrix
+{
+    std::vector<vtkDataArray*> Arrays;
+    std::vector<unsigned int> NumberOfComponents;
+    CoordinatesType Coordinates;         // Appended after the arrays
+    bool Structured;                     // Rows follow the geometry extent
+    ImageGeometry Geometry;
+    int RowExtent[6];                    // Sub-extent of geometry written
+    int RowStride[3];                    // Every n-th index of RowExtent
+    unsigned int NumberOfColumns;
+    unsigned long long NumberOfRows;
+
+    OutputMatrix():
+        Coordinates(COORDINATES_NONE),
+        Structured(false),
+        NumberOfColumns(0),
+        NumberOfRows(0)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            RowExtent[i] = 0;
+        }
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            RowStride[i] = 1;
+        }
+    }
+};
+
+// Shard files of an output, each with the rows NumberOfShardRows * i to
+// NumberOfShardRows * (i+1), the last shard may have fewer rows
+struct ShardLayout
+{
+    unsigned long long NumberOfRows;
+    unsigned int NumberOfColumns;
+    unsigned long long NumberOfShardRows;
+    std::vector<std::string> Filenames;
+
+    ShardLayout():
+        NumberOfRows(0),
+        NumberOfColumns(0),
+        NumberOfShardRows(0)
+    {
+    }
+};
+
+// Rows of the point and cell data that are converted slab by slab
+struct SlabLayout
+{
+    bool Structured;                     // Rows follow an image extent
+    int RowExtents[2][6];                // Structured: point and cell rows
+    unsigned long long NumberOfRows[2];  // Point and cell rows to write
+    unsigned long long RowBytes[2];      // Memory of one row while read
+    int NumberOfPieces;                  // If not 0, one slab per piece
+
+    SlabLayout():
+        Structured(false),
+        NumberOfPieces(0)
+    {
+        for(unsigned int i = 0; i < 6; i++)
+        {
+            RowExtents[0][i] = 0;
+            RowExtents[1][i] = 0;
+        }
+        NumberOfRows[0] = 0;
+        NumberOfRows[1] = 0;
+        RowBytes[0] = 0;
+        RowBytes[1] = 0;
+    }
+};
+
+// Reads one slab of the point (Attribute 0) or cell (Attribute 1) data. The
+// slab is SlabExtent of structured data or of pieces, or the rows SlabRows
+// (first row and number of rows) of unstructured data. The returned arrays
+// and geometry are valid until the next slab is read.
+typedef void (*ReadSlabFunction)(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry);                     // Output
+
+// Scans the header of an input file without reading its data
+typedef bool (*ScanHeaderFunction)(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+// Decides from the scanned header whether a reader can read the file
+typedef bool (*CanReadFunction)(
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+// Reads an input file and writes its arrays to the output file
+typedef void (*ReadInputFileFunction)(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+// Reader of one input file type
+struct ReaderHandler
+{
+    InputFileType FileType;
+    const char *Name;
+    const char *Extension;
+    const char *DataSetTypes;            // Legacy DATASET or XML type names
+    unsigned int Capabilities;           // ReaderCapability flags
+    ScanHeaderFunction ScanHeader;       // NULL if headers can not be probed
+    CanReadFunction CanRead;             // NULL if it reads all files of type
+    ReadInputFileFunction Read;
+};
+
+// State of the decompression at an uncompressed position of a gzip file,
+// from which the decompression restarts after a seek backward
+struct DecompressionCheckpoint
+{
+    long long Position;                  // Uncompressed position
+    long long FileOffset;                // Compressed position of the input
+    z_stream Stream;                     // Copy of the inflate state, which
+                                         // is not moved once copied
+};
+
+// Stream buffer of a gzip compressed file, which is decompressed by a
+// background thread into a bounded queue of blocks
+class DecompressionStreamBuffer : public std::streambuf
+{
+    public:
+        DecompressionStreamBuffer();
+        ~DecompressionStreamBuffer();
+        bool Open(const char *InputFilename);
+        bool Open(FILE *InputFile, const char *InputFilename);
+        bool IsOpen() const;
+        void Close();
+
+    protected:
+        int_type underflow();
+        pos_type seekoff(
+                off_type Offset,
+                std::ios_base::seekdir Direction,
+                std::ios_base::openmode Mode);
+        pos_type seekpos(
+                pos_type Position,
+                std::ios_base::openmode Mode);
+
+    private:
+        void StartDecompression(const DecompressionCheckpoint *Checkpoint);
+        void StopDecompression();
+        void Decompress();
+        void AddCheckpoint(long long Position);
+        void ClearCheckpoints();
+        bool PushBlock(std::vector<char> &Block);
+        bool ReadNextBlock();
+
+        std::string Filename;
+        FILE *File;
+        z_stream Stream;
+        std::deque<DecompressionCheckpoint> Checkpoints;  // In order of
+                                         // their positions
+
+        // Shared with the decompression thread
+        std::thread DecompressionThread;
+        std::mutex QueueMutex;
+        std::condition_variable QueueCondition;
+        std::deque<std::vector<char> > Queue;
+        bool Stop;
+        bool Finished;
+        bool Failed;
+
+        // Buffer of the reader: the end of the previous block, so that
+        // short backward seeks do not restart the decompression, followed
+        // by the current block
+        std::vector<char> Buffer;
+        long long BufferStart;           // Uncompressed position of Buffer
+        long long DecompressionStart;    // Where the thread started
+};
+
+// Stream buffer of data in memory, such as the standard input
+class MemoryStreamBuffer : public std::streambuf
+{
+    public:
+        MemoryStreamBuffer();
+        void Open(const std::string &Content);
+        bool IsOpen() const;
+        void Close();
+
+    protected:
+        pos_type seekoff(
+                off_type Offset,
+                std::ios_base::seekdir Direction,
+                std::ios_base::openmode Mode);
+        pos_type seekpos(
+                pos_type Position,
+                std::ios_base::openmode Mode);
+
+    private:
+        bool Opened;
+};
+
+// Input file stream of an uncompressed or a gzip compressed file, or of
+// the standard input
+class InputFileStream : public std::istream
+{
+    public:
+        explicit InputFileStream(const char *InputFilename);
+        bool is_open() const;
+        void close();
+
+    private:
+        std::filebuf FileBuffer;
+        DecompressionStreamBuffer Decompression;
+        MemoryStreamBuffer Memory;
+};
+
+// Start of a shared memory output. It is followed by a JSON description of
+// the columns, and by the matrix of doubles at DataOffset, which is a
+// multiple of the page size. Ready is set to 1 with a release store after
+// all rows are written, and is read by a consumer with an acquire load.
+struct SharedMemoryHeader
+{
+    char Magic[8];                       // "VTK2RAW"
+    unsigned int Version;
+    unsigned int Ready;                  // 0 while written, 1 when complete
+    unsigned long long NumberOfRows;
+    unsigned long long NumberOfColumns;
+    unsigned long long DataOffset;       // Bytes before the matrix
+    char DataType[8];                    // "float64", in host byte order
+};
+
+// Stream buffer of the matrix of a shared memory output, which is mapped
+// and written in place. Positions are bytes from the start of the matrix.
+class SharedMemoryStreamBuffer : public std::streambuf
+{
+    public:
+        SharedMemoryStreamBuffer();
+        ~SharedMemoryStreamBuffer();
+        bool Open(const char *Name);
+        bool IsOpen() const;
+        void Close();
+        char *Reserve(unsigned long long Size);
+
+    protected:
+        pos_type seekoff(
+                off_type Offset,
+                std::ios_base::seekdir Direction,
+                std::ios_base::openmode Mode);
+        pos_type seekpos(
+                pos_type Position,
+                std::ios_base::openmode Mode);
+
+    private:
+        void SetPutPosition(unsigned long long Position);
+
+        char *Segment;
+        unsigned long long SegmentSize;
+        char *Data;                      // Matrix in the segment
+        unsigned long long DataSize;
+};
+
+// Stream buffer of a region of an existing file, such as the frame of one
+// time step in a stacked output. Positions are bytes from the start of the
+// region, and writes past its end fail, so that the writers of other
+// regions of the same file are never overwritten. A region that is written
+// in order must be full when it is closed.
+class FileRegionStreamBuffer : public std::streambuf
+{
+    public:
+        FileRegionStreamBuffer();
+        ~FileRegionStreamBuffer();
+        bool Open(
+                const char *Filename,
+                unsigned long long Offset,
+                unsigned long long Size);
+        bool Open(
+                const std::vector<std::string> &Filenames,
+                unsigned long long ShardSize,
+                unsigned long long Size);
+        bool IsOpen() const;
+        bool IsFull() const;
+        bool Close();
+
+    protected:
+        int_type overflow(int_type Character);
+        std::streamsize xsputn(const char *Characters, std::streamsize Count);
+        int sync();
+        pos_type seekoff(
+                off_type Offset,
+                std::ios_base::seekdir Direction,
+                std::ios_base::openmode Mode);
+        pos_type seekpos(
+                pos_type Position,
+                std::ios_base::openmode Mode);
+
+    private:
+        bool Flush();
+        bool WriteAt(const char *Bytes, unsigned long long Count);
+        void ResetPutArea();
+
+        std::vector<int> FileDescriptors;    // One file, or the shards
+        unsigned long long RegionOffset;     // Of the region in the file
+        unsigned long long RegionSize;
+        unsigned long long ShardSize;        // Bytes of the region in each
+                                             // file, the last may be shorter
+        unsigned long long Position;         // Of the put area in the region
+        bool Seeked;                         // Written out of order, such as
+                                             // by the threads of the pieces
+        std::vector<char> Buffer;
+};
+
+// Stream buffer of the standard output, which writes to its file
+// descriptor, so that any standard output can be written, such as a pipe,
+// a socket or a file, without opening it again by a name.
+class StandardOutputStreamBuffer : public std::streambuf
+{
+    public:
+        StandardOutputStreamBuffer();
+        ~StandardOutputStreamBuffer();
+        void Open();
+        bool IsOpen() const;
+        bool Close();
+
+    protected:
+        int_type overflow(int_type Character);
+        std::streamsize xsputn(const char *Characters, std::streamsize Count);
+        int sync();
+
+    private:
+        bool Flush();
+        bool Write(const char *Bytes, unsigned long long Count);
+
+        bool Opened;
+        std::vector<char> Buffer;
+};
+
+// Holds the HDF5 library of VTK, which is not thread safe, for the HDF5
+// calls of one thread, with the printing of HDF5 errors turned off. The
+// error handler of the library is restored when the lock is released.
+class HDFLibraryLock
+{
+    public:
+        HDFLibraryLock();
+        ~HDFLibraryLock();
+        void Release();
+
+    private:
+        std::unique_lock<std::mutex> Lock;
+        H5E_auto2_t ErrorFunction;
+        void *ErrorData;
+};
+
+// Output file stream of a file, the standard output, the matrix of a
+// shared memory segment, a region of a file, or shard files
+class OutputFileStream : public std::ostream
+{
+    public:
+        OutputFileStream();
+        void open(
+                const char *OutputFilename,
+                std::ios::openmode Mode = std::ios::out);
+        void OpenStandardOutput();
+        void OpenSharedMemory(const char *Name);
+        void OpenRegion(
+                const char *OutputFilename,
+                unsigned long long Offset,
+                unsigned long long Size);
+        void OpenShards(
+                const std::vector<std::string> &Filenames,
+                unsigned long long ShardSize,
+                unsigned long long Size);
+        bool is_open() const;
+        void close();
+
+    private:
+        std::filebuf FileBuffer;
+        StandardOutputStreamBuffer StandardOutput;
+        SharedMemoryStreamBuffer SharedMemory;
+        FileRegionStreamBuffer Region;
+};
+
+// Error of a conversion, which is thrown after its message is printed to
+// the standard error. The command returns a failure status, and the threads
+// of a pool catch it, such that the pool stops and the thread that started
+// it throws it again once all threads are joined.
+class ConversionError : public std::exception
+{
+};
+
 // ==========
 // Prototypes
 // ==========
 
+int RunCommand(
+        int argc,
+        char *argv[]);
+
 void PrintUsage(char *ExecutableName);
 
+std::ostream &GetMessageStream();
+
+void SetMessageStream(std::ostream *MessageStream);
+
+void ParseArguments(
+        int argc,
+        char *argv[],
+        ConversionOptions &Options,           // Output
+        std::vector<char*> &Arguments);       // Output
+
+bool ParseSize(
+        const char *Size,
+        unsigned long long &Bytes);           // Output
+
+void GetBatchInputFilenames(
+        const std::vector<char*> &Patterns,
+        const std::string &Manifest,
+        std::vector<std::string> &InputFilenames);   // Output
+
+std::string MakeBatchOutputFilename(
+        const std::string &OutputTemplate,
+        const std::string &InputFilename,
+        unsigned int Index);
+
+void ConvertBatch(
+        const std::vector<std::string> &InputFilenames,
+        const char *OutputTemplate,
+        const ConversionOptions &Options);
+
+struct BatchConversion;
+
+void ConvertBatchOnThread(BatchConversion *Conversion);
+
+void GetConcatenationLayout(
+        const std::vector<std::string> &InputFilenames,
+        const ConversionOptions &Options,
+        std::vector<unsigned long long> &FirstRows,       // Output
+        std::vector<unsigned long long> &NumberOfRows,    // Output
+        unsigned int &NumberOfColumns);                   // Output
+
+void WriteConcatenationTable(
+        const std::vector<std::string> &InputFilenames,
+        const std::vector<unsigned long long> &FirstRows,
+        const std::vector<unsigned long long> &NumberOfRows,
+        const char *OutputFilename);
+
+void ServeConversions(
+        const ConversionOptions &Options,
+        char *ExecutableName);
+
+void NotifyServer(int Signal);
+
+struct ServerJob;
+
+void FinishServerJobs(std::map<pid_t,ServerJob> &Jobs);
+
+void RunServerJob(
+        int Connection,
+        char *ExecutableName,
+        unsigned int NumberOfThreads);
+
+bool ReadJobArguments(
+        int Connection,
+        std::vector<std::string> &Arguments);     // Output
+
 void ReadDataSetWriteToOutput(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile);
+        const char *InputFilename,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+const ReaderHandler *SelectReaderHandler(
+        const char *InputFilename,
+        const ConversionOptions &Options,
+        FileHeader &Header);                  // Input/Output
 
-InputFileType DetermineInputFileType(char *InputFilename);
+InputFileType DetectInputFileType(
+        const char *InputFilename,
+        std::string &DataSetType);            // Output
 
-void ReadVTKInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile);
+InputFileType SniffInputFileType(
+        const std::string &Leading,
+        std::string &DataSetType);            // Output
 
-void ReadVTIInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile);
+bool IsCompressedInputFile(const char *InputFilename);
 
-void ReadVTPInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile);
+bool ReadsFromInputString(const char *InputFilename);
 
-void ReadVTUInputFileWriteToOutputFile(
-        char *InputFilename,
-        char *OutputFilename,
-        bool BinaryOutputFile);
+bool ReadInputFileContent(
+        const char *InputFilename,
+        std::string &Content);                // Output
+
+const std::string &GetStandardInput();
+
+bool HandlerSupportsDataSetType(
+        const ReaderHandler &Handler,
+        const std::string &DataSetType);
+
+bool CanReadLegacyInputFile(
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadLegacyInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadAttributeArrays(
+        std::istream &InputFile,
+        const char *InputFilename,
+        const FileHeader &Header,
+        const std::vector<ArrayHeader> &Arrays,
+        const int *DataExtent,
+        const int *ReadExtent,
+        const unsigned long long *ReadRows,
+        const int Stride[3],
+        const ConversionOptions &Options,
+        vtkDataSetAttributes *InputData);     // Output
+
+void ReadPieceArrays(
+        std::istream &InputFile,
+        const char *InputFilename,
+        const FileHeader &Header,
+        const PieceHeader &Piece,
+        const ConversionOptions &Options,
+        ImageGeometry *Geometry,              // Input/Output
+        vtkDataSetAttributes *InputPointData, // Output
+        vtkDataSetAttributes *InputCellData); // Output
+
+bool ReadLegacyArray(
+        std::istream &InputFile,
+        const ArrayHeader &Array,
+        vtkDataArray *InputDataArray);        // Output
+
+bool ReadArrayExtent(
+        std::istream &InputFile,
+        const ArrayHeader &Array,
+        long long DataOffset,
+        bool BigEndian,
+        const int DataExtent[6],
+        const int ReadExtent[6],
+        const int Stride[3],
+        vtkDataArray *InputDataArray);        // Output
+
+bool ReadArrayRows(
+        std::istream &InputFile,
+        const ArrayHeader &Array,
+        long long DataOffset,
+        bool BigEndian,
+        unsigned long long FirstRow,
+        unsigned long long NumberOfRows,
+        vtkDataArray *InputDataArray);        // Output
+
+template <class ValueType>
+bool ReadValues(
+        std::istream &InputFile,
+        bool BinaryData,
+        bool BigEndian,
+        unsigned int ValueSize,
+        bool ColorScalars,
+        unsigned long long NumberOfValues,
+        ValueType *Values);                   // Output
+
+void SwapValueBytes(
+        void *Values,                         // Input/Output
+        unsigned long long NumberOfValues,
+        unsigned int ValueSize,
+        bool BigEndian);
+
+void GetHeaderImageGeometry(
+        const FileHeader &Header,
+        ImageGeometry &Geometry);             // Output
+
+void GetExtractExtent(
+        const int DataExtent[6],
+        const ConversionOptions &Options,
+        int ReadExtent[6]);                   // Output
+
+void AlignExtentToStride(
+        int Extent[6],                        // Input/Output
+        const int Stride[3]);
+
+unsigned long long GetNumberOfExtentTuples(
+        const int Extent[6],
+        const int Stride[3]);
+
+bool IntersectExtents(
+        const int FirstExtent[6],
+        const int SecondExtent[6],
+        int Intersection[6]);                 // Output
+
+void GetCellExtent(
+        const int PointExtent[6],
+        const int WholePointExtent[6],
+        int CellExtent[6]);                   // Output
+
+void ReadVTKLegacyInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+bool CanReadAppendedData(
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+bool CanReadAppendedImageData(
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadAppendedImageDataWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+template <class XMLReaderType>
+void ReadXMLInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void SetXMLReaderInput(
+        vtkXMLReader *XMLReader,
+        const char *InputFilename,
+        std::string &InputString);            // Output
+
+void SelectReaderArrays(
+        vtkDataArraySelection *PointDataArraySelection,
+        vtkDataArraySelection *CellDataArraySelection,
+        const ConversionOptions &Options);
+
+vtkXMLReader *NewXMLPieceReader(InputFileType FileType);
+
+bool CanReadHDFDatasets(
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadHDFDatasetsWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadHDFSlab(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry);                     // Output
+
+void ReadHDFAttributeArrays(
+        hid_t File,
+        const char *InputFilename,
+        const char *GroupName,
+        const std::vector<ArrayHeader> &Arrays,
+        const int *DataExtent,
+        const int *ReadExtent,
+        const unsigned long long *ReadRows,
+        const int Stride[3],
+        const ConversionOptions &Options,
+        vtkDataSetAttributes *InputData);     // Output
+
+void ReadHDFDataset(
+        hid_t File,
+        const char *InputFilename,
+        const char *DatasetName,
+        const ArrayHeader &Array,
+        const int *DataExtent,
+        const int *ReadExtent,
+        const unsigned long long *ReadRows,
+        const int Stride[3],
+        vtkDataArray *InputDataArray);        // Output
+
+hid_t GetHDFMemoryType(int DataType);
+
+void ReadVTKHDFInputFileWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+bool CanReadParallelPieces(
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadParallelPiecesWriteToOutputFile(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+void ReadMultiBlockWriteToOutputFiles(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+struct BlockConversion;
+
+void ConvertBlocksOnThread(BlockConversion *Conversion);
+
+bool HaveSameArrays(
+        const std::vector<ArrayHeader> &Arrays,
+        const std::vector<ArrayHeader> &OtherArrays);
+
+bool GetOutputShape(
+        const char *InputFilename,
+        unsigned int Attribute,
+        const ConversionOptions &Options,
+        std::vector<ArrayHeader> &SelectedArrays,   // Output
+        unsigned long long &NumberOfRows,           // Output
+        unsigned int &NumberOfColumns);             // Output
+
+void GetBlockLayout(
+        const FileHeader &Header,
+        const ConversionOptions &Options,
+        std::vector<unsigned long long> FirstRows[2],     // Output
+        std::vector<unsigned long long> NumberOfRows[2],  // Output
+        unsigned int NumberOfColumns[2]);                 // Output
+
+void SelectCellRegion(ConversionOptions &Options);     // Input/Output
+
+void ConcatenateBlockFiles(
+        const FileHeader &Header,
+        const std::vector<std::string> &BlockOutputFilenames,
+        const unsigned int NumberOfColumns[2],
+        const char *OutputFilename,
+        const ConversionOptions &Options,
+        std::vector<unsigned long long> FirstRows[2],     // Input/Output
+        std::vector<unsigned long long> NumberOfRows[2]); // Input/Output
+
+void ReadTimeSeriesWriteToOutputFiles(
+        const char *InputFilename,
+        const char *OutputFilename,
+        const FileHeader &Header,
+        const ConversionOptions &Options);
+
+struct TimeSeriesConversion;
+
+void ConvertTimeStepsOnThread(TimeSeriesConversion *Conversion);
+
+void GetTimeStepFrameShape(
+        const FileHeader &Header,
+        const ConversionOptions &Options,
+        unsigned long long &NumberOfRows,     // Output
+        unsigned int &NumberOfColumns);       // Output
+
+void WriteTimeStepTable(
+        const FileHeader &Header,
+        const std::vector<std::string> &StepOutputFilenames,
+        unsigned long long NumberOfFrameRows,
+        unsigned int NumberOfFrameColumns,
+        const char *OutputFilename);
+
+void WriteDataSetToOutputFiles(
+        vtkDataSet *InputDataSet,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void WriteAttributesToOutputFiles(
+        vtkDataSetAttributes *InputPointData,
+        vtkDataSetAttributes *InputCellData,
+        vtkDataArray *InputPoints,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void GetSlabLayout(
+        const PieceHeader &Piece,
+        const ImageGeometry *Geometry,
+        const ConversionOptions &Options,
+        SlabLayout &Layout);                  // Output
+
+void StreamAttributesToOutputFiles(
+        ReadSlabFunction ReadSlab,
+        void *SlabReader,
+        const SlabLayout &Layout,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void ReadPieceSlab(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry);                     // Output
+
+void StreamPieceToOutputFiles(
+        std::istream &InputFile,
+        const char *InputFilename,
+        const FileHeader &Header,
+        const PieceHeader &Piece,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void ReadImageDataSlab(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry);                     // Output
+
+void StreamImageDataToOutputFiles(
+        vtkAlgorithm *ImageDataReader,
+        const FileHeader &Header,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void ReadDataSetPiece(
+        void *SlabReader,
+        unsigned int Attribute,
+        const int *SlabExtent,
+        const unsigned long long *SlabRows,
+        std::vector<vtkDataArray*> &SelectedArrays,   // Output
+        ImageGeometry &Geometry);                     // Output
+
+void StreamDataSetPiecesToOutputFiles(
+        vtkAlgorithm *DataSetReader,
+        const FileHeader &Header,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void WritePiecesToOutputFiles(
+        const char *InputFilename,
+        const FileHeader &Header,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void ScanPieceSources(
+        const char *InputFilename,
+        const FileHeader &Header,
+        std::vector<FileHeader> &SourceHeaders,       // Output
+        std::vector<unsigned int> &PieceSources);     // Output
+
+struct PieceConversion;
+
+void ConvertPiecesOnThread(PieceConversion *Conversion);
+
+unsigned long long ConvertPiece(
+        const PieceConversion &Conversion,
+        unsigned int PieceIndex,
+        std::ostream &OutputFile);
+
+void GetSelectedArrayHeaders(
+        const std::vector<ArrayHeader> &Arrays,
+        const ConversionOptions &Options,
+        std::vector<ArrayHeader> &SelectedArrays);  // Output
+
+bool GetPieceRowExtent(
+        const int PieceExtent[6],
+        const int RowExtent[6],
+        const int Stride[3],
+        int PieceRowExtent[6]);               // Output
+
+unsigned long long GetExtentRowId(
+        const int RowExtent[6],
+        const int Stride[3],
+        const int Index[3]);
+
+unsigned int GetNumberOfThreads(
+        const ConversionOptions &Options,
+        unsigned int NumberOfTasks);
+
+unsigned long long GetNumberOfSlabRows(
+        unsigned long long RowBytes,
+        const ConversionOptions &Options);
+
+void GetSlabExtents(
+        const int RowExtent[6],
+        const int Stride[3],
+        unsigned long long NumberOfSlabRows,
+        std::vector<int> &SlabExtents);       // Output, 6 per slab
+
+void WriteTopologyToOutputFiles(
+        vtkDataSet *InputDataSet,
+        const char *OutputFilename);
+
+void WriteArrayBufferToBinaryFile(
+        vtkDataArray *InputDataArray,
+        const char *OutputFilename);
 
 void WriteArraysToOutputFile(
-        vtkPointData *InputPointData,
-        char *OutputFilename,
-        bool BinaryOutputFile);
+        const std::vector<vtkDataArray*> &SelectedArrays,
+        const ImageGeometry *Geometry,
+        const char *OutputFilename,
+        const ConversionOptions &Options);
+
+void PrintOutputMatrix(const OutputMatrix &Matrix);
+
+void BuildOutputMatrix(
+        const std::vector<vtkDataArray*> &SelectedArrays,
+        const ImageGeometry *Geometry,
+        const ConversionOptions &Options,
+        OutputMatrix &Matrix);                // Output
+
+void ConvertMatrixRows(
+        const OutputMatrix &Matrix,
+        unsigned long long FirstRow,
+        unsigned long long NumberOfRows,
+        std::vector<vtkIdType> &TupleIds,     // Work space
+        std::vector<int> &Indices,            // Work space
+        double *Buffer);                      // Output
+
+template <class ValueType>
+void ConvertArrayRows(
+        const ValueType *Values,
+        unsigned int NumberOfComponents,
+        const vtkIdType *TupleIds,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        unsigned int ColumnOffset,
+        double *Buffer);                      // Output
+
+unsigned long long GetNumberOfBlockRows(const OutputMatrix &Matrix);
+
+void SelectArrays(
+        vtkDataSetAttributes *InputData,
+        const ConversionOptions &Options,
+        std::vector<vtkDataArray*> &SelectedArrays);  // Output
+
+std::string MakeDerivedFilename(
+        const std::string &Filename,
+        const std::string &Suffix);
+
+std::string MakeTableFilename(
+        const std::string &OutputFilename,
+        const std::string &Suffix);
+
+bool IsArraySelected(
+        const std::string &Name,
+        const ConversionOptions &Options);
+
+bool IsSequentialOutputFile(const char *OutputFilename);
+
+bool IsSharedMemoryName(const char *Name);
+
+void CreateSharedMemory(
+        const char *Name,
+        const std::vector<std::string> &ArrayNames,
+        const std::vector<unsigned int> &NumberOfComponents,
+        CoordinatesType Coordinates,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns);
+
+void CreateMatrixSharedMemory(
+        const char *Name,
+        const OutputMatrix &Matrix,
+        unsigned long long NumberOfRows);
+
+void PublishSharedMemory(
+        const char *Name,
+        unsigned long long NumberOfRows);
+
+void RemoveUnpublishedSharedMemory();
+
+bool IsShardedOutput(const ConversionOptions &Options);
+
+void GetShardLayout(
+        const char *OutputFilename,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        const ConversionOptions &Options,
+        ShardLayout &Layout);                 // Output
+
+void CreateShards(const ShardLayout &Layout);
+
+void OpenShards(
+        const ShardLayout &Layout,
+        OutputFileStream &OutputFile);        // Output
+
+unsigned long long GetShardFirstRow(
+        const ShardLayout &Layout,
+        unsigned int ShardIndex);
+
+unsigned long long GetNumberOfShardRows(
+        const ShardLayout &Layout,
+        unsigned int ShardIndex);
+
+void WriteArraysToShards(
+        const OutputMatrix &Matrix,
+        const ShardLayout &Layout,
+        const ConversionOptions &Options,
+        std::vector<unsigned long> &Checksums);   // Output
+
+struct ShardConversion;
+
+void WriteShardsOnThread(ShardConversion *Conversion);
+
+void PublishShards(
+        const ShardLayout &Layout,
+        const char *OutputFilename,
+        const ConversionOptions &Options,
+        const std::vector<unsigned long> *Checksums);
+
+void ChecksumShardsOnThread(ShardConversion *Conversion);
 
 void OpenFile(
-        char *OutputFilename,
+        const char *OutputFilename,
         bool BinaryOutputFile,
-        std::ofstream &OutputFile);
+        OutputFileStream &OutputFile);
+
+void OpenFileRegion(
+        const char *OutputFilename,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        const ConversionOptions &Options,
+        OutputFileStream &OutputFile);
+
+void CheckFileRegionSize(
+        const char *OutputFilename,
+        unsigned long long NumberOfRows,
+        unsigned int NumberOfColumns,
+        const ConversionOptions &Options);
 
 void WriteArraysToASCIIFile(
-        std::ofstream &OutputFile,   // Output
-        vtkDataArray **InputDataArrays,
-        unsigned int NumberOfArrays,
-        unsigned int *NumberOfComponentsInEachArray);
+        std::ostream &OutputFile,    // Output
+        const OutputMatrix &Matrix,
+        unsigned long long RowOffset);
 
 void WriteArraysToBinaryFile(
-        std::ofstream &OutputFile,   // Output
-        vtkDataArray **InputDataArrays,
-        unsigned int NumberOfArrays,
-        unsigned int *NumberOfComponentsInEachArray);
+        std::ostream &OutputFile,    // Output
+        const OutputMatrix &Matrix,
+        unsigned long long RowOffset);
+
+bool ProbeInputFile(const char *InputFilename);
+
+bool ScanFileHeader(
+        const char *InputFilename,
+        InputFileType FileType,
+        FileHeader &Header);                  // Output
+
+bool ScanLegacyFileHeader(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+bool ScanXMLFileHeader(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+bool ScanParallelFileHeader(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+std::string GetSourceFilename(
+        const char *InputFilename,
+        const std::string &Source);
+
+bool ScanMultiBlockFileHeader(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+bool ScanMultiBlockElements(
+        const char *InputFilename,
+        const std::string &Prefix,
+        unsigned int Depth,
+        std::vector<BlockHeader> &Blocks);    // Output
+
+bool ScanTimeSeriesFileHeader(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+bool ScanHDFFileHeader(
+        const char *InputFilename,
+        FileHeader &Header);                  // Output
+
+void ScanHDFDatasets(
+        hid_t ParentGroup,
+        const char *GroupName,
+        const int *Extent,
+        unsigned long long NumberOfTuples,
+        std::vector<ArrayHeader> &Arrays);    // Output
+
+std::string GetHDFDataTypeName(hid_t FileType);
+
+bool ReadHDFAttribute(
+        hid_t Object,
+        const char *Name,
+        hid_t MemoryType,
+        unsigned int NumberOfValues,
+        void *Values);                        // Output
+
+bool ReadHDFStringAttribute(
+        hid_t Object,
+        const char *Name,
+        std::string &Value);                  // Output
+
+bool SumHDFDataset(
+        hid_t Group,
+        const char *Name,
+        unsigned long long &Sum);             // Output
+
+bool PrintProbeSummary(
+        const char *InputFilename,
+        const FileHeader &Header);
+
+bool ReadLegacyLine(
+        std::istream &InputFile,
+        std::string &Line);                   // Output
+
+bool SkipLegacyMetaData(std::istream &InputFile);
+
+bool SkipLegacyValues(
+        std::istream &InputFile,
+        bool BinaryData,
+        const std::string &LegacyTypeName,
+        unsigned long long NumberOfValues);
+
+bool IsLegacyNumberWord(const std::string &Word);
+
+bool SkipLegacySection(
+        std::istream &InputFile,
+        bool BinaryData,
+        const std::string &LegacyTypeName,
+        unsigned long long NumberOfValues);
+
+bool ReadXMLTag(
+        std::istream &InputFile,
+        std::string &TagName,                 // Output
+        std::vector<std::string> &AttributeNames,    // Output
+        std::vector<std::string> &AttributeValues,   // Output
+        bool &EmptyElement);                  // Output
+
+std::string GetXMLAttribute(
+        const std::vector<std::string> &AttributeNames,
+        const std::vector<std::string> &AttributeValues,
+        const char *Name);
+
+int LookupLegacyDataType(const std::string &LegacyTypeName);
+int LookupXMLDataType(const std::string &XMLTypeName);
+int GetLegacyDataTypeSize(const std::string &LegacyTypeName);
+int GetXMLDataTypeSize(const std::string &XMLTypeName);
+const char *GetDataTypeName(int DataType);
+const char *GetInputFileTypeName(InputFileType FileType);
+
+std::string ToUpperCase(const std::string &String);
+std::string DecodeLegacyName(const std::string &Name);
+std::string EscapeJSONString(const std::string &String);
 
 #endif